@@ -8,9 +8,26 @@ set(headers ${headers}
 	include/Hooks.h
 	include/MCP.h
 	include/Serialization.h
+	include/ThreadPool.h
+	include/ScanIndex.h
+	include/LibraryWalker.h
+	include/ManagedManifest.h
+	include/BinaryIO.h
+	include/DirectoryWatcher.h
+	include/FileClassifier.h
+	include/StringPool.h
+	include/SubmovesetTable.h
+	include/HkxImportQueue.h
+	include/HkxStore.h
+	include/ConditionOptimizer.h
 	include/OARAPI.h
 	include/OAR/OpenAnimationReplacerAPI-Animations.h
 	include/OAR/OpenAnimationReplacerAPI-Conditions.h
 	include/OAR/OpenAnimationReplacerAPI-UI.h
 	include/OAR/OpenAnimationReplacer-ConditionTypes.h
+	include/CycleConditions.h
+	include/StateStore.h
+	include/JsonReader.h
+	include/PlaylistTable.h
+	include/OarConfigWriter.h
 )
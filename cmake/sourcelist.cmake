@@ -7,4 +7,19 @@ set(sources ${sources}
 	src/Hooks.cpp
 	src/MCP.cpp
  	src/Serialization.cpp
+	src/ThreadPool.cpp
+	src/ScanIndex.cpp
+	src/LibraryWalker.cpp
+	src/ManagedManifest.cpp
+	src/DirectoryWatcher.cpp
+	src/StringPool.cpp
+	src/SubmovesetTable.cpp
+	src/HkxImportQueue.cpp
+	src/HkxStore.cpp
+	src/ConditionOptimizer.cpp
+	src/CycleConditions.cpp
+	src/StateStore.cpp
+	src/JsonReader.cpp
+	src/PlaylistTable.cpp
+	src/OarConfigWriter.cpp
 )
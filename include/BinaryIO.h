@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+
+// Helpers de leitura/escrita dos arquivos binrios do plugin (ndice de scan, manifesto, ...).
+namespace BinaryIO {
+    template <class T>
+    inline void WritePod(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <class T>
+    inline bool ReadPod(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    inline void WriteString(std::ostream& out, const std::string& s) {
+        WritePod(out, static_cast<std::uint32_t>(s.size()));
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+
+    inline bool ReadString(std::istream& in, std::string& s) {
+        std::uint32_t size = 0;
+        if (!ReadPod(in, size)) return false;
+        s.resize(size);
+        return size == 0 || static_cast<bool>(in.read(s.data(), size));
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include "rapidjson/document.h"
+
+// Fatorao de prefixos comuns no bloco gerenciado do config.json.
+// O UpdateOrCreateJson gera um AND por FileSaveConfig sob um OR mestre, e esses ANDs repetem
+// o mesmo comeo (IsActorBase, CycleMovesetNpcType, IsEquippedType, keywords...). Aqui
+//   OR(AND(p, a), AND(p, b))  vira  AND(p, OR(a, b))
+// recursivamente. Condies com estado (Random, qualquer uma com "State") nunca so fatoradas,
+// j que avali-las uma vez s mudaria o comportamento.
+// Depois da fatorao, OrderByCost pe as condies baratas e seletivas (CompareValues de variveis
+// do behavior) antes das caras (listas de keywords, faces) dentro de cada grupo. A ordem importa:
+// ordenar antes espalharia o comeo comum (IsActorBase, NpcType, IsEquippedType) que a fatorao junta.
+namespace ConditionOptimizer {
+    struct Stats {
+        std::size_t nodesBefore = 0;
+        std::size_t nodesAfter = 0;
+        bool applied = false;  // false se no havia o que fatorar ou se a verificao falhou
+    };
+
+    // 'orConditions'  o array de ramos do OR mestre. S  substitudo se a rvore fatorada
+    // tiver a mesma tabela-verdade da original (checada por EquivalentOr).
+    Stats FactorSharedPrefixes(rapidjson::Value& orConditions, rapidjson::Document::AllocatorType& allocator);
+
+    // Fatora, depois ordena por custo, e s aceita o resultado se ele for equivalente ao bloco original
+    // (sem fatorao nem ordenao); seno 'orConditions' volta a ser o original.
+    Stats Optimize(rapidjson::Value& orConditions, rapidjson::Document::AllocatorType& allocator);
+
+    // Estimativa usada na ordenao: custo relativo de avaliar a condio e chance de ela passar.
+    struct CostEstimate {
+        double cost = 1.0;
+        double pass = 0.5;
+    };
+    CostEstimate Estimate(const rapidjson::Value& condition);
+
+    // Reordena os ramos do OR mestre e, recursivamente, cada AND/OR dentro deles para que o
+    // curto-circuito do OAR descarte cedo: em AND, menor custo / (1 - passa) primeiro; em OR,
+    // menor custo / passa. Condies com estado ficam no lugar e separam os trechos reordenados.
+    void OrderByCost(rapidjson::Value& orConditions, rapidjson::Document::AllocatorType& allocator);
+
+    // Compara OR(a) e OR(b) tratando cada condio folha distinta como uma varivel livre. Verificao
+    // exata e estrutural: as duas rvores so expandidas em listas de ANDs de folhas e cada ramo de um
+    // lado tem de estar no outro ou conter um ramo dele. false se a expanso for grande demais.
+    bool EquivalentOr(const rapidjson::Value& a, const rapidjson::Value& b);
+}
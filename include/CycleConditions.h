@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include "OAR/OpenAnimationReplacerAPI-Conditions.h"
+
+// Condio nativa do OAR que substitui as rvores de CompareValues sobre cycle_instance, testarone,
+// DirecionalCycleMoveset e CycleMovesetNpcType geradas para cada slot da playlist.
+// O config.json leva s um nmero (SlotKey::Encode) e a avaliao decodifica esse nmero e compara
+// com as variveis do ator, sem percorrer blocos AND/OR no OAR.
+namespace CycleConditions {
+    // Chave compacta de um slot. Cabe em 23 bits para sobreviver ao float do componente numrico:
+    //   bits 0-2   tipo de regra (CycleMovesetNpcType)
+    //   bits 3-5   stance (cycle_instance)
+    //   bits 6-13  posio na playlist (testarone); 0 = sem checagem de playlist/direo
+    //   bits 14-21 mscara de direes (bit d-1 = direo d)
+    //   bit  22    1 = moveset pai: a direo atual NO pode estar na mscara
+    struct SlotKey {
+        int npcType = 0;
+        int instance = 0;
+        int playlist = 0;
+        std::uint8_t directions = 0;
+        bool excludeDirections = false;
+
+        // nullopt se algum campo no couber (o chamador volta para as condies em JSON)
+        std::optional<std::uint32_t> Encode() const;
+        static SlotKey Decode(std::uint32_t id);
+
+        bool Matches(int actorNpcType, int actorInstance, int actorPlaylist, int actorDirection) const;
+    };
+
+    class CycleMovesetActiveCondition : public ::Conditions::CustomCondition {
+    public:
+        constexpr static inline std::string_view CONDITION_NAME = "CycleMovesetActive"sv;
+
+        CycleMovesetActiveCondition();
+
+        RE::BSString GetArgument() const override;
+        RE::BSString GetCurrent(RE::TESObjectREFR* a_refr) const override;
+
+        RE::BSString GetName() const override { return CONDITION_NAME.data(); }
+        RE::BSString GetDescription() const override {
+            return "Checks the Cycle Movesets slot (stance, playlist position, direction and rule type) of the actor."sv
+                .data();
+        }
+        constexpr REL::Version GetRequiredVersion() const override { return {1, 0, 0}; }
+
+        ::Conditions::INumericConditionComponent* slotComponent = nullptr;
+
+    protected:
+        bool EvaluateImpl(RE::TESObjectREFR* a_refr, RE::hkbClipGenerator* a_clipGenerator,
+                          void* a_parentSubMod) const override;
+    };
+
+    // Precisa ser chamado at o kPostLoad; depois disso o OAR j montou o mapa de condies.
+    void Register();
+    // true se o OAR aceitou a condio; s ento o UpdateOrCreateJson pode emiti-la.
+    bool IsRegistered();
+}
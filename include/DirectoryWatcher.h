@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Observa uma pasta (recursivamente) e acumula os caminhos criados, removidos ou renomeados.
+// S nomes importam para a biblioteca: alteraes de contedo (ex.: o prprio plugin
+// reescrevendo config.json) so ignoradas.
+class IDirectoryWatcher {
+public:
+    virtual ~IDirectoryWatcher() = default;
+
+    virtual bool Start(const std::filesystem::path& root) = 0;
+    virtual void Stop() = 0;
+
+    // Move para 'out' os caminhos alterados desde a ltima chamada.
+    // Retorna false se eventos foram perdidos e a raiz inteira precisa ser reescaneada.
+    virtual bool Drain(std::vector<std::filesystem::path>& out) = 0;
+    virtual bool HasChanges() const = 0;
+};
+
+// Backend padro, baseado em ReadDirectoryChangesW sobreposto (OVERLAPPED) com uma thread por raiz.
+// A thread espera pela leitura ou pelo evento de parada; o Stop sinaliza o evento e a prpria
+// thread cancela a leitura pendente com CancelIoEx.
+class Win32DirectoryWatcher final : public IDirectoryWatcher {
+public:
+    Win32DirectoryWatcher() = default;
+    ~Win32DirectoryWatcher() override;
+
+    Win32DirectoryWatcher(const Win32DirectoryWatcher&) = delete;
+    Win32DirectoryWatcher& operator=(const Win32DirectoryWatcher&) = delete;
+
+    bool Start(const std::filesystem::path& root) override;
+    void Stop() override;
+    bool Drain(std::vector<std::filesystem::path>& out) override;
+    bool HasChanges() const override { return _hasChanges.load(std::memory_order_acquire); }
+
+private:
+    void WatchLoop();
+
+    std::filesystem::path _root;
+    void* _directory = nullptr;  // HANDLE
+    void* _stopEvent = nullptr;  // HANDLE
+    std::thread _thread;
+
+    mutable std::mutex _mutex;
+    std::vector<std::filesystem::path> _changes;
+    bool _overflowed = false;
+    std::atomic<bool> _hasChanges{false};
+};
+
+using DirectoryWatcherFactory = std::function<std::unique_ptr<IDirectoryWatcher>()>;
+
+// Permite trocar o backend (ex.: um watcher falso); sem factory usa Win32DirectoryWatcher.
+void SetDirectoryWatcherFactory(DirectoryWatcherFactory factory);
+std::unique_ptr<IDirectoryWatcher> CreateDirectoryWatcher();
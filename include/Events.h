@@ -1,17 +1,42 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <future>
 #include <map>
+#include <memory>
 #include <optional>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "Settings.h"  // Inclui as novas definies
+#include "ManagedManifest.h"
+#include "DirectoryWatcher.h"
+#include "SubmovesetTable.h"
+#include "PlaylistTable.h"
 #include "rapidjson/document.h"
 #include "rapidjson/prettywriter.h"
 #include "ClibUtil/singleton.hpp"
 
 struct FileSaveConfig;
+namespace CycleConditions {
+    struct SlotKey;
+}
+class WorkStealingPool;
+class ScanIndex;
+
+// Resultado do scan de uma pasta de topo do OAR (produzido em uma thread do pool).
+struct TopLevelModScan {
+    std::optional<AnimationModDef> mod;                   // Vazio se o config.json de topo for invlido
+    std::vector<std::filesystem::path> managedConfigs;    // config.json com OAR_CYCLE_MANAGER_CONDITIONS
+    std::vector<std::filesystem::path> ruleFiles;         // (User_)CycleMoveset.json, na ordem do walk
+};
 
 
 // Enum para os tipos de regra
 enum class RuleType { UniqueNPC, Faction, Keyword, Race, GeneralNPC, Player };
+// Resultado de UpdateOrCreateJson: Skipped = o arquivo j tinha exatamente o contedo gerado.
+enum class JsonWriteResult { Written, Skipped, Failed };
 
 // Structs para guardar os dados carregados do jogo (para os pop-ups de seleo)
 struct FactionInfo {
@@ -59,6 +84,15 @@ class AnimationManager : public clib_util::singleton::ISingleton<AnimationManage
 public:   
     
     void ScanAnimationMods();
+    // Converte os CycleDar.json pendentes (cpias e renomeaes BFCO) antes do OAR ler as pastas.
+    // Roda no SKSEPluginLoad, antes do StartLibraryScan: s rel os CycleDar.json que o ndice j
+    // conhece e percorre as pastas de topo que ele nunca viu. O resto fica para o scan.
+    void ImportCycleDarFolders();
+    // Dispara ScanAnimationMods em uma thread de fundo. Quem l a biblioteca deve checar
+    // IsLibraryReady() ou chamar WaitForLibraryScan() antes.
+    std::shared_future<void> StartLibraryScan();
+    void WaitForLibraryScan();
+    bool IsLibraryReady() const { return _libraryReady.load(std::memory_order_acquire); }
     void DrawMainMenu();
     void DrawUserMovesetCreator();
     void DrawNPCMenu();
@@ -70,7 +104,7 @@ public:
     std::string GetCurrentMovesetName(const std::string& categoryName, int stanceIndex, int movesetIndex,
                                       int directionalState);
     bool _showRestartPopup = false; 
-    void ScanDarAnimations();
+    void ScanDarAnimations(WorkStealingPool* pool = nullptr, ScanIndex* index = nullptr, bool importCycleDar = true);
     void LoadGameDataForNpcRules();
     void PopulateNpcList();
     NpcRuleMatch FindBestMovesetConfiguration(RE::Actor* actor, const std::string& categoryName);
@@ -78,6 +112,15 @@ public:
     std::vector<int> GetAvailableMovesetIndices(RE::Actor* actor, const std::string& categoryName);
 
     std::optional<std::pair<size_t, size_t>> FindSubAnimationByPath(const std::filesystem::path& configPath);
+
+    // Rescan incremental: atualiza _allMods/_darSubMovesets no lugar, sem deslocar ndices j
+    // usados por SubAnimationInstance (pastas removidas ficam marcadas com isMissing).
+    // No recarrega os CycleMoveset.json; s registra arquivos de regra novos.
+    bool RescanMod(const std::filesystem::path& modPath);
+    bool RescanSubmoveset(const std::filesystem::path& folder);
+    // Aplica as mudanas acumuladas pelos watchers de pasta (OAR e DAR).
+    void ApplyLibraryChanges();
+    bool HasPendingLibraryChanges() const;
     
     MovesetTags GetCurrentMovesetTags(const std::string& categoryName, int stanceIndex, int movesetIndex);
 
@@ -86,10 +129,37 @@ private:
     std::map<std::string, WeaponCategory> _categories;
     std::map<std::string, WeaponCategory> _npcCategories;
     std::vector<AnimationModDef> _allMods;
+    // Bits de capacidade de cada sub-moveset de _allMods, por id global (mantido via Sync/SyncMod)
+    SubmovesetTable _library;
+    SubmovesetId LibraryIdOf(const SubAnimationInstance& instance) const;
     std::vector<SubAnimationDef> _darSubMovesets;
     bool _isAddDarModalOpen = false;
     // Armazena os caminhos de todos os config.json que nosso manager j tocou.
     std::set<std::filesystem::path> _managedFiles; 
+    // Manifesto persistente de _managedFiles (com hash de contedo), atualizado a cada SaveAllSettings.
+    ManagedManifest _managedManifest;
+
+    // Estado do scan em segundo plano (ver StartLibraryScan)
+    std::shared_future<void> _libraryScan;
+    std::atomic<bool> _libraryReady{false};
+    std::atomic<const char*> _scanPhase{""};
+    std::atomic<size_t> _scanModsDone{0};
+    std::atomic<size_t> _scanModsTotal{0};
+    void DrawLibraryScanProgress();
+
+    // Estado mantido aps o scan para os rescans incrementais
+    std::shared_ptr<ScanIndex> _scanIndex;
+    std::unique_ptr<IDirectoryWatcher> _oarWatcher;
+    std::unique_ptr<IDirectoryWatcher> _darWatcher;
+    void StartLibraryWatchers();
+    void RescanDarLibrary();
+    bool RescanOarSubmoveset(size_t modIdx, const std::filesystem::path& folder);
+    bool RescanDarFolder(const std::filesystem::path& folder);
+    std::vector<std::filesystem::path> SnapshotCreatorSources() const;
+    void RebindCreatorSources(const std::vector<std::filesystem::path>& sources);
+    // Arquivos de regra encontrados no ltimo scan (OAR e DAR), consumidos pelo LoadCycleMovesets.
+    std::vector<std::filesystem::path> _oarRuleFiles;
+    std::vector<std::filesystem::path> _darRuleFiles;
     bool _preserveConditions = false;
     bool _isAddModModalOpen = false;
     CategoryInstance* _instanceToAddTo = nullptr;
@@ -98,16 +168,27 @@ private:
     ModInstance* _modInstanceToSaveAsCustom = nullptr;
     char _newMovesetNameBuffer[128] = "";
 
-    void ProcessTopLevelMod(const std::filesystem::path& modPath);
+    static TopLevelModScan ProcessTopLevelMod(const std::filesystem::path& modPath, WorkStealingPool* pool,
+                                              ScanIndex* index, bool readManagedMarker, bool importCycleDar);
     void DrawAddModModal();
     void SaveAllSettings();
-    void UpdateOrCreateJson(const std::filesystem::path& jsonPath, const std::vector<FileSaveConfig>& configs);
+    JsonWriteResult UpdateOrCreateJson(const std::filesystem::path& jsonPath, const std::vector<FileSaveConfig>& configs);
+    // Gera e grava cada config.json em paralelo. Cada arquivo depende s das suas configs e de
+    // estado lido (_categories, _preserveConditions), ento a sada  a mesma da verso sequencial.
+    // Retorna os arquivos que no puderam ser gravados.
+    std::set<std::filesystem::path> WriteConfigFiles(const std::map<std::filesystem::path, std::vector<FileSaveConfig>>& fileUpdates,
+                          WorkStealingPool* pool);
     void AddCompareValuesCondition(rapidjson::Value& conditionsArray, const std::string& graphVarName, int value,
                                    rapidjson::Document::AllocatorType& allocator);
     // NOVA FUNO HELPER: Para adicionar condies booleanas (checkboxes)
     void AddCompareBoolCondition(rapidjson::Value& conditionsArray, const std::string& graphVarName, bool value,
                                  rapidjson::Document::AllocatorType& allocator);
 
+    // Slot compacto da condio nativa CycleMovesetActive (ver CycleConditions.h)
+    static CycleConditions::SlotKey MakeSlotKey(const FileSaveConfig& config, int npcType, int instanceIndex);
+    void AddCycleSlotCondition(rapidjson::Value& conditionsArray, std::uint32_t slotId,
+                               rapidjson::Document::AllocatorType& allocator);
+
     // Funo do random aqui
     void AddRandomCondition(rapidjson::Value& conditionsArray, int value,
                                               rapidjson::Document::AllocatorType& allocator);
@@ -120,6 +201,21 @@ private:
                              rapidjson::Document::AllocatorType& allocator);
     void AddCompetingKeywordExclusions(rapidjson::Value& parentArray, const WeaponCategory* currentCategory,
                                        bool isLeftHand, rapidjson::Document::AllocatorType& allocator);
+
+    // Excluses de keywords entre categorias, montadas uma vez por salvamento a partir de _categories.
+    // Cada keyword distinta ganha um id; as concorrentes de uma categoria so um bitset desses ids e o
+    // bloco AND de excluso j fica pronto no allocator do cache. As threads do WriteConfigFiles s leem.
+    struct KeywordExclusionCache {
+        rapidjson::MemoryPoolAllocator<> allocator;
+        std::vector<std::string> keywordNames;  // id -> editorID
+        std::unordered_map<std::string, std::array<rapidjson::Value, 2>> fragments;  // [direita, esquerda]
+        rapidjson::Value shieldFragment;  // Null se no h categorias de escudo customizadas
+    };
+    std::unique_ptr<KeywordExclusionCache> _keywordExclusions;
+    void BuildKeywordExclusions();
+    rapidjson::Value BuildCompetingKeywordBlock(const std::vector<std::uint64_t>& bits,
+                                                const std::vector<std::string>& keywordNames, bool isLeftHand,
+                                                const char* comment, rapidjson::Document::AllocatorType& allocator);
     void AddKeywordOrConditions(rapidjson::Value& parentArray, const std::vector<std::string>& keywords,
                                 bool isLeftHand, rapidjson::Document::AllocatorType& allocator);
 
@@ -163,6 +259,18 @@ private:
     // Vetor com todos os movesets criados pelo usurio
     std::vector<UserMoveset> _userMovesets;
 
+    // Mod virtual de um moveset de usurio em _allMods: posio fixa e os sub-movesets de origem
+    // com que foi montado. O rebuild s remonta os slots cuja lista de origens (ou a reviso de
+    // alguma delas, depois de um rescan) mudou.
+    struct UserModSlot {
+        size_t modIndex = 0;
+        std::vector<SubmovesetId> sources;
+        std::vector<std::uint32_t> revisions;  // SubmovesetTable::RevisionOf de cada origem
+    };
+    std::unordered_map<std::string, UserModSlot> _userModSlots;  // nome do moveset -> slot
+    std::vector<size_t> _freeUserModSlots;                       // slots de movesets apagados
+    std::optional<SubmovesetId> ResolveUserSource(const SubAnimationInstance& subInstance) const;
+
     // Estado da UI de criao/edio
     bool _isEditingUserMoveset = false;  // true quando estamos na tela de edio
     int _editingMovesetIndex = -1;       // ndice do moveset sendo editado, -1 para um novo
@@ -203,9 +311,9 @@ private:
     // Funo auxiliar para encontrar uma sub-animao pelo nome dentro de um mod
     std::optional<size_t> FindSubAnimIndexByName(size_t modIdx, const std::string& name);
 
-     // NOVO CACHE ESTTICO: Armazena a contagem de movesets para acesso rpido.
-    // A chave  o nome da categoria (ex: "Swords"), o valor  um array de 4 ints (um para cada stance).
-    inline static std::map<std::string, std::array<int, 4>> _maxMovesetsPerCategory;
+    // Playlist do jogador compilada no UpdateMaxMovesetCache (contagem, nome e tags do moveset atual).
+    // Trocada inteira a cada rebuild: as leituras do jogo nunca veem uma tabela pela metade.
+    std::atomic<std::shared_ptr<const PlaylistTable>> _playlists{std::make_shared<const PlaylistTable>()};
     inline static std::map<RE::FormID, std::map<std::string, std::array<int, 4>>> _maxMovesetsPerCategory_NPC;
 
     // NOVA FUNO PRIVADA: Usada internamente para preencher o cache.
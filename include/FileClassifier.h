@@ -0,0 +1,182 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+// Classifica nomes de arquivo da biblioteca (.hkx do BFCO/MCO e os .json especiais) em uma
+// mscara de tags, sem alocar e sem diferenciar maisculas. Nova tag = nova linha em kRules.
+namespace FileClassifier {
+    enum Tag : std::uint32_t {
+        kHkx = 1 << 0,
+        kAttack = 1 << 1,         // bfco_attack*
+        kPowerAttack = 1 << 2,    // bfco_powerattack*
+        kIdle = 1 << 3,           // *idle*
+        kDpaA = 1 << 4,
+        kDpaB = 1 << 5,
+        kDpaL = 1 << 6,
+        kDpaR = 1 << 7,
+        kCpa = 1 << 8,            // bfco_powerattackcomb.hkx
+        kMcoPrefix = 1 << 9,      // mco_* (renomeado para BFCO_ pelo CycleDar)
+        kConfigJson = 1 << 10,
+        kUserCycleMovesetJson = 1 << 11,
+        kCycleMovesetJson = 1 << 12,
+        kCycleDarJson = 1 << 13,
+        kDarUserJson = 1 << 14
+    };
+
+    enum class Match { Exact, Prefix, Suffix, Contains };
+
+    struct Rule {
+        std::string_view pattern;  // Sempre em minsculas
+        Match match;
+        std::uint32_t tags;
+    };
+
+    inline constexpr Rule kRules[] = {
+        {".hkx", Match::Suffix, kHkx},
+        {"bfco_attack", Match::Prefix, kAttack},
+        {"bfco_powerattack", Match::Prefix, kPowerAttack},
+        {"idle", Match::Contains, kIdle},
+        {"mco_", Match::Prefix, kMcoPrefix},
+        {"bfco_powerattacka.hkx", Match::Exact, kDpaA},
+        {"bfco_powerattackb.hkx", Match::Exact, kDpaB},
+        {"bfco_powerattackl.hkx", Match::Exact, kDpaL},
+        {"bfco_powerattackr.hkx", Match::Exact, kDpaR},
+        {"bfco_powerattackcomb.hkx", Match::Exact, kCpa},
+        {"config.json", Match::Exact, kConfigJson},
+        {"user_cyclemoveset.json", Match::Exact, kUserCycleMovesetJson},
+        {"cyclemoveset.json", Match::Exact, kCycleMovesetJson},
+        {"cycledar.json", Match::Exact, kCycleDarJson},
+        {"user.json", Match::Exact, kDarUserJson},
+    };
+
+    namespace detail {
+        // S ASCII entra nos padres; qualquer outro caractere vira 0x7F e nunca casa.
+        template <class CharT>
+        constexpr char Lower(CharT c) {
+            const auto u = static_cast<std::uint32_t>(static_cast<std::make_unsigned_t<CharT>>(c));
+            if (u >= 'A' && u <= 'Z') return static_cast<char>(u + ('a' - 'A'));
+            return u < 0x80 ? static_cast<char>(u) : '\x7F';
+        }
+
+        template <class CharT>
+        constexpr bool EqualsAt(std::basic_string_view<CharT> s, std::size_t offset, std::string_view pattern) {
+            if (offset + pattern.size() > s.size()) return false;
+            for (std::size_t i = 0; i < pattern.size(); ++i) {
+                if (Lower(s[offset + i]) != pattern[i]) return false;
+            }
+            return true;
+        }
+
+        template <class CharT>
+        constexpr bool Matches(std::basic_string_view<CharT> s, const Rule& rule) {
+            switch (rule.match) {
+                case Match::Exact:
+                    return s.size() == rule.pattern.size() && EqualsAt(s, 0, rule.pattern);
+                case Match::Prefix:
+                    return EqualsAt(s, 0, rule.pattern);
+                case Match::Suffix:
+                    return s.size() >= rule.pattern.size() && EqualsAt(s, s.size() - rule.pattern.size(), rule.pattern);
+                case Match::Contains:
+                    for (std::size_t i = 0; i + rule.pattern.size() <= s.size(); ++i) {
+                        if (EqualsAt(s, i, rule.pattern)) return true;
+                    }
+                    return false;
+            }
+            return false;
+        }
+
+        // FNV-1a sobre os caracteres j em minsculas
+        template <class CharT>
+        constexpr std::uint32_t Hash(std::basic_string_view<CharT> s, std::uint32_t seed) {
+            std::uint32_t h = 2166136261u ^ seed;
+            for (const CharT c : s) {
+                h ^= static_cast<std::uint8_t>(Lower(c));
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        constexpr bool IsLowerAscii(std::string_view s) {
+            for (const char c : s) {
+                if ((c >= 'A' && c <= 'Z') || static_cast<unsigned char>(c) >= 0x80) return false;
+            }
+            return true;
+        }
+
+        constexpr std::size_t kExactSlots = 32;
+        constexpr std::uint8_t kEmptySlot = 0xFF;
+        constexpr std::uint32_t kNoSeed = std::numeric_limits<std::uint32_t>::max();
+
+        // Procura, em tempo de compilao, uma seed sem colises entre os padres exatos (hash perfeito).
+        consteval std::uint32_t FindPerfectSeed() {
+            for (std::uint32_t seed = 0; seed < 100000; ++seed) {
+                std::array<bool, kExactSlots> used{};
+                bool collision = false;
+                for (const auto& rule : kRules) {
+                    if (rule.match != Match::Exact) continue;
+                    const auto slot = Hash(rule.pattern, seed) % kExactSlots;
+                    if (used[slot]) {
+                        collision = true;
+                        break;
+                    }
+                    used[slot] = true;
+                }
+                if (!collision) return seed;
+            }
+            return kNoSeed;
+        }
+
+        inline constexpr std::uint32_t kSeed = FindPerfectSeed();
+        static_assert(kSeed != kNoSeed, "Nenhuma seed sem colises; aumente kExactSlots.");
+
+        consteval std::array<std::uint8_t, kExactSlots> BuildExactTable() {
+            std::array<std::uint8_t, kExactSlots> table{};
+            table.fill(kEmptySlot);
+            for (std::size_t i = 0; i < std::size(kRules); ++i) {
+                if (kRules[i].match != Match::Exact) continue;
+                table[Hash(kRules[i].pattern, kSeed) % kExactSlots] = static_cast<std::uint8_t>(i);
+            }
+            return table;
+        }
+
+        inline constexpr auto kExactTable = BuildExactTable();
+
+        consteval bool RulesAreValid() {
+            if (std::size(kRules) >= kEmptySlot) return false;
+            for (const auto& rule : kRules) {
+                if (rule.pattern.empty() || !IsLowerAscii(rule.pattern)) return false;
+            }
+            return true;
+        }
+        static_assert(RulesAreValid(), "Padres de kRules devem ser ASCII em minsculas.");
+
+        template <class CharT>
+        constexpr std::uint32_t Classify(std::basic_string_view<CharT> filename) {
+            std::uint32_t tags = 0;
+            const auto exact = kExactTable[Hash(filename, kSeed) % kExactSlots];
+            if (exact != kEmptySlot && Matches(filename, kRules[exact])) {
+                tags |= kRules[exact].tags;
+            }
+            for (const auto& rule : kRules) {
+                if (rule.match != Match::Exact && Matches(filename, rule)) {
+                    tags |= rule.tags;
+                }
+            }
+            return tags;
+        }
+    }
+
+    // Recebe s o nome do arquivo (sem a pasta).
+    constexpr std::uint32_t Classify(std::string_view filename) { return detail::Classify(filename); }
+    constexpr std::uint32_t Classify(std::wstring_view filename) { return detail::Classify(filename); }
+
+    static_assert(Classify(std::string_view{"BFCO_PowerAttackA.HKX"}) == (kHkx | kPowerAttack | kDpaA));
+    static_assert(Classify(std::string_view{"bfco_attack1.hkx"}) == (kHkx | kAttack));
+    static_assert(Classify(std::wstring_view{L"mco_idle.hkx"}) == (kHkx | kIdle | kMcoPrefix));
+    static_assert(Classify(std::string_view{"Config.json"}) == kConfigJson);
+    static_assert(Classify(std::string_view{"bfco_powerattackcomb.hkx.bak"}) == kPowerAttack);
+}
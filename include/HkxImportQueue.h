@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+
+// Fila limitada de cpias de .hkx usada pelo CycleDar. As cpias rodam em threads prprias
+// enquanto o chamador continua listando as pastas de origem; quando a fila enche, Enqueue
+// espera (contrapresso). Cada arquivo vira um hardlink de um blob do HkxStore quando o sistema
+// de arquivos deixa (mesmo volume NTFS, sem VFS no meio) e, se no, uma cpia normal.
+class HkxImportQueue {
+public:
+    // Agrupa as cpias de um CycleDar.json para o chamador poder esperar s por elas.
+    // Precisa viver at Wait() retornar.
+    class Batch {
+    public:
+        void Wait();
+
+        std::size_t Succeeded() const { return _succeeded.load(std::memory_order_relaxed); }
+        std::size_t Failed() const { return _failed.load(std::memory_order_relaxed); }
+        std::size_t HardLinked() const { return _hardLinked.load(std::memory_order_relaxed); }
+        std::uint64_t Bytes() const { return _bytes.load(std::memory_order_relaxed); }
+
+    private:
+        friend class HkxImportQueue;
+        void Finish(bool ok, bool linked, std::uint64_t bytes);
+
+        std::mutex _mutex;
+        std::condition_variable _doneCv;
+        std::size_t _pending = 0;
+        std::atomic<std::size_t> _succeeded{0};
+        std::atomic<std::size_t> _failed{0};
+        std::atomic<std::size_t> _hardLinked{0};
+        std::atomic<std::uint64_t> _bytes{0};
+    };
+
+    struct Progress {
+        std::size_t queued = 0;  // Total enviado nesta sesso
+        std::size_t done = 0;    // Concludos (com sucesso ou no)
+        std::uint64_t bytes = 0;
+        double seconds = 0.0;  // Desde o primeiro arquivo enviado
+
+        double MegabytesPerSecond() const { return seconds > 0.0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0; }
+    };
+
+    static HkxImportQueue& Get();
+
+    // 'destinationFile' j vem com o nome final (ex.: mco_ trocado por BFCO_), ento no h
+    // segunda passada renomeando arquivos.
+    void Enqueue(Batch& batch, std::filesystem::path sourceFile, std::filesystem::path destinationFile);
+
+    Progress GetProgress() const;
+    bool IsBusy() const;
+
+private:
+    struct Job {
+        Batch* batch = nullptr;
+        std::filesystem::path source;
+        std::filesystem::path destination;
+    };
+
+    static constexpr std::size_t kCapacity = 64;
+    static constexpr std::size_t kMaxWorkers = 4;
+
+    HkxImportQueue() = default;
+
+    void WorkerLoop();
+    static bool LinkOrCopy(const std::filesystem::path& source, const std::filesystem::path& destination,
+                           bool& linked, std::uint64_t& bytes);
+
+    mutable std::mutex _mutex;
+    std::condition_variable _notFullCv;
+    std::deque<Job> _jobs;
+    std::size_t _workers = 0;  // Threads vivas; saem sozinhas quando a fila esvazia
+
+    std::atomic<std::size_t> _queued{0};
+    std::atomic<std::size_t> _done{0};
+    std::atomic<std::uint64_t> _bytes{0};
+    std::chrono::steady_clock::time_point _firstEnqueue{};
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// Armazm endereado por contedo dos .hkx importados (CycleDar e Moveset Creator).
+// Cada contedo distinto fica uma nica vez em HkxStore/<xx>/<hash>-<tamanho>.hkx (cpia prpria,
+// nunca um nome do arquivo de origem) e as pastas de destino recebem hardlinks dele. Um blob cujo nico nome  o do armazm no  mais usado
+// por ningum e  apagado pelo CollectGarbage.
+class HkxStore {
+public:
+    struct Report {
+        std::size_t blobs = 0;
+        std::size_t links = 0;  // Nomes fora do armazm que apontam para algum blob
+        std::uint64_t storedBytes = 0;
+        std::uint64_t savedBytes = 0;  // Bytes que seriam cpias duplicadas sem o armazm
+        std::size_t collected = 0;
+        std::uint64_t collectedBytes = 0;
+    };
+
+    static HkxStore& Get();
+
+    // Cria 'destination' (que no pode existir) como hardlink do blob com o contedo de 'source'.
+    // Retorna false se o volume no aceita hardlinks; nesse caso o chamador copia.
+    bool Link(const std::filesystem::path& source, const std::filesystem::path& destination);
+
+    Report CollectGarbage();
+
+private:
+    HkxStore();
+
+    static bool HashFile(const std::filesystem::path& file, std::uint64_t& hash, std::uint64_t& size);
+    static constexpr std::uint32_t kLayoutVersion = 2;  // 2: blobs so cpias, no hardlinks da origem
+
+    static bool CreateBlob(const std::filesystem::path& source, const std::filesystem::path& blob, std::uint64_t hash,
+                           std::uint64_t size);
+    std::filesystem::path BlobPathFor(std::uint64_t hash, std::uint64_t size) const;
+
+    std::filesystem::path _root;
+    // Desligado quando nenhum hardlink funcionou (ex.: VFS do MO2); evita criar blobs inteis.
+    std::atomic<bool> _usable{true};
+    std::atomic<bool> _linkedAny{false};
+};
@@ -45,6 +45,12 @@ namespace Settings {
     inline int autoCycleMode = 1;       // 0: Disabled, 1: Auto Cycle, 2: Random Auto Cycle
     inline int menuVisibilityMode = 2;  // 0: Hidden, 1: Only in Combat, 2: When Weapon Draw
     inline bool bfcoDirectionalAttacks = true;
+    // Alm do UserState.bin, grava os JSON soltos (User_CycleMoveset.json por pasta, Stances, Categories...)
+    inline bool exportPerFolderJson = false;
+    // config.json sem indentao: menor e mais rpido para o OAR ler
+    inline bool compactOarConfigs = false;
+    // Usa a condio CycleMovesetActive quando o OAR a aceitou
+    inline bool nativeSlotConditions = true;
     
 }
 
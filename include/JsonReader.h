@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "rapidjson/document.h"
+
+// Leitor de JSON compartilhado pelos loaders de config. O arquivo entra com uma nica leitura
+// dimensionada e o Document aloca num MemoryPoolAllocator cujo primeiro bloco  um arena do prprio
+// leitor: reusar o mesmo JsonReader num loop no devolve nem pede memria ao heap a cada arquivo.
+// O Document (e, no ParseInsitu, as strings dele) vale at o prximo Load/Assign.
+class JsonReader {
+public:
+    static constexpr std::size_t kArenaSize = 64 * 1024;
+
+    JsonReader();
+    JsonReader(const JsonReader&) = delete;
+    JsonReader& operator=(const JsonReader&) = delete;
+
+    // false se o arquivo no existe ou no pde ser lido; o Document fica nulo nesse caso
+    bool Load(const std::filesystem::path& path);
+    // Usa um texto que j est em memria
+    void Assign(std::string text);
+    // Seo binria do StateStore: decodificada direto no Document (Parse/ParseInsitu s o devolvem)
+    void AssignEncoded(std::string_view bytes);
+
+    // In situ: as strings apontam para o buffer, que deixa de ser o texto original
+    rapidjson::Document& ParseInsitu();
+    // Copia as strings para o arena e preserva Text() (para comparar com a sada antes de gravar)
+    rapidjson::Document& Parse();
+
+    rapidjson::Document& Doc() { return _doc; }
+    const std::string& Text() const { return _text; }
+
+private:
+    void Reset();
+
+    std::vector<char> _arena;
+    rapidjson::MemoryPoolAllocator<> _pool;
+    rapidjson::Document _doc;
+    std::string _text;
+    bool _decoded = false;
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Settings.h"
+
+class ScanIndex;
+class WorkStealingPool;
+
+// Definida em Hooks.cpp. Retorna true se copiou/renomeou arquivos na pasta do CycleDar.json.
+bool ProcessCycleDarFile(const std::filesystem::path& cycleDarJsonPath);
+
+// Tags extradas dos nomes dos .hkx de uma pasta (os mesmos campos do SubAnimationDef).
+struct HkxTags {
+    int attackCount = 0;
+    int powerAttackCount = 0;
+    bool hasIdle = false;
+    bool hasAnimations = false;
+    DPATags dpaTags;
+    bool hasCPA = false;
+
+    // Recebe as tags do FileClassifier de um arquivo .hkx
+    void AddFile(std::uint32_t fileTags);
+    void ApplyTo(SubAnimationDef& def) const;
+};
+
+// Arquivos "especiais" encontrados na listagem da pasta.
+namespace FolderFlags {
+    enum : std::uint8_t {
+        kConfig = 1 << 0,            // config.json (OAR)
+        kUserCycleMoveset = 1 << 1,  // User_CycleMoveset.json
+        kCycleMoveset = 1 << 2,      // CycleMoveset.json
+        kCycleDar = 1 << 3,          // CycleDar.json
+        kDarUserJson = 1 << 4        // user.json (DAR)
+    };
+}
+
+struct WalkedFolder {
+    std::filesystem::path path;
+    int depth = 0;  // 0 = a prpria raiz do walk
+    std::uint8_t flags = 0;
+    HkxTags tags;
+    bool hasManagedMarker = false;      // config.json contm OAR_CYCLE_MANAGER_CONDITIONS
+    std::filesystem::path ruleFile;     // (User_)CycleMoveset.json que vale para esta pasta, se houver
+
+    bool Has(std::uint8_t flag) const { return (flags & flag) != 0; }
+};
+
+// Contadores de chamadas ao sistema de arquivos feitas pelo scan da biblioteca.
+struct FsCounters {
+    static inline std::atomic<std::size_t> listings{0};  // Diretrios listados
+    static inline std::atomic<std::size_t> entries{0};   // Entradas visitadas nessas listagens
+    static inline std::atomic<std::size_t> stats{0};     // Consultas de mtime/tamanho
+    static inline std::atomic<std::size_t> fileReads{0}; // Arquivos lidos por inteiro
+
+    struct Snapshot {
+        std::size_t listings = 0;
+        std::size_t entries = 0;
+        std::size_t stats = 0;
+        std::size_t fileReads = 0;
+
+        Snapshot operator-(const Snapshot& earlier) const {
+            return {listings - earlier.listings, entries - earlier.entries, stats - earlier.stats,
+                    fileReads - earlier.fileReads};
+        }
+    };
+
+    static Snapshot Take();
+    static void Reset();
+    static void Log(std::string_view phase);
+};
+
+enum class WalkRoot { OAR, DAR };
+
+// Percorre uma rvore uma nica vez, listando cada pasta apenas uma vez e juntando tudo que os
+// consumidores do scan precisam. Pastas cujo carimbo no mudou vm do ScanIndex sem listagem.
+// Com importCycleDar, os CycleDar.json pendentes das pastas listadas so convertidos no caminho;
+// sem ele o walk s l o disco ( o caso do scan em segundo plano).
+// Se houver um pool, as subpastas de cada pasta so percorridas em paralelo. A ordem do
+// resultado  sempre a mesma do recursive_directory_iterator (pr-ordem).
+class LibraryWalker {
+public:
+    LibraryWalker(WalkRoot kind, ScanIndex* index, WorkStealingPool* pool, bool readManagedMarker,
+                  bool importCycleDar);
+
+    // rootDepth permite percorrer s uma subrvore (ex.: um sub-moveset) com a mesma
+    // profundidade que ela teria no walk da raiz inteira.
+    std::vector<WalkedFolder> Walk(const std::filesystem::path& root, int rootDepth = 0) const;
+
+private:
+    void WalkInto(const std::filesystem::path& folder, int depth, std::vector<WalkedFolder>& out) const;
+    bool ShouldProcessCycleDar(const WalkedFolder& folder) const;
+
+    WalkRoot _kind;
+    ScanIndex* _index;
+    WorkStealingPool* _pool;
+    bool _readManagedMarker;
+    bool _importCycleDar;
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class WorkStealingPool;
+
+// Manifesto dos config.json que o SaveAllSettings j escreveu, com mtime, tamanho e hash do contedo.
+// Na inicializao ele  a fonte da verdade para _managedFiles: s os arquivos cujo mtime/tamanho
+// mudaram desde o ltimo salvamento so abertos de novo para conferncia.
+class ManagedManifest {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::string_view kMarker = "OAR_CYCLE_MANAGER_CONDITIONS";
+
+    bool Load(const std::filesystem::path& manifestPath);
+    bool Save(const std::filesystem::path& manifestPath) const;
+    bool IsLoaded() const { return _loaded; }
+
+    // Registra um config.json que acabou de ser escrito (ou verificado) pelo manager.
+    void Record(const std::filesystem::path& configPath);
+    // Igual a Record para vrios arquivos; a leitura e o hash de cada um rodam no pool.
+    void RecordAll(const std::vector<std::filesystem::path>& configPaths, WorkStealingPool* pool);
+
+    // Confere as entradas do manifesto contra o disco e devolve as chaves (KeyOf) dos arquivos
+    // que ainda tm o marcador. Entradas de arquivos que sumiram so descartadas.
+    std::unordered_set<std::string> CollectManaged(WorkStealingPool* pool);
+
+    static std::string KeyOf(const std::filesystem::path& p);
+
+    // Procura o marcador mapeando o arquivo em memria, sem copi-lo para uma std::string.
+    static bool FileContainsMarker(const std::filesystem::path& configPath);
+
+private:
+    struct Entry {
+        std::int64_t mtime = 0;
+        std::uint64_t size = 0;
+        std::uint64_t hash = 0;  // FNV-1a 64 do contedo
+        bool managed = false;
+    };
+
+    // L o arquivo atual (mapeado) e preenche mtime, tamanho, hash e marcador.
+    // Retorna false se o arquivo no pde ser aberto.
+    static bool Inspect(const std::filesystem::path& configPath, Entry& entry, const Entry* previous = nullptr);
+
+    std::unordered_map<std::string, Entry> _entries;
+    bool _loaded = false;
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+
+// Gera o config.json de um sub-moveset sem montar o documento inteiro. O texto atual do arquivo passa
+// por um rapidjson::Reader (SAX) direto para o Writer: os membros do usurio so copiados como esto,
+// "name" e "priority" so trocados no lugar e o array "conditions"  reescrito com as condies
+// preservadas (opcional) e o bloco gerenciado. O resultado tem os mesmos bytes que o caminho antigo
+// (Parse + alterar o Document + Accept), ento arquivos sem mudana continuam sendo pulados.
+// O bloco gerenciado continua sendo um Value: o ConditionOptimizer precisa da rvore toda para fatorar.
+namespace OarConfigWriter {
+    struct Options {
+        bool preserveConditions = false;  // Mantm as condies do usurio num bloco "Old Conditions"
+        bool compact = false;             // Writer em vez de PrettyWriter
+    };
+
+    // 'original'  o texto atual (vazio se o arquivo no existe); 'managedBlock' pode ser nulo.
+    // Devolve false se 'original' no era um objeto JSON vlido; nesse caso 'out' recebe um arquivo novo.
+    bool Write(const std::string& original, std::string_view name, int priority, const rapidjson::Value* managedBlock,
+               const Options& options, rapidjson::StringBuffer& out);
+}
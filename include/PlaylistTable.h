@@ -0,0 +1,51 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Settings.h"
+#include "SubmovesetTable.h"
+
+// Playlist do jogador compilada a partir de _categories: categoria  stance  moveset (pai)  direo.
+// Imutvel depois do Build; refeita s quando a configurao muda (load/save/rescan), de modo que
+// nome e tags do moveset atual viram leituras diretas em vez de percorrer as instncias.
+class PlaylistTable {
+public:
+    // 0 = pai; 1..8 = Front, FrontRight, Right, BackRight, Back, BackLeft, Left, FrontLeft
+    static constexpr int kDirections = 9;
+
+    struct Entry {
+        // Views do StringPool (nunca invalidadas). Direo sem filho usa o nome do pai.
+        std::array<std::string_view, kDirections> names;
+        MovesetTags tags;
+
+        std::string_view NameFor(int directionalState) const {
+            return names[directionalState > 0 && directionalState < kDirections ? directionalState : 0];
+        }
+    };
+
+    using IdResolver = std::function<SubmovesetId(const SubAnimationInstance&)>;
+
+    void Build(const std::map<std::string, WeaponCategory>& categories, const std::vector<AnimationModDef>& mods,
+               const SubmovesetTable& library, const IdResolver& resolveId);
+
+    std::optional<std::uint32_t> CategoryIdOf(const std::string& name) const;
+    // movesetIndex comea em 1, como no ciclo do jogo. nullptr se no existir.
+    const Entry* At(std::uint32_t categoryId, int stanceIndex, int movesetIndex) const;
+    int CountOf(std::uint32_t categoryId, int stanceIndex) const;
+
+private:
+    struct Range {
+        std::uint32_t first = 0;
+        std::uint32_t count = 0;
+    };
+
+    std::unordered_map<std::string, std::uint32_t> _categoryIds;
+    std::vector<std::array<Range, 4>> _stances;  // Por categoria: fatia de _entries de cada stance
+    std::vector<Entry> _entries;
+};
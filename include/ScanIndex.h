@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "LibraryWalker.h"
+
+// "Carimbo" de uma pasta: se nada aqui mudou, a listagem do scan anterior continua vlida.
+// Criar/remover/renomear arquivos ou subpastas altera o mtime da pasta. O CycleDar.json entra
+// separado porque editar o contedo dele no mexe no mtime da pasta.
+// Limitao: no usvfs do MO2 o mtime da pasta virtual nem sempre muda quando um mod passa a
+// trazer arquivos ou subpastas para ela; nesse caso a listagem salva (subpastas e tags dos .hkx)
+// fica velha at a pasta mudar de novo. Apagar o ScanIndex.bin fora um scan completo.
+struct FolderStamp {
+    std::int64_t folderTime = 0;
+    std::int64_t cycleDarTime = 0;
+    std::uint64_t cycleDarSize = 0;
+
+    bool operator==(const FolderStamp&) const = default;
+
+    static FolderStamp Of(const std::filesystem::path& folder, bool withCycleDar);
+};
+
+// O que o LibraryWalker precisa de uma pasta sem ter que list-la de novo.
+struct FolderListing {
+    FolderStamp stamp;
+    std::uint8_t flags = 0;              // FolderFlags
+    HkxTags tags;
+    std::vector<std::string> childDirs;  // Nomes (UTF-8) das subpastas, na ordem da listagem
+};
+
+// ndice persistente do escaneamento da biblioteca.
+// Durante o scan paralelo, as consultas leem s o ndice carregado do disco (imutvel) e
+// os resultados da sesso atual vo para um mapa separado, protegido por mutex. No Save s
+// as entradas vistas nesta sesso so gravadas, ento pastas apagadas somem do ndice.
+class ScanIndex {
+public:
+    static constexpr std::uint32_t kVersion = 2;
+
+    bool Load(const std::filesystem::path& indexPath);
+    bool Save(const std::filesystem::path& indexPath) const;
+
+    // Cabealho do mod (config.json de topo): nome e autor.
+    bool TryGetModHeader(const std::filesystem::path& configPath, std::string& name, std::string& author);
+    void PutModHeader(const std::filesystem::path& configPath, const std::string& name, const std::string& author);
+
+    // Confere o carimbo atual da pasta no disco antes de devolver a listagem salva.
+    bool TryGetFolder(const std::filesystem::path& folder, FolderListing& out);
+    void PutFolder(const std::filesystem::path& folder, const FolderListing& listing);
+    // Passa o que foi visto nesta sesso para o ndice consultado, para que um walk seguinte
+    // (o scan depois do import do CycleDar) no liste de novo. No pode rodar junto com um walk.
+    void AdoptCurrent();
+
+    // Consultas ao ndice carregado do disco, sem tocar no disco (usadas pelo import do CycleDar no load).
+    std::vector<std::filesystem::path> LoadedFoldersWith(std::uint8_t flags) const;
+    bool HasLoadedFolder(const std::filesystem::path& folder) const;
+
+    std::size_t GetHits() const { return _hits.load(std::memory_order_relaxed); }
+    std::size_t GetMisses() const { return _misses.load(std::memory_order_relaxed); }
+
+private:
+    struct ModHeaderEntry {
+        std::int64_t configTime = 0;
+        std::uint64_t configSize = 0;
+        std::string name;
+        std::string author;
+    };
+
+    static std::string KeyOf(const std::filesystem::path& p);
+
+    std::unordered_map<std::string, ModHeaderEntry> _loadedMods;
+    std::unordered_map<std::string, FolderListing> _loadedFolders;
+
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, ModHeaderEntry> _currentMods;
+    std::unordered_map<std::string, FolderListing> _currentFolders;
+
+    std::atomic<std::size_t> _hits{0};
+    std::atomic<std::size_t> _misses{0};
+};
@@ -1,9 +1,11 @@
 #pragma once
 #include <array>
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <vector>
 #include "MCP.h"
+#include "StringPool.h"
 
 struct DPATags {
     bool hasA = false;  // Para BFCO_PowerAttackA.hkx
@@ -19,20 +21,26 @@ struct MovesetTags {
     bool hasCPA = false;
 };
 // --- Definies da Biblioteca ---
+// Id global e denso de um sub-moveset na biblioteca (ver SubmovesetTable)
+using SubmovesetId = std::uint32_t;
+inline constexpr SubmovesetId kInvalidSubmoveset = 0xFFFFFFFF;
+
 struct SubAnimationDef {
-    std::string name;
-    std::filesystem::path path;
+    PooledString name;         // Internados: copiar um SubAnimationDef no copia strings
+    PooledPath path;
     int attackCount = 0;       // Contagem de arquivos BFCO_Attack
     int powerAttackCount = 0;  // Contagem de arquivos BFCO_PowerAttack
     bool hasIdle = false;      // Presena de arquivos "idle"
     bool hasAnimations = false;
     DPATags dpaTags;
     bool hasCPA = false;  
+    bool isMissing = false;  // Pasta sumiu num rescan; o slot fica para no deslocar os ndices
 };
 struct AnimationModDef {
     std::string name;
     std::string author;
     std::vector<SubAnimationDef> subAnimations;
+    std::filesystem::path path;  // Pasta de topo do mod no OAR (vazio para mods virtuais)
 };
 
 // --- Estruturas de Configurao do Usurio ---
@@ -42,6 +50,7 @@ struct SubAnimationInstance {
     std::string sourceSubName;  // Nome da sub-animao de origem (e.g., "700036")
     size_t sourceModIndex;
     size_t sourceSubAnimIndex;
+    SubmovesetId subMovesetId = kInvalidSubmoveset;  // ndice nas tabelas quentes da biblioteca
     std::array<char, 128> editedName{};
     bool isSelected = true;
     bool pFront = false;
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "rapidjson/document.h"
+
+// Estado do usurio em um nico arquivo (UserState.bin). Cada seo guarda, numa codificao binria
+// compacta (Encode/Decode), o JSON que antes s existia em arquivos soltos: "rules/<pasta>"
+// (User_CycleMoveset.json de cada pasta), "stances/<categoria>", "categories/<categoria>",
+// "user_movesets" e "settings". Cabealho versionado e FNV-1a 64 do contedo; lido com uma nica
+// leitura no primeiro acesso e gravado em .tmp + rename.
+// Os arquivos soltos viram exportao opcional (Settings::exportPerFolderJson) e continuam sendo
+// lidos quando a seo no existe ou quando so mais novos que ela (IsNewer: arquivo compartilhado).
+class StateStore {
+public:
+    static constexpr std::uint32_t kVersion = 2;  // 2: sees em binrio, com a data da ltima mudana
+    using Sections = std::map<std::string, std::string, std::less<>>;
+
+    static StateStore& Get();
+
+    std::optional<std::string> Find(std::string_view key) const;
+    void Put(std::string key, std::string payload);
+    // Troca todas as sees com o prefixo por estas; s marca para gravar o que de fato mudou.
+    // Sees antigas que no vieram em 'sections' so apagadas, a menos que keep(nome) retorne true.
+    void ReplacePrefix(std::string_view prefix, Sections sections,
+                       const std::function<bool(const std::string&)>& keep = {});
+    // Chama fn(nome, payload) para cada seo com o prefixo, em ordem de nome
+    void ForEachPrefix(std::string_view prefix,
+                       const std::function<void(const std::string&, const std::string&)>& fn) const;
+    // true se 'file' foi modificado depois da ltima mudana da seo 'key'
+    bool IsNewer(const std::filesystem::path& file, std::string_view key) const;
+
+    // Grava s se alguma seo mudou desde o Load/ltimo Save
+    bool Save();
+
+    static std::string RulesKey(const std::filesystem::path& folder);
+    static std::string Encode(const rapidjson::Value& value);
+    // false (e Document nulo) se os bytes no forem uma codificao vlida
+    static bool Decode(std::string_view bytes, rapidjson::Document& doc);
+
+private:
+    struct Section {
+        std::string payload;
+        std::int64_t stamp = 0;  // file_time_type da ltima mudana (mesma escala do last_write_time)
+    };
+
+    StateStore() = default;
+    bool Load(const std::filesystem::path& path);
+    static std::int64_t Now();
+
+    mutable std::mutex _lock;
+    std::map<std::string, Section, std::less<>> _sections;
+    std::filesystem::path _path;
+    bool _dirty = false;
+    bool _saveBlocked = false;  // O arquivo existe mas no pde ser lido nem movido para .bak
+};
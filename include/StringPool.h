@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Tabela global de strings internadas. Cada string distinta  gravada uma nica vez em blocos
+// contguos (arena) e referenciada por um id de 32 bits; ids e ponteiros nunca so invalidados.
+// Pode ser usada pelas threads do scan (Intern trava; leituras usam lock compartilhado).
+class StringPool {
+public:
+    using Id = std::uint32_t;
+    static constexpr Id kEmpty = 0;  // Sempre a string vazia
+
+    static StringPool& Get();
+
+    Id Intern(std::string_view s);
+    // View terminada em '\0', vlida enquanto o processo existir.
+    std::string_view View(Id id) const;
+
+    struct Stats {
+        std::size_t strings = 0;
+        std::size_t arenaBytes = 0;  // Bytes reservados nos blocos
+        std::size_t usedBytes = 0;   // Bytes realmente ocupados pelas strings
+        std::size_t indexBytes = 0;  // Estimativa de id -> offset e do mapa de deduplicao
+    };
+    Stats GetStats() const;
+
+private:
+    StringPool();
+
+    static constexpr std::size_t kBlockSize = 64 * 1024;
+
+    mutable std::shared_mutex _mutex;
+    std::vector<std::unique_ptr<char[]>> _blocks;
+    std::size_t _blockUsed = kBlockSize;  // Fora a criao do primeiro bloco
+    std::size_t _arenaBytes = 0;
+    std::size_t _usedBytes = 0;
+    std::vector<std::string_view> _views;  // id -> string na arena
+    std::unordered_map<std::string_view, Id> _ids;
+};
+
+// Nome internado (ex.: nome de um sub-moveset). Cpias custam 4 bytes.
+class PooledString {
+public:
+    PooledString() = default;
+    explicit PooledString(std::string_view s) : _id(StringPool::Get().Intern(s)) {}
+
+    PooledString& operator=(std::string_view s) {
+        _id = StringPool::Get().Intern(s);
+        return *this;
+    }
+
+    std::string_view view() const { return StringPool::Get().View(_id); }
+    const char* c_str() const { return view().data(); }
+    std::string str() const { return std::string(view()); }
+    bool empty() const { return _id == StringPool::kEmpty; }
+    StringPool::Id id() const { return _id; }
+
+    friend bool operator==(const PooledString& a, std::string_view b) { return a.view() == b; }
+
+private:
+    StringPool::Id _id = StringPool::kEmpty;
+};
+
+// Caminho internado, guardado em UTF-8. get() reconstri o std::filesystem::path.
+class PooledPath {
+public:
+    PooledPath() = default;
+    explicit PooledPath(const std::filesystem::path& p) { *this = p; }
+
+    PooledPath& operator=(const std::filesystem::path& p) {
+        const auto u8 = p.u8string();
+        _id = StringPool::Get().Intern(std::string_view(reinterpret_cast<const char*>(u8.data()), u8.size()));
+        return *this;
+    }
+
+    std::filesystem::path get() const {
+        const auto utf8 = StringPool::Get().View(_id);
+        return std::filesystem::path(std::u8string_view(reinterpret_cast<const char8_t*>(utf8.data()), utf8.size()));
+    }
+    std::string_view utf8() const { return StringPool::Get().View(_id); }
+    bool empty() const { return _id == StringPool::kEmpty; }
+    StringPool::Id id() const { return _id; }
+
+private:
+    StringPool::Id _id = StringPool::kEmpty;
+};
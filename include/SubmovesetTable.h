@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Settings.h"
+
+// Bits de capacidade de um sub-moveset, lidos pelos caminhos quentes (cache de contagem,
+// nome/tags do moveset atual, SaveAllSettings) sem tocar no SubAnimationDef.
+namespace SubmovesetCaps {
+    enum : std::uint16_t {
+        kHasAnimations = 1 << 0,
+        kHasIdle = 1 << 1,
+        kDpaA = 1 << 2,
+        kDpaB = 1 << 3,
+        kDpaL = 1 << 4,
+        kDpaR = 1 << 5,
+        kCpa = 1 << 6,
+        kMissing = 1 << 7
+    };
+}
+
+// Viso "structure of arrays" da biblioteca (_allMods). Cada sub-moveset ganha um id global
+// denso e estvel; os dados quentes ficam em vetores paralelos indexados por esse id, enquanto
+// nomes e caminhos continuam no SubAnimationDef (dados frios).
+class SubmovesetTable {
+public:
+    void Clear();
+
+    // D id aos sub-movesets novos e atualiza os bits dos existentes. Como os rescans s
+    // acrescentam no fim de cada mod, os ids de (mod, sub) j vistos no mudam.
+    void Sync(const std::vector<AnimationModDef>& mods);
+    // Igual ao Sync, mas s para um mod (usado pelos rescans incrementais).
+    void SyncMod(std::size_t modIdx, const AnimationModDef& mod);
+    // Mods a partir de modCount saram do fim de _allMods: os ids deles viram "missing".
+    void Truncate(std::size_t modCount);
+
+    SubmovesetId IdOf(std::size_t modIdx, std::size_t subIdx) const {
+        if (modIdx >= _idsByMod.size() || subIdx >= _idsByMod[modIdx].size()) return kInvalidSubmoveset;
+        return _idsByMod[modIdx][subIdx];
+    }
+
+    std::uint16_t CapsOf(SubmovesetId id) const { return id < _caps.size() ? _caps[id] : 0; }
+    bool HasAnimations(SubmovesetId id) const { return (CapsOf(id) & SubmovesetCaps::kHasAnimations) != 0; }
+    MovesetTags TagsOf(SubmovesetId id) const;
+    int AttackCountOf(SubmovesetId id) const { return id < _attackCounts.size() ? _attackCounts[id] : 0; }
+    int PowerAttackCountOf(SubmovesetId id) const { return id < _powerAttackCounts.size() ? _powerAttackCounts[id] : 0; }
+    // Muda toda vez que um sync altera os dados do id (ex.: rescan de uma pasta no lugar)
+    std::uint32_t RevisionOf(SubmovesetId id) const { return id < _revisions.size() ? _revisions[id] : 0; }
+
+    // Volta para os dados frios (_allMods[mod].subAnimations[sub])
+    std::size_t ModIndexOf(SubmovesetId id) const { return _modIndex[id]; }
+    std::size_t SubIndexOf(SubmovesetId id) const { return _subIndex[id]; }
+    std::size_t Size() const { return _caps.size(); }
+
+    // Resolve o caminho de um sub-moveset (ex.: sourceConfigPath do User_CycleMoveset.json) sem
+    // tocar no disco. kInvalidSubmoveset se no houver nenhum com esse caminho.
+    SubmovesetId FindByPath(const std::filesystem::path& path) const;
+    // ndices por nome mantidos pelo Sync/SyncMod. Com nomes repetidos vale o mod de menor ndice,
+    // como na busca linear antiga.
+    std::optional<std::size_t> FindMod(const std::string& name) const;
+    std::optional<std::size_t> FindSub(std::size_t modIdx, const std::string& name) const;
+
+    // Absoluto, normalizado, com '/' e ASCII minsculo: "Data\X\..\Y" e "data/y" do a mesma chave.
+    static std::string PathKey(const std::filesystem::path& path);
+
+private:
+    static std::uint16_t PackCaps(const SubAnimationDef& def);
+    void Store(SubmovesetId id, const SubAnimationDef& def);
+    void MarkMissing(SubmovesetId id);
+    void IndexModName(std::size_t modIdx, const std::string& name);
+    // Outro mod com o mesmo nome e ndice < searchLimit assume a chave
+    void UnindexModName(std::size_t modIdx, std::size_t searchLimit);
+
+    std::vector<std::uint16_t> _caps;
+    std::vector<std::uint16_t> _attackCounts;
+    std::vector<std::uint16_t> _powerAttackCounts;
+    std::vector<std::uint32_t> _revisions;
+    std::vector<std::uint32_t> _modIndex;
+    std::vector<std::uint32_t> _subIndex;
+    std::vector<std::vector<SubmovesetId>> _idsByMod;
+    std::unordered_map<std::string, SubmovesetId> _idsByPath;
+    std::vector<std::string> _modNames;
+    std::unordered_map<std::string, std::uint32_t> _modsByName;
+    std::vector<std::unordered_map<std::string, std::uint32_t>> _subsByName;
+};
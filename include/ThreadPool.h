@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de threads com "work stealing": cada worker tem a sua prpria fila (LIFO para o dono)
+// e, quando ela esvazia, rouba tarefas do incio da fila dos outros workers.
+// A thread que chama ParallelFor/Wait tambm ajuda a executar tarefas enquanto espera.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threadCount == 0 usa (ncleos - 1), j que a thread chamadora tambm trabalha.
+    explicit WorkStealingPool(std::size_t threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void Submit(Task task);
+
+    // Bloqueia at que todas as tarefas enviadas terminem, executando tarefas no meio tempo.
+    void Wait();
+
+    // Executa fn(i) para cada i em [0, count) e s retorna quando todos terminarem.
+    // Excees de fn so registradas no log e no interrompem os outros ndices.
+    template <class Fn>
+    void ParallelFor(std::size_t count, Fn&& fn) {
+        if (count == 0) return;
+        std::atomic<std::size_t> remaining{count};
+        for (std::size_t i = 0; i < count; ++i) {
+            Submit([&fn, &remaining, i] {
+                RunGuarded([&] { fn(i); });
+                remaining.fetch_sub(1, std::memory_order_acq_rel);
+            });
+        }
+        HelpUntil([&remaining] { return remaining.load(std::memory_order_acquire) == 0; });
+    }
+
+    std::size_t GetThreadCount() const { return _workers.size(); }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(std::size_t index);
+    bool TryPop(std::size_t index, Task& out);
+    bool TrySteal(std::size_t thief, Task& out);
+    void RunTask(Task& task);
+    void HelpUntil(const std::function<bool()>& done);
+    static void RunGuarded(const std::function<void()>& fn);
+
+    std::vector<std::unique_ptr<WorkQueue>> _queues;
+    std::vector<std::thread> _workers;
+
+    std::mutex _sleepMutex;
+    std::condition_variable _wakeCv;  // Acorda workers quando h tarefas na fila
+    std::condition_variable _doneCv;  // Acorda quem espera quando uma tarefa termina
+
+    std::atomic<std::size_t> _queued{0};   // Tarefas ainda em alguma fila
+    std::atomic<std::size_t> _pending{0};  // Tarefas enviadas e ainda no concludas
+    std::atomic<std::size_t> _nextQueue{0};
+    bool _stopping = false;
+};
@@ -0,0 +1,419 @@
+#include "ConditionOptimizer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <unordered_map>
+#include <vector>
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace {
+    using Value = rapidjson::Value;
+    using Allocator = rapidjson::Document::AllocatorType;
+
+    // Ramo de um OR visto como lista de condies de um AND (a partir de 'begin')
+    struct Suffix {
+        const Value* const* begin;
+        std::size_t size;
+    };
+
+    bool IsNegated(const Value& v) {
+        return v.HasMember("negated") && v["negated"].IsBool() && v["negated"].GetBool();
+    }
+
+    bool IsGroup(const Value& v) {
+        if (!v.IsObject() || !v.HasMember("Conditions") || !v["Conditions"].IsArray()) return false;
+        if (!v.HasMember("condition") || !v["condition"].IsString()) return false;
+        return v["condition"] == "AND" || v["condition"] == "OR";
+    }
+
+    bool IsPlainAnd(const Value& v) { return IsGroup(v) && v["condition"] == "AND" && !IsNegated(v); }
+
+    bool IsStateful(const Value& v) {
+        if (!v.IsObject()) return false;
+        if (v.HasMember("State")) return true;
+        if (v.HasMember("condition") && v["condition"].IsString() && v["condition"] == "Random") return true;
+        if (IsGroup(v)) {
+            for (const auto& child : v["Conditions"].GetArray()) {
+                if (IsStateful(child)) return true;
+            }
+        }
+        return false;
+    }
+
+    std::size_t CountNodes(const Value& v) {
+        std::size_t count = 1;
+        if (IsGroup(v)) {
+            for (const auto& child : v["Conditions"].GetArray()) count += CountNodes(child);
+        }
+        return count;
+    }
+
+    bool SameCondition(const Value* a, const Value* b) { return !IsStateful(*a) && *a == *b; }
+
+    Value MakeGroup(const char* kind, Allocator& allocator) {
+        Value block(rapidjson::kObjectType);
+        block.AddMember("condition", rapidjson::StringRef(kind), allocator);
+        block.AddMember("Conditions", Value(rapidjson::kArrayType), allocator);
+        return block;
+    }
+
+    Value MakeAnd(const Suffix& suffix, Allocator& allocator) {
+        if (suffix.size == 1) return Value(*suffix.begin[0], allocator);
+        Value block = MakeGroup("AND", allocator);
+        for (std::size_t i = 0; i < suffix.size; ++i) {
+            block["Conditions"].PushBack(Value(*suffix.begin[i], allocator), allocator);
+        }
+        return block;
+    }
+
+    void FactorInto(const std::vector<Suffix>& branches, Value& out, Allocator& allocator) {
+        // Agrupa pela primeira condio, mantendo a ordem da primeira apario
+        std::vector<std::vector<std::size_t>> groups;
+        for (std::size_t i = 0; i < branches.size(); ++i) {
+            const Value* head = branches[i].begin[0];
+            bool placed = false;
+            for (auto& group : groups) {
+                if (SameCondition(branches[group.front()].begin[0], head)) {
+                    group.push_back(i);
+                    placed = true;
+                    break;
+                }
+            }
+            if (!placed) groups.push_back({i});
+        }
+
+        for (const auto& group : groups) {
+            const Suffix& first = branches[group.front()];
+            if (group.size() == 1) {
+                out.PushBack(MakeAnd(first, allocator), allocator);
+                continue;
+            }
+
+            std::size_t prefix = 1;
+            bool consumed = false;  // Algum ramo  s o prefixo: p AND (true OR ...) = p
+            for (;; ++prefix) {
+                bool extend = true;
+                for (const auto idx : group) {
+                    if (branches[idx].size == prefix) {
+                        consumed = true;
+                        extend = false;
+                        break;
+                    }
+                    if (!SameCondition(first.begin[prefix], branches[idx].begin[prefix])) extend = false;
+                }
+                if (!extend) break;
+            }
+
+            Value block = MakeGroup("AND", allocator);
+            auto& conditions = block["Conditions"];
+            for (std::size_t i = 0; i < prefix; ++i) {
+                conditions.PushBack(Value(*first.begin[i], allocator), allocator);
+            }
+            if (!consumed) {
+                std::vector<Suffix> rest;
+                rest.reserve(group.size());
+                for (const auto idx : group) {
+                    rest.push_back({branches[idx].begin + prefix, branches[idx].size - prefix});
+                }
+                Value inner(rapidjson::kArrayType);
+                FactorInto(rest, inner, allocator);
+                if (inner.Size() == 1) {
+                    // AND(p, AND(q, r)) = AND(p, q, r)
+                    if (IsPlainAnd(inner[0u])) {
+                        for (auto& child : inner[0u]["Conditions"].GetArray()) conditions.PushBack(child, allocator);
+                    } else {
+                        conditions.PushBack(inner[0u], allocator);
+                    }
+                } else {
+                    Value orBlock = MakeGroup("OR", allocator);
+                    orBlock["Conditions"] = inner;
+                    conditions.PushBack(orBlock, allocator);
+                }
+            }
+            out.PushBack(block, allocator);
+        }
+    }
+
+    // --- Modelo de custo ---
+
+    struct ConditionCost {
+        std::string_view name;
+        double cost;
+        double pass;
+    };
+
+    // Custos relativos a um CompareValues de varivel do behavior (1.0). Keywords e faces
+    // percorrem listas do ator/arma; as comparaes de forma so um ponteiro.
+    constexpr ConditionCost kConditionCosts[] = {
+        {"CompareValues", 1.0, 0.5},         {"IsEquippedType", 1.5, 0.15}, {"IsActorBase", 1.5, 0.3},
+        {"IsRace", 1.5, 0.3},                {"IsEquippedHasKeyword", 3.0, 0.3}, {"HasKeyword", 4.0, 0.3},
+        {"IsInFaction", 6.0, 0.3},           {"CycleMovesetActive", 2.5, 0.03},
+    };
+
+    // Chance de passar das variveis que o prprio plugin escreve no behavior
+    constexpr std::pair<std::string_view, double> kGraphVariablePass[] = {
+        {"cycle_instance", 0.25},          // Uma de 4 stances
+        {"testarone", 0.2},                // Posio na playlist
+        {"CycleMovesetNpcType", 0.25},     // Jogador / NPC geral / regras especficas
+        {"DirecionalCycleMoveset", 0.125}, // Uma de 8 direes
+        {"CycleMovesetDisable", 0.02},
+    };
+
+    std::string_view StringOf(const Value& v) { return std::string_view(v.GetString(), v.GetStringLength()); }
+
+    double Rank(const ConditionOptimizer::CostEstimate& e, bool forAnd) {
+        // Em AND interessa falhar cedo; em OR, passar cedo
+        const double decisive = forAnd ? 1.0 - e.pass : e.pass;
+        return decisive > 0.0 ? e.cost / decisive : std::numeric_limits<double>::infinity();
+    }
+
+    void OrderGroup(Value& conditions, bool isAnd, Allocator& allocator) {
+        for (auto& child : conditions.GetArray()) {
+            if (IsGroup(child)) OrderGroup(child["Conditions"], child["condition"] == "AND", allocator);
+        }
+
+        const auto count = conditions.Size();
+        std::vector<double> ranks(count);
+        std::vector<bool> fixed(count);
+        for (rapidjson::SizeType i = 0; i < count; ++i) {
+            fixed[i] = IsStateful(conditions[i]);
+            ranks[i] = Rank(ConditionOptimizer::Estimate(conditions[i]), isAnd);
+        }
+
+        std::vector<rapidjson::SizeType> order(count);
+        for (rapidjson::SizeType i = 0; i < count; ++i) order[i] = i;
+        // Ordena s entre condies com estado, que funcionam como barreiras
+        for (std::size_t begin = 0; begin < count;) {
+            if (fixed[begin]) {
+                ++begin;
+                continue;
+            }
+            std::size_t end = begin;
+            while (end < count && !fixed[end]) ++end;
+            std::stable_sort(order.begin() + begin, order.begin() + end,
+                             [&](auto a, auto b) { return ranks[a] < ranks[b]; });
+            begin = end;
+        }
+
+        bool changed = false;
+        for (rapidjson::SizeType i = 0; i < count; ++i) changed |= order[i] != i;
+        if (!changed) return;
+
+        Value reordered(rapidjson::kArrayType);
+        reordered.Reserve(count, allocator);
+        for (const auto idx : order) reordered.PushBack(conditions[idx], allocator);
+        conditions = reordered;
+    }
+
+    // --- Verificao de equivalncia ---
+
+    // Ramo da forma normal disjuntiva: ids das condies folha, ordenados e sem repetio
+    using Branch = std::vector<std::uint32_t>;
+    constexpr std::size_t kMaxExpandedBranches = std::size_t{1} << 16;
+
+    // Expande a rvore em OR de ANDs de folhas. Folha  qualquer condio que no seja um AND/OR
+    // sem "negated" (grupos negados tambm); condies iguais no JSON viram o mesmo id.
+    class Expander {
+    public:
+        explicit Expander(std::unordered_map<std::string, std::uint32_t>& atoms) : _atoms(atoms) {}
+
+        // false se a expanso passou de kMaxExpandedBranches ramos
+        bool ExpandOr(const Value& orConditions, std::set<Branch>& out) {
+            for (const auto& child : orConditions.GetArray()) {
+                for (auto& branch : Expand(child)) out.insert(std::move(branch));
+                if (_overflow) return false;
+            }
+            return true;
+        }
+
+    private:
+        std::vector<Branch> Expand(const Value& v) {
+            if (!IsGroup(v) || IsNegated(v)) return {Branch{AtomOf(v)}};
+
+            std::vector<Branch> result;
+            if (v["condition"] == "OR") {
+                for (const auto& child : v["Conditions"].GetArray()) {
+                    for (auto& branch : Expand(child)) result.push_back(std::move(branch));
+                    if (_overflow || result.size() > kMaxExpandedBranches) return Overflow();
+                }
+                return result;
+            }
+
+            // AND: produto dos ramos de cada filho
+            result.emplace_back();
+            for (const auto& child : v["Conditions"].GetArray()) {
+                const auto part = Expand(child);
+                if (_overflow || result.size() * part.size() > kMaxExpandedBranches) return Overflow();
+                std::vector<Branch> product;
+                product.reserve(result.size() * part.size());
+                for (const auto& left : result) {
+                    for (const auto& right : part) {
+                        Branch merged;
+                        merged.reserve(left.size() + right.size());
+                        std::set_union(left.begin(), left.end(), right.begin(), right.end(),
+                                       std::back_inserter(merged));
+                        product.push_back(std::move(merged));
+                    }
+                }
+                result = std::move(product);
+            }
+            return result;
+        }
+
+        std::vector<Branch> Overflow() {
+            _overflow = true;
+            return {};
+        }
+
+        std::uint32_t AtomOf(const Value& v) {
+            rapidjson::StringBuffer buffer;
+            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+            v.Accept(writer);
+            auto [it, inserted] = _atoms.try_emplace(std::string(buffer.GetString(), buffer.GetSize()),
+                                                     static_cast<std::uint32_t>(_atoms.size()));
+            return it->second;
+        }
+
+        std::unordered_map<std::string, std::uint32_t>& _atoms;
+        bool _overflow = false;
+    };
+
+    // Todo ramo de 'from' existe em 'by' ou contm algum ramo de 'by' (x AND y j  coberto por x)
+    bool CoveredBy(const std::set<Branch>& from, const std::set<Branch>& by) {
+        for (const auto& branch : from) {
+            if (by.contains(branch)) continue;
+            const bool absorbed = std::any_of(by.begin(), by.end(), [&](const Branch& other) {
+                return other.size() < branch.size() &&
+                       std::includes(branch.begin(), branch.end(), other.begin(), other.end());
+            });
+            if (!absorbed) return false;
+        }
+        return true;
+    }
+}
+
+namespace ConditionOptimizer {
+    CostEstimate Estimate(const rapidjson::Value& condition) {
+        CostEstimate estimate{5.0, 0.5};  // Desconhecida: cara e neutra
+        if (!condition.IsObject()) return estimate;
+
+        if (IsGroup(condition)) {
+            const bool isAnd = condition["condition"] == "AND";
+            // Custo esperado com curto-circuito na ordem atual
+            double reach = 1.0;
+            estimate.cost = 0.0;
+            estimate.pass = isAnd ? 1.0 : 0.0;
+            for (const auto& child : condition["Conditions"].GetArray()) {
+                const auto e = Estimate(child);
+                estimate.cost += reach * e.cost;
+                if (isAnd) {
+                    reach *= e.pass;
+                    estimate.pass *= e.pass;
+                } else {
+                    reach *= 1.0 - e.pass;
+                    estimate.pass = 1.0 - (1.0 - estimate.pass) * (1.0 - e.pass);
+                }
+            }
+        } else if (condition.HasMember("condition") && condition["condition"].IsString()) {
+            const auto name = StringOf(condition["condition"]);
+            for (const auto& entry : kConditionCosts) {
+                if (entry.name == name) {
+                    estimate = {entry.cost, entry.pass};
+                    break;
+                }
+            }
+            if (name == "CompareValues" && condition.HasMember("Value B") && condition["Value B"].IsObject() &&
+                condition["Value B"].HasMember("graphVariable") && condition["Value B"]["graphVariable"].IsString()) {
+                const auto variable = StringOf(condition["Value B"]["graphVariable"]);
+                for (const auto& [graphVariable, pass] : kGraphVariablePass) {
+                    if (graphVariable == variable) estimate.pass = pass;
+                }
+            }
+        }
+
+        if (condition.HasMember("negated") && condition["negated"].IsBool() && condition["negated"].GetBool()) {
+            estimate.pass = 1.0 - estimate.pass;
+        }
+        return estimate;
+    }
+
+    void OrderByCost(rapidjson::Value& orConditions, rapidjson::Document::AllocatorType& allocator) {
+        if (orConditions.IsArray()) OrderGroup(orConditions, false, allocator);
+    }
+
+    bool EquivalentOr(const rapidjson::Value& a, const rapidjson::Value& b) {
+        std::unordered_map<std::string, std::uint32_t> atoms;
+        Expander expander(atoms);
+        std::set<Branch> branchesA;
+        std::set<Branch> branchesB;
+        if (!expander.ExpandOr(a, branchesA) || !expander.ExpandOr(b, branchesB)) {
+            SKSE::log::warn("[ConditionOptimizer] Bloco grande demais para verificar (> {} ramos).",
+                            kMaxExpandedBranches);
+            return false;
+        }
+        // Com as folhas como variveis livres, dois ORs de ANDs (sem negao no meio) so equivalentes
+        // exatamente quando cada ramo de um contm algum ramo do outro
+        return CoveredBy(branchesA, branchesB) && CoveredBy(branchesB, branchesA);
+    }
+
+    Stats FactorSharedPrefixes(rapidjson::Value& orConditions, rapidjson::Document::AllocatorType& allocator) {
+        Stats stats;
+        if (!orConditions.IsArray()) return stats;
+        for (const auto& branch : orConditions.GetArray()) stats.nodesBefore += CountNodes(branch);
+        stats.nodesAfter = stats.nodesBefore;
+        if (orConditions.Size() < 2) return stats;
+
+        std::vector<std::vector<const Value*>> storage;
+        storage.reserve(orConditions.Size());
+        std::vector<Suffix> branches;
+        branches.reserve(orConditions.Size());
+        for (const auto& branch : orConditions.GetArray()) {
+            auto& list = storage.emplace_back();
+            if (IsPlainAnd(branch) && !branch["Conditions"].Empty()) {
+                for (const auto& child : branch["Conditions"].GetArray()) list.push_back(&child);
+            } else {
+                list.push_back(&branch);
+            }
+            branches.push_back({list.data(), list.size()});
+        }
+
+        Value factored(rapidjson::kArrayType);
+        FactorInto(branches, factored, allocator);
+
+        std::size_t nodesAfter = 0;
+        for (const auto& branch : factored.GetArray()) nodesAfter += CountNodes(branch);
+        if (nodesAfter >= stats.nodesBefore) return stats;
+
+        if (!EquivalentOr(orConditions, factored)) {
+            SKSE::log::error("[ConditionOptimizer] rvore fatorada no  equivalente  original; mantendo a original.");
+            return stats;
+        }
+        orConditions = factored;
+        stats.nodesAfter = nodesAfter;
+        stats.applied = true;
+        return stats;
+    }
+
+    Stats Optimize(rapidjson::Value& orConditions, rapidjson::Document::AllocatorType& allocator) {
+        Stats stats;
+        if (!orConditions.IsArray() || orConditions.Empty()) return stats;
+
+        const Value original(orConditions, allocator);
+        stats = FactorSharedPrefixes(orConditions, allocator);
+        OrderByCost(orConditions, allocator);
+        if (!EquivalentOr(original, orConditions)) {
+            SKSE::log::error("[ConditionOptimizer] Bloco otimizado no  equivalente ao original; mantendo o original.");
+            orConditions.CopyFrom(original, allocator);
+            stats.nodesAfter = stats.nodesBefore;
+            stats.applied = false;
+        }
+        return stats;
+    }
+}
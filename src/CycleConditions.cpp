@@ -0,0 +1,168 @@
+#include "CycleConditions.h"
+
+// --- Suporte da API de condies do OAR (as definies que o header do OAR deixa para o plugin) ---
+
+OAR_API::Conditions::IConditionsInterface* g_oarConditionsInterface = nullptr;
+
+namespace Conditions {
+    CustomCondition::CustomCondition() {
+        if (g_oarConditionsInterface) {
+            const auto factory = g_oarConditionsInterface->GetWrappedConditionFactory();
+            _wrappedCondition = std::unique_ptr<ICondition>(factory());
+        }
+    }
+
+    bool CustomCondition::Evaluate(RE::TESObjectREFR* a_refr, RE::hkbClipGenerator* a_clipGenerator,
+                                   void* a_parentSubMod) const {
+        if (a_refr) {
+            if (const auto refrToEvaluate = GetRefrToEvaluate(a_refr)) {
+                return EvaluateImpl(refrToEvaluate, a_clipGenerator, a_parentSubMod) != _wrappedCondition->IsNegated();
+            }
+        }
+        return false;
+    }
+
+    IConditionComponent* CustomCondition::AddBaseComponent(ConditionComponentType a_componentType, const char* a_name,
+                                                           const char* a_description) {
+        if (g_oarConditionsInterface) {
+            if (const auto factory = g_oarConditionsInterface->GetConditionComponentFactory(a_componentType)) {
+                return AddComponent(factory, a_name, a_description);
+            }
+        }
+        return nullptr;
+    }
+}
+
+namespace OAR_API::Conditions {
+    IConditionsInterface* GetAPI(InterfaceVersion a_interfaceVersion) {
+        if (g_oarConditionsInterface) {
+            return g_oarConditionsInterface;
+        }
+
+        const auto pluginHandle = GetModuleHandleA("OpenAnimationReplacer.dll");
+        if (!pluginHandle) {
+            return nullptr;
+        }
+        const auto requestAPIFunction =
+            reinterpret_cast<_RequestPluginAPI_Conditions>(GetProcAddress(pluginHandle, "RequestPluginAPI_Conditions"));
+        if (requestAPIFunction) {
+            const auto plugin = SKSE::PluginDeclaration::GetSingleton();
+            g_oarConditionsInterface =
+                requestAPIFunction(a_interfaceVersion, plugin->GetName().data(), plugin->GetVersion());
+        }
+        return g_oarConditionsInterface;
+    }
+}
+
+namespace CycleConditions {
+    namespace {
+        constexpr std::uint32_t kMaxExactFloat = 1u << 24;
+        bool g_registered = false;
+
+        struct ActorSlotState {
+            std::int32_t npcType = 0;
+            std::int32_t instance = 0;
+            std::int32_t playlist = 0;
+            std::int32_t direction = 0;
+        };
+
+        ActorSlotState ReadState(RE::TESObjectREFR* refr) {
+            // Os nomes so interned uma vez; criar um BSFixedString por avaliao custaria uma busca na tabela global
+            static const RE::BSFixedString npcTypeVar{"CycleMovesetNpcType"};
+            static const RE::BSFixedString instanceVar{"cycle_instance"};
+            static const RE::BSFixedString playlistVar{"testarone"};
+            static const RE::BSFixedString directionVar{"DirecionalCycleMoveset"};
+
+            ActorSlotState state;
+            refr->GetGraphVariableInt(npcTypeVar, state.npcType);
+            refr->GetGraphVariableInt(instanceVar, state.instance);
+            refr->GetGraphVariableInt(playlistVar, state.playlist);
+            refr->GetGraphVariableInt(directionVar, state.direction);
+            return state;
+        }
+    }
+
+    std::optional<std::uint32_t> SlotKey::Encode() const {
+        if (npcType < 0 || npcType > 7 || instance < 0 || instance > 7 || playlist < 0 || playlist > 255) {
+            return std::nullopt;
+        }
+        const std::uint32_t id = static_cast<std::uint32_t>(npcType) | (static_cast<std::uint32_t>(instance) << 3) |
+                                 (static_cast<std::uint32_t>(playlist) << 6) |
+                                 (static_cast<std::uint32_t>(directions) << 14) |
+                                 (excludeDirections ? (1u << 22) : 0u);
+        if (id >= kMaxExactFloat) return std::nullopt;
+        return id;
+    }
+
+    SlotKey SlotKey::Decode(std::uint32_t id) {
+        SlotKey key;
+        key.npcType = static_cast<int>(id & 0x7);
+        key.instance = static_cast<int>((id >> 3) & 0x7);
+        key.playlist = static_cast<int>((id >> 6) & 0xFF);
+        key.directions = static_cast<std::uint8_t>((id >> 14) & 0xFF);
+        key.excludeDirections = ((id >> 22) & 0x1) != 0;
+        return key;
+    }
+
+    bool SlotKey::Matches(int actorNpcType, int actorInstance, int actorPlaylist, int actorDirection) const {
+        if (actorNpcType != npcType || actorInstance != instance) return false;
+        if (playlist == 0) return true;
+        if (actorPlaylist != playlist) return false;
+        if (directions == 0) return true;
+
+        const bool inMask = actorDirection >= 1 && actorDirection <= 8 && (directions & (1u << (actorDirection - 1)));
+        return excludeDirections ? !inMask : inMask;
+    }
+
+    CycleMovesetActiveCondition::CycleMovesetActiveCondition() {
+        slotComponent = static_cast<::Conditions::INumericConditionComponent*>(AddBaseComponent(
+            ::Conditions::ConditionComponentType::kNumeric, "Slot", "Slot id generated by Cycle Movesets."));
+    }
+
+    RE::BSString CycleMovesetActiveCondition::GetArgument() const {
+        if (!slotComponent) return "";
+        const auto key = SlotKey::Decode(static_cast<std::uint32_t>(slotComponent->GetNumericValue(nullptr)));
+        const auto text = std::format("type {} | stance {} | playlist {} | directions {:08b}{}", key.npcType,
+                                      key.instance, key.playlist, key.directions,
+                                      key.excludeDirections ? " (excluded)" : "");
+        return text.c_str();
+    }
+
+    RE::BSString CycleMovesetActiveCondition::GetCurrent(RE::TESObjectREFR* a_refr) const {
+        if (!a_refr) return "";
+        const auto state = ReadState(a_refr);
+        const auto text = std::format("type {} | stance {} | playlist {} | direction {}", state.npcType,
+                                      state.instance, state.playlist, state.direction);
+        return text.c_str();
+    }
+
+    bool CycleMovesetActiveCondition::EvaluateImpl(RE::TESObjectREFR* a_refr,
+                                                   [[maybe_unused]] RE::hkbClipGenerator* a_clipGenerator,
+                                                   [[maybe_unused]] void* a_parentSubMod) const {
+        if (!slotComponent) return false;
+        const float value = slotComponent->GetNumericValue(a_refr);
+        if (value < 0.0f || value >= static_cast<float>(kMaxExactFloat)) return false;
+
+        const auto key = SlotKey::Decode(static_cast<std::uint32_t>(value));
+        const auto state = ReadState(a_refr);
+        return key.Matches(state.npcType, state.instance, state.playlist, state.direction);
+    }
+
+    void Register() {
+        if (!OAR_API::Conditions::GetAPI()) {
+            SKSE::log::warn("API de condies do OAR indisponvel. As configs usaro as condies em JSON.");
+            return;
+        }
+        const auto result = OAR_API::Conditions::AddCustomCondition<CycleMovesetActiveCondition>();
+        g_registered = result == OAR_API::Conditions::APIResult::OK ||
+                       result == OAR_API::Conditions::APIResult::AlreadyRegistered;
+        if (g_registered) {
+            SKSE::log::info("Condio '{}' registrada no OAR.", CycleMovesetActiveCondition::CONDITION_NAME);
+        } else {
+            SKSE::log::warn("Falha ao registrar a condio '{}' no OAR (resultado {}).",
+                            CycleMovesetActiveCondition::CONDITION_NAME, static_cast<int>(result));
+        }
+    }
+
+    bool IsRegistered() { return g_registered; }
+}
@@ -0,0 +1,128 @@
+#include "DirectoryWatcher.h"
+
+#include <Windows.h>
+#include <cstddef>
+#include <string>
+
+namespace {
+    std::mutex g_factoryMutex;
+    DirectoryWatcherFactory g_factory;
+}
+
+Win32DirectoryWatcher::~Win32DirectoryWatcher() { Stop(); }
+
+bool Win32DirectoryWatcher::Start(const std::filesystem::path& root) {
+    Stop();
+
+    HANDLE directory = CreateFileW(root.c_str(), FILE_LIST_DIRECTORY,
+                                   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                   FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (directory == INVALID_HANDLE_VALUE) {
+        SKSE::log::warn("[DirectoryWatcher] No foi possvel observar '{}' (erro {}).", root.string(),
+                        GetLastError());
+        return false;
+    }
+    HANDLE stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!stopEvent) {
+        SKSE::log::warn("[DirectoryWatcher] Falha ao criar o evento de parada (erro {}).", GetLastError());
+        CloseHandle(directory);
+        return false;
+    }
+
+    _root = root;
+    _directory = directory;
+    _stopEvent = stopEvent;
+    _thread = std::thread([this] { WatchLoop(); });
+    SKSE::log::info("[DirectoryWatcher] Observando '{}'.", root.string());
+    return true;
+}
+
+void Win32DirectoryWatcher::Stop() {
+    if (!_thread.joinable()) return;
+    // A thread acorda pelo evento, cancela a leitura pendente e espera o cancelamento terminar
+    SetEvent(static_cast<HANDLE>(_stopEvent));
+    _thread.join();
+    CloseHandle(static_cast<HANDLE>(_directory));
+    CloseHandle(static_cast<HANDLE>(_stopEvent));
+    _directory = nullptr;
+    _stopEvent = nullptr;
+}
+
+bool Win32DirectoryWatcher::Drain(std::vector<std::filesystem::path>& out) {
+    std::lock_guard lock(_mutex);
+    const bool complete = !_overflowed;
+    out.insert(out.end(), std::make_move_iterator(_changes.begin()), std::make_move_iterator(_changes.end()));
+    _changes.clear();
+    _overflowed = false;
+    _hasChanges.store(false, std::memory_order_release);
+    return complete;
+}
+
+void Win32DirectoryWatcher::WatchLoop() {
+    alignas(DWORD) std::byte buffer[64 * 1024];
+    const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME;
+    const auto directory = static_cast<HANDLE>(_directory);
+
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!overlapped.hEvent) {
+        SKSE::log::warn("[DirectoryWatcher] Falha ao criar o evento de leitura (erro {}).", GetLastError());
+        return;
+    }
+    const HANDLE waitHandles[] = {static_cast<HANDLE>(_stopEvent), overlapped.hEvent};
+
+    while (true) {
+        ResetEvent(overlapped.hEvent);
+        BOOL ok = ReadDirectoryChangesW(directory, buffer, sizeof(buffer), TRUE, filter, nullptr, &overlapped, nullptr);
+        DWORD bytes = 0;
+        if (ok) {
+            if (WaitForMultipleObjects(2, waitHandles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1) {
+                // Parada (ou falha na espera): o buffer s pode sair de escopo depois do cancelamento
+                CancelIoEx(directory, &overlapped);
+                GetOverlappedResult(directory, &overlapped, &bytes, TRUE);
+                break;
+            }
+            ok = GetOverlappedResult(directory, &overlapped, &bytes, FALSE);
+        }
+
+        std::lock_guard lock(_mutex);
+        if (!ok) {
+            // Pasta removida ou handle invlido: no h como continuar observando
+            SKSE::log::warn("[DirectoryWatcher] Observao de '{}' interrompida (erro {}).", _root.string(),
+                            GetLastError());
+            _overflowed = true;
+            _hasChanges.store(true, std::memory_order_release);
+            break;
+        }
+        if (bytes == 0) {
+            // O buffer do sistema estourou e os eventos foram descartados
+            _overflowed = true;
+            _hasChanges.store(true, std::memory_order_release);
+            continue;
+        }
+
+        const std::byte* cursor = buffer;
+        while (true) {
+            const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+            if (info->Action != FILE_ACTION_MODIFIED) {
+                std::wstring relative(info->FileName, info->FileNameLength / sizeof(WCHAR));
+                _changes.push_back(_root / relative);
+            }
+            if (info->NextEntryOffset == 0) break;
+            cursor += info->NextEntryOffset;
+        }
+        if (!_changes.empty()) _hasChanges.store(true, std::memory_order_release);
+    }
+    CloseHandle(overlapped.hEvent);
+}
+
+void SetDirectoryWatcherFactory(DirectoryWatcherFactory factory) {
+    std::lock_guard lock(g_factoryMutex);
+    g_factory = std::move(factory);
+}
+
+std::unique_ptr<IDirectoryWatcher> CreateDirectoryWatcher() {
+    std::lock_guard lock(g_factoryMutex);
+    if (g_factory) return g_factory();
+    return std::make_unique<Win32DirectoryWatcher>();
+}
@@ -5,7 +5,9 @@
 #include "Utils.h"
 #include <fstream>
 #include <filesystem> 
+#include "JsonReader.h"
 #include "MCP.h"
+#include "StateStore.h"
 
 constexpr const char* settings_path = "Data/SKSE/Plugins/CycleMovesets/CycleMoveset_Settings.json";
 
@@ -209,6 +211,9 @@ namespace MyMenu {
         doc.AddMember("ShowMenu", Settings::ShowMenu, allocator);
         doc.AddMember("OnlyCombat", Settings::OnlyCombat, allocator);
         doc.AddMember("BfcoDPA", Settings::bfcoDirectionalAttacks, allocator);
+        doc.AddMember("ExportPerFolderJson", Settings::exportPerFolderJson, allocator);
+        doc.AddMember("CompactOarConfigs", Settings::compactOarConfigs, allocator);
+        doc.AddMember("NativeSlotConditions", Settings::nativeSlotConditions, allocator);
 
         // Cria o array de dispositivos
         rapidjson::Value devicesArray(rapidjson::kArrayType);
@@ -241,6 +246,14 @@ namespace MyMenu {
 
         doc.AddMember("Devices", devicesArray, allocator);
 
+        auto& store = StateStore::Get();
+        store.Put("settings", StateStore::Encode(doc));
+        store.Save();
+        if (!Settings::exportPerFolderJson) {
+            SKSE::log::info("Configuraes salvas no UserState.bin");
+            return;
+        }
+
         // Converte o JSON para uma string e salva no arquivo
         rapidjson::StringBuffer buffer;
         rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
@@ -263,18 +276,16 @@ namespace MyMenu {
     void LoadSettings() {
         SKSE::log::info("Carregando configuraes...");
 
-        std::ifstream file(settings_path);
-        if (!file.is_open()) {
+        JsonReader reader;
+        if (auto stored = StateStore::Get().Find("settings")) {
+            reader.AssignEncoded(*stored);
+        } else if (!reader.Load(settings_path)) {
             SKSE::log::info("Arquivo de configuraes no encontrado. Usando valores padro e salvando um novo.");
             SaveSettings();  // Salva um arquivo com os valores padro na primeira vez
             return;
         }
 
-        std::string json_data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-        file.close();
-
-        rapidjson::Document doc;
-        doc.Parse(json_data.c_str());
+        const rapidjson::Document& doc = reader.ParseInsitu();
 
         if (doc.HasParseError() || !doc.IsObject()) {
             SKSE::log::error("Falha ao analisar o arquivo de configuraes. Usando valores padro.");
@@ -316,6 +327,15 @@ namespace MyMenu {
         if (doc.HasMember("BfcoDPA") && doc["BfcoDPA"].IsBool()) {
             Settings::bfcoDirectionalAttacks = doc["BfcoDPA"].GetBool();
         }
+        if (doc.HasMember("ExportPerFolderJson") && doc["ExportPerFolderJson"].IsBool()) {
+            Settings::exportPerFolderJson = doc["ExportPerFolderJson"].GetBool();
+        }
+        if (doc.HasMember("CompactOarConfigs") && doc["CompactOarConfigs"].IsBool()) {
+            Settings::compactOarConfigs = doc["CompactOarConfigs"].GetBool();
+        }
+        if (doc.HasMember("NativeSlotConditions") && doc["NativeSlotConditions"].IsBool()) {
+            Settings::nativeSlotConditions = doc["NativeSlotConditions"].GetBool();
+        }
 
         // Carrega as configuraes dos dispositivos
         if (doc.HasMember("Devices") && doc["Devices"].IsArray()) {
@@ -0,0 +1,119 @@
+#include "HkxImportQueue.h"
+#include "HkxStore.h"
+
+#include <system_error>
+#include <thread>
+#include <utility>
+
+void HkxImportQueue::Batch::Wait() {
+    std::unique_lock lock(_mutex);
+    _doneCv.wait(lock, [this] { return _pending == 0; });
+}
+
+void HkxImportQueue::Batch::Finish(bool ok, bool linked, std::uint64_t bytes) {
+    if (ok) {
+        _succeeded.fetch_add(1, std::memory_order_relaxed);
+        _bytes.fetch_add(bytes, std::memory_order_relaxed);
+        if (linked) _hardLinked.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        _failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::lock_guard lock(_mutex);
+    if (--_pending == 0) _doneCv.notify_all();
+}
+
+HkxImportQueue& HkxImportQueue::Get() {
+    static HkxImportQueue queue;
+    return queue;
+}
+
+void HkxImportQueue::Enqueue(Batch& batch, std::filesystem::path sourceFile, std::filesystem::path destinationFile) {
+    {
+        std::lock_guard lock(batch._mutex);
+        ++batch._pending;
+    }
+
+    std::unique_lock lock(_mutex);
+    _notFullCv.wait(lock, [this] { return _jobs.size() < kCapacity; });
+    if (_queued.load(std::memory_order_relaxed) == 0) {
+        _firstEnqueue = std::chrono::steady_clock::now();
+    }
+    _jobs.push_back({&batch, std::move(sourceFile), std::move(destinationFile)});
+    _queued.fetch_add(1, std::memory_order_relaxed);
+
+    if (_workers < kMaxWorkers && _workers < _jobs.size()) {
+        ++_workers;
+        std::thread([this] { WorkerLoop(); }).detach();
+    }
+}
+
+HkxImportQueue::Progress HkxImportQueue::GetProgress() const {
+    Progress progress;
+    progress.queued = _queued.load(std::memory_order_relaxed);
+    progress.done = _done.load(std::memory_order_relaxed);
+    progress.bytes = _bytes.load(std::memory_order_relaxed);
+    if (progress.queued > 0) {
+        std::lock_guard lock(_mutex);
+        progress.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _firstEnqueue).count();
+    }
+    return progress;
+}
+
+bool HkxImportQueue::IsBusy() const {
+    return _done.load(std::memory_order_relaxed) < _queued.load(std::memory_order_relaxed);
+}
+
+void HkxImportQueue::WorkerLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::lock_guard lock(_mutex);
+            if (_jobs.empty()) {
+                --_workers;
+                return;
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        _notFullCv.notify_one();
+
+        bool linked = false;
+        std::uint64_t bytes = 0;
+        const bool ok = LinkOrCopy(job.source, job.destination, linked, bytes);
+        _bytes.fetch_add(bytes, std::memory_order_relaxed);
+        _done.fetch_add(1, std::memory_order_relaxed);
+        job.batch->Finish(ok, linked, bytes);
+    }
+}
+
+bool HkxImportQueue::LinkOrCopy(const std::filesystem::path& source, const std::filesystem::path& destination,
+                                bool& linked, std::uint64_t& bytes) {
+    std::error_code ec;
+    // Origem e destino so o mesmo arquivo (mesmo caminho ou hardlink): o remove abaixo apagaria a nica cpia
+    if (std::filesystem::equivalent(source, destination, ec)) {
+        SKSE::log::info("Importao ignorada, origem e destino so o mesmo arquivo: {}", destination.string());
+        bytes = 0;
+        return true;
+    }
+
+    const auto size = std::filesystem::file_size(source, ec);
+    bytes = ec ? 0 : size;
+
+    // Remove o destino antes: se ele for um hardlink de uma importao anterior, sobrescrever
+    // o contedo alteraria tambm o arquivo original do DAR.
+    std::filesystem::remove(destination, ec);
+
+    // Sem o armazm, copia: um hardlink direto da origem mudaria junto com o arquivo do DAR
+    if (HkxStore::Get().Link(source, destination)) {
+        linked = true;
+        return true;
+    }
+
+    std::filesystem::copy_file(source, destination, std::filesystem::copy_options::overwrite_existing, ec);
+    if (ec) {
+        SKSE::log::error("Falha ao copiar arquivo: {}. Erro: {}", source.string(), ec.message());
+        bytes = 0;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,154 @@
+#include "HkxStore.h"
+
+#include <format>
+#include <fstream>
+#include <memory>
+#include <system_error>
+#include <thread>
+
+namespace {
+    constexpr const char* hkx_store_path = "Data/SKSE/Plugins/CycleMovesets/HkxStore";
+
+    double ToMegabytes(std::uint64_t bytes) { return bytes / (1024.0 * 1024.0); }
+}
+
+HkxStore& HkxStore::Get() {
+    static HkxStore store;
+    return store;
+}
+
+HkxStore::HkxStore() : _root(hkx_store_path) {
+    // Verses antigas criavam o blob como hardlink do .hkx de origem. Esses blobs no so
+    // confiveis (mudam junto com a origem) e saem do armazm; os destinos j importados
+    // continuam com o contedo deles.
+    std::error_code ec;
+    const auto versionPath = _root / "version";
+    std::uint32_t version = 0;
+    if (std::ifstream in{versionPath}; in) in >> version;
+    if (version == kLayoutVersion) return;
+    if (std::filesystem::is_directory(_root, ec)) {
+        for (const auto& entry : std::filesystem::directory_iterator(_root, ec)) {
+            std::filesystem::remove_all(entry.path(), ec);
+        }
+        SKSE::log::info("[HkxStore] Armazm de uma verso antiga descartado.");
+    }
+    std::filesystem::create_directories(_root, ec);
+    std::ofstream(versionPath) << kLayoutVersion;
+}
+
+bool HkxStore::HashFile(const std::filesystem::path& file, std::uint64_t& hash, std::uint64_t& size) {
+    std::ifstream stream(file, std::ios::binary);
+    if (!stream) return false;
+
+    constexpr std::size_t kChunk = 64 * 1024;
+    const auto buffer = std::make_unique<char[]>(kChunk);
+    hash = 0xcbf29ce484222325ull;
+    size = 0;
+    while (stream) {
+        stream.read(buffer.get(), kChunk);
+        const auto read = static_cast<std::size_t>(stream.gcount());
+        for (std::size_t i = 0; i < read; ++i) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 0x100000001b3ull;
+        }
+        size += read;
+    }
+    return !stream.bad();
+}
+
+std::filesystem::path HkxStore::BlobPathFor(std::uint64_t hash, std::uint64_t size) const {
+    // O tamanho no nome separa contedos diferentes que colidam no hash de 64 bits
+    return _root / std::format("{:02x}", hash >> 56) / std::format("{:016x}-{:x}.hkx", hash, size);
+}
+
+bool HkxStore::CreateBlob(const std::filesystem::path& source, const std::filesystem::path& blob, std::uint64_t hash,
+                          std::uint64_t size) {
+    // O blob  uma cpia prpria: um hardlink da origem mudaria junto se o mod reescrevesse o
+    // arquivo no lugar, e a chave <hash>-<tamanho> passaria a apontar para outro contedo.
+    std::error_code ec;
+    std::filesystem::create_directories(blob.parent_path(), ec);
+    auto temp = blob;
+    temp += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    std::filesystem::copy_file(source, temp, std::filesystem::copy_options::overwrite_existing, ec);
+    if (ec) return std::filesystem::exists(blob);
+
+    // A origem pode ter mudado depois do hash: s publica se a cpia bate com a chave
+    std::uint64_t copiedHash = 0;
+    std::uint64_t copiedSize = 0;
+    if (!HashFile(temp, copiedHash, copiedSize) || copiedHash != hash || copiedSize != size) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    // Outra thread pode publicar o mesmo blob ao mesmo tempo; o contedo  idntico
+    std::filesystem::rename(temp, blob, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return std::filesystem::exists(blob);
+    }
+    return true;
+}
+
+bool HkxStore::Link(const std::filesystem::path& source, const std::filesystem::path& destination) {
+    if (!_usable.load(std::memory_order_relaxed)) return false;
+
+    std::uint64_t hash = 0;
+    std::uint64_t size = 0;
+    if (!HashFile(source, hash, size)) return false;
+
+    const auto blob = BlobPathFor(hash, size);
+    std::error_code ec;
+    if (!std::filesystem::exists(blob, ec) && !CreateBlob(source, blob, hash, size)) return false;
+
+    std::filesystem::create_hard_link(blob, destination, ec);
+    if (ec) {
+        if (!_linkedAny.load(std::memory_order_relaxed) && _usable.exchange(false)) {
+            SKSE::log::warn("[HkxStore] Hardlinks indisponveis em '{}' ({}). Usando cpias normais.",
+                            destination.parent_path().string(), ec.message());
+        }
+        return false;
+    }
+    _linkedAny.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+HkxStore::Report HkxStore::CollectGarbage() {
+    Report report;
+    std::error_code ec;
+    if (!std::filesystem::is_directory(_root, ec)) return report;
+
+    for (std::filesystem::recursive_directory_iterator it(_root, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+        if (it->path().extension() == ".tmp") {
+            // Cpia de um CreateBlob interrompido
+            std::error_code removeEc;
+            std::filesystem::remove(it->path(), removeEc);
+            continue;
+        }
+        if (it->path().extension() != ".hkx") continue;
+        const auto links = std::filesystem::hard_link_count(it->path(), ec);
+        const auto size = std::filesystem::file_size(it->path(), ec);
+        if (ec) {
+            ec.clear();
+            continue;
+        }
+        if (links <= 1) {
+            std::error_code removeEc;
+            if (std::filesystem::remove(it->path(), removeEc)) {
+                ++report.collected;
+                report.collectedBytes += size;
+            }
+            continue;
+        }
+        ++report.blobs;
+        report.links += links - 1;
+        report.storedBytes += size;
+        // Sem o armazm, cada destino seria uma cpia; com ele, s o blob ocupa espao
+        if (links > 2) report.savedBytes += (links - 2) * size;
+    }
+
+    SKSE::log::info("[HkxStore] {} blobs ({:.1f} MB) com {} links; {:.1f} MB economizados. "
+                    "{} blobs rfos removidos ({:.1f} MB).",
+                    report.blobs, ToMegabytes(report.storedBytes), report.links, ToMegabytes(report.savedBytes),
+                    report.collected, ToMegabytes(report.collectedBytes));
+    return report;
+}
@@ -1,7 +1,12 @@
 ﻿#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <future>
 #include <format>
 #include <fstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include "Events.h"
 #include "SKSEMCP/SKSEMenuFramework.hpp"
 #include "rapidjson/document.h"
@@ -13,49 +18,70 @@
 #include "Serialization.h"
 #include "ClibUtil/editorID.hpp"
 #include "Hooks.h"
-
-    // Função auxiliar para copiar um único arquivo com logs
-    void CopySingleFile(const std::filesystem::path& sourceFile, const std::filesystem::path& destinationPath,
-                        int& filesCopied) {
-        try {
-            std::filesystem::copy_file(sourceFile, destinationPath / sourceFile.filename(),
-                                       std::filesystem::copy_options::overwrite_existing);
-            filesCopied++;
-        } catch (const std::filesystem::filesystem_error& e) {
-            SKSE::log::error("Falha ao copiar arquivo: {}. Erro: {}", sourceFile.string(), e.what());
-        }
-    }
-
-    void ProcessCycleDarFile(const std::filesystem::path& cycleDarJsonPath) {
+#include "ConditionOptimizer.h"
+#include "CycleConditions.h"
+#include "FileClassifier.h"
+#include "HkxImportQueue.h"
+#include "HkxStore.h"
+#include "JsonReader.h"
+#include "LibraryWalker.h"
+#include "ManagedManifest.h"
+#include "OarConfigWriter.h"
+#include "ScanIndex.h"
+#include "StateStore.h"
+#include "ThreadPool.h"
+
+constexpr const char* managed_manifest_path = "Data/SKSE/Plugins/CycleMovesets/ManagedFiles.bin";
+constexpr const char* scan_index_path = "Data/SKSE/Plugins/CycleMovesets/ScanIndex.bin";
+constexpr const char* oar_root_path = "Data\\meshes\\actors\\character\\animations\\OpenAnimationReplacer";
+constexpr const char* dar_root_path =
+    "Data\\meshes\\actors\\character\\animations\\DynamicAnimationReplacer\\_CustomConditions";
+
+    bool ProcessCycleDarFile(const std::filesystem::path& cycleDarJsonPath) {
         SKSE::log::info("Processando CycleDar.json em: {}", cycleDarJsonPath.string());
 
         // 1. Abre e lê o arquivo JSON
-        std::ifstream fileStream(cycleDarJsonPath);
-        if (!fileStream) {
+        JsonReader reader;
+        if (!reader.Load(cycleDarJsonPath)) {
             SKSE::log::error("Falha ao abrir {}", cycleDarJsonPath.string());
-            return;
+            return false;
         }
-        std::string jsonContent((std::istreambuf_iterator<char>(fileStream)), std::istreambuf_iterator<char>());
-        fileStream.close();
 
         // 2. Faz o parse do JSON
-        rapidjson::Document doc;
-        doc.Parse(jsonContent.c_str());
+        rapidjson::Document& doc = reader.ParseInsitu();
 
         if (doc.HasParseError()) {
             SKSE::log::error("Erro no parse do JSON em {}", cycleDarJsonPath.string());
-            return;
+            return false;
         }
 
         // 3. Verifica se a conversão já foi feita
         if (doc.HasMember("conversionDone") && doc["conversionDone"].IsBool() && doc["conversionDone"].GetBool()) {
             SKSE::log::info("A cópia para {} já foi concluída anteriormente. Pulando.", cycleDarJsonPath.string());
-            return;
+            return false;
         }
 
-        int filesCopied = 0;
         std::filesystem::path destinationPath = cycleDarJsonPath.parent_path();
 
+        bool shouldConvertToBFCO = false;
+        if (doc.HasMember("convertBFCO") && doc["convertBFCO"].IsBool()) {
+            shouldConvertToBFCO = doc["convertBFCO"].GetBool();
+        }
+
+        // As cópias vão para a fila em segundo plano enquanto as origens ainda são listadas.
+        // A conversão MCO -> BFCO acontece no próprio nome de destino.
+        auto& importQueue = HkxImportQueue::Get();
+        HkxImportQueue::Batch batch;
+        const auto copyStart = std::chrono::steady_clock::now();
+        auto enqueueCopy = [&](const std::filesystem::path& sourceFile) {
+            auto filename = sourceFile.filename().wstring();
+            if (shouldConvertToBFCO &&
+                (FileClassifier::Classify(std::wstring_view(filename)) & FileClassifier::kMcoPrefix)) {
+                filename.replace(0, 4, L"BFCO_");
+            }
+            importQueue.Enqueue(batch, sourceFile, destinationPath / filename);
+        };
+
         // NOVA LÓGICA DE PROCESSAMENTO DE FONTES MÚLTIPLAS
         auto processSource = [&](const std::string& relativePath, const rapidjson::Value* filesToCopyArray) {
             std::filesystem::path sourcePath = "Data" / std::filesystem::path(relativePath);
@@ -73,7 +99,7 @@
                     if (fileValue.IsString()) {
                         std::filesystem::path sourceFile = sourcePath / fileValue.GetString();
                         if (std::filesystem::exists(sourceFile)) {
-                            CopySingleFile(sourceFile, destinationPath, filesCopied);
+                            enqueueCopy(sourceFile);
                         } else {
                             SKSE::log::warn("Arquivo especificado não encontrado na origem: {}", sourceFile.string());
                         }
@@ -82,16 +108,18 @@
             } else {
                 // Modo: Copia todos os .hkx (comportamento padrão)
                 SKSE::log::info("Modo: Copiando todos os arquivos .hkx da pasta.");
-                for (const auto& fileEntry : std::filesystem::directory_iterator(sourcePath)) {
-                    if (fileEntry.is_regular_file()) {
-                        std::string extension = fileEntry.path().extension().string();
-                        std::transform(extension.begin(), extension.end(), extension.begin(),
-                                       [](unsigned char c) { return std::tolower(c); });
-                        if (extension == ".hkx") {
-                            CopySingleFile(fileEntry.path(), destinationPath, filesCopied);
+                std::error_code ec;
+                for (std::filesystem::directory_iterator it(sourcePath, ec), end; !ec && it != end; it.increment(ec)) {
+                    if (it->is_regular_file(ec)) {
+                        if (FileClassifier::Classify(it->path().filename().native()) & FileClassifier::kHkx) {
+                            enqueueCopy(it->path());
                         }
                     }
                 }
+                if (ec) {
+                    // Não pode lançar aqui: o batch ainda tem cópias pendentes apontando para ele
+                    SKSE::log::error("Falha ao listar {}: {}", sourcePath.string(), ec.message());
+                }
             }
         };
 
@@ -110,43 +138,18 @@
             processSource(doc["pathDar"].GetString(), filesArray);
         } else {
             SKSE::log::error("Formato de CycleDar.json inválido ou não reconhecido em {}", cycleDarJsonPath.string());
-            return;
+            batch.Wait();
+            return false;
         }
 
-        SKSE::log::info("Cópia concluída. {} arquivos movidos.", filesCopied);
-
-        // Lógica de conversão para BFCO (inalterada)
-        bool shouldConvertToBFCO = false;
-        if (doc.HasMember("convertBFCO") && doc["convertBFCO"].IsBool()) {
-            shouldConvertToBFCO = doc["convertBFCO"].GetBool();
-        }
-
-        if (shouldConvertToBFCO && filesCopied > 0) {
-            SKSE::log::info("Iniciando conversão de MCO para BFCO...");
-            int filesRenamed = 0;
-            for (const auto& fileEntry : std::filesystem::directory_iterator(destinationPath)) {
-                if (fileEntry.is_regular_file()) {
-                    std::string filename = fileEntry.path().filename().string();
-                    std::string lower_filename = filename;
-                    // 2. Converte a cópia para minúsculas.
-                    std::transform(lower_filename.begin(), lower_filename.end(), lower_filename.begin(),
-                                   [](unsigned char c) { return std::tolower(c); });
-                    if (lower_filename.rfind("mco_", 0) == 0) {
-                        std::string newFilename = filename;
-                        newFilename.replace(0, 4, "BFCO_");
-                        std::filesystem::path newFilePath = destinationPath / newFilename;
-                        try {
-                            std::filesystem::rename(fileEntry.path(), newFilePath);
-                            filesRenamed++;
-                        } catch (const std::filesystem::filesystem_error& e) {
-                            SKSE::log::error("Falha ao renomear {} para {}. Erro: {}", fileEntry.path().string(),
-                                             newFilePath.string(), e.what());
-                        }
-                    }
-                }
-            }
-            SKSE::log::info("Conversão BFCO concluída. {} arquivos renomeados.", filesRenamed);
-        }
+        batch.Wait();
+        const int filesCopied = static_cast<int>(batch.Succeeded());
+        const auto copyMs =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - copyStart).count();
+        const double copiedMb = batch.Bytes() / (1024.0 * 1024.0);
+        SKSE::log::info("Cópia concluída. {} arquivos ({} hardlinks, {} falhas), {:.1f} MB em {} ms ({:.1f} MB/s).",
+                        filesCopied, batch.HardLinked(), batch.Failed(), copiedMb, copyMs,
+                        copyMs > 0 ? copiedMb * 1000.0 / copyMs : 0.0);
 
         // Lógica de atualização do JSON (inalterada)
         if (doc.HasMember("conversionDone")) {
@@ -162,95 +165,180 @@
         std::ofstream outFile(cycleDarJsonPath);
         if (!outFile) {
             SKSE::log::error("Falha ao abrir {} para escrita!", cycleDarJsonPath.string());
-            return;
+            return filesCopied > 0;
         }
 
         outFile << buffer.GetString();
         outFile.close();
 
         SKSE::log::info("Arquivo JSON {} atualizado com sucesso.", cycleDarJsonPath.string());
+        return filesCopied > 0;
     }
 
-    // --- DESAFIO 1: Nova função para escanear a pasta do sub-moveset em busca de tags ---
-    void ScanSubAnimationFolderForTags(const std::filesystem::path& subAnimPath,
-                                                         SubAnimationDef& subAnimDef) {
-        if (!std::filesystem::exists(subAnimPath) || !std::filesystem::is_directory(subAnimPath)) {
-            return;
-        }
-
-        // --- PONTO 2: Processar CycleDar.json ANTES de escanear as tags ---
-        // Procura pelo arquivo CycleDar.json e copia os arquivos .hkx se ele existir.
-        // Isso garante que os arquivos copiados estarão presentes para o escaneamento de tags abaixo.
-        std::filesystem::path cycleDarPath = subAnimPath / "CycleDar.json";
-        if (std::filesystem::exists(cycleDarPath) && std::filesystem::is_regular_file(cycleDarPath)) {
-            ProcessCycleDarFile(cycleDarPath);  // Chama a nova função helper
-        }
-
+    // Compara a memória dos registros da biblioteca com a que ocupariam guardando std::string e
+    // std::filesystem::path próprios em cada SubAnimationDef (como era antes do StringPool).
+    static void LogLibraryMemoryReport(const std::vector<AnimationModDef>& mods,
+                                       const std::vector<SubAnimationDef>& darSubMovesets) {
+        constexpr size_t kStringSso = 15;
+        constexpr size_t kPathSso = 16 / sizeof(std::filesystem::path::value_type) - 1;
+        size_t records = 0;
+        size_t legacyBytes = 0;
+        auto addRecord = [&](const SubAnimationDef& def) {
+            ++records;
+            const size_t nameChars = def.name.view().size();
+            const size_t pathChars = def.path.utf8().size();
+            legacyBytes += sizeof(std::string) + (nameChars > kStringSso ? nameChars + 1 : 0);
+            legacyBytes += sizeof(std::filesystem::path) +
+                           (pathChars > kPathSso ? (pathChars + 1) * sizeof(std::filesystem::path::value_type) : 0);
+        };
+        for (const auto& mod : mods) {
+            for (const auto& def : mod.subAnimations) addRecord(def);
+        }
+        for (const auto& def : darSubMovesets) addRecord(def);
+
+        const auto stats = StringPool::Get().GetStats();
+        const size_t pooledBytes = records * 2 * sizeof(StringPool::Id) + stats.arenaBytes + stats.indexBytes;
+        SKSE::log::info(
+            "[StringPool] {} registros: ~{} KB com strings próprias, ~{} KB internados ({} strings únicas, "
+            "arena {} KB, índice {} KB).",
+            records, legacyBytes / 1024, pooledBytes / 1024, stats.strings, stats.arenaBytes / 1024,
+            stats.indexBytes / 1024);
+    }
 
-        subAnimDef.attackCount = 0;
-        subAnimDef.powerAttackCount = 0;
-        subAnimDef.hasIdle = false;
-        subAnimDef.hasAnimations = false;
-        subAnimDef.dpaTags = {};
-        subAnimDef.hasCPA = false;  // Valor inicial
-        int hkxFileCount = 0;
-        
+    std::shared_future<void> AnimationManager::StartLibraryScan() {
+        _libraryReady.store(false, std::memory_order_release);
+        _libraryScan = std::async(std::launch::async, [this] {
+                           try {
+                               ScanAnimationMods();
+                               StartLibraryWatchers();
+                           } catch (const std::exception& e) {
+                               SKSE::log::critical("Erro durante o escaneamento da biblioteca: {}", e.what());
+                           }
+                           _libraryReady.store(true, std::memory_order_release);
+                       }).share();
+        return _libraryScan;
+    }
 
-       // Itera sobre todos os arquivos na pasta para encontrar tags de animação
-        for (const auto& fileEntry : std::filesystem::directory_iterator(subAnimPath)) {
-            if (fileEntry.is_regular_file()) {
-                std::string extension = fileEntry.path().extension().string();
-                std::string filename = fileEntry.path().filename().string();
-                std::string lowerFilename = filename;
-                std::transform(lowerFilename.begin(), lowerFilename.end(), lowerFilename.begin(), ::tolower);
-                std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    void AnimationManager::WaitForLibraryScan() {
+        if (!_libraryScan.valid() || IsLibraryReady()) return;
+        const auto waitStart = std::chrono::steady_clock::now();
+        _libraryScan.wait();
+        SKSE::log::info("Aguardou {} ms pelo escaneamento da biblioteca.",
+                        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - waitStart)
+                            .count());
+    }
 
-                if (extension == ".hkx") {
-                    hkxFileCount++;
+    void AnimationManager::ImportCycleDarFolders() {
+        const auto importStart = std::chrono::steady_clock::now();
+        _scanIndex = std::make_shared<ScanIndex>();
+        _scanIndex->Load(scan_index_path);
+        auto& index = *_scanIndex;
+        const auto oarRootPath = std::filesystem::path(oar_root_path).lexically_normal();
+        const auto darRootPath = std::filesystem::path(dar_root_path).lexically_normal();
+
+        // Profundidade da pasta abaixo da raiz (1 = filha direta), ou -1 se estiver fora dela
+        auto depthUnder = [](const std::filesystem::path& root, const std::filesystem::path& folder) {
+            const auto relative = folder.lexically_relative(root);
+            if (relative.empty() || *relative.begin() == "..") return -1;
+            return static_cast<int>(std::distance(relative.begin(), relative.end()));
+        };
 
-                    // Lógica de contagem de ataques
-                    if (lowerFilename.rfind("bfco_attack", 0) == 0) {
-                        subAnimDef.attackCount++;
-                    }
-                    if (lowerFilename.rfind("bfco_powerattack", 0) == 0) {
-                        subAnimDef.powerAttackCount++;
-                    }
-                    if (lowerFilename.find("idle") != std::string::npos) {
-                        subAnimDef.hasIdle = true;
-                    }
+        // Pastas que o índice já conhece com CycleDar.json, com as mesmas regras do LibraryWalker
+        // (sub-movesets do OAR e pastas de primeiro nível do DAR). O json pula se já foi convertido.
+        std::vector<std::filesystem::path> knownCycleDar;
+        for (auto& folder : index.LoadedFoldersWith(FolderFlags::kCycleDar | FolderFlags::kConfig)) {
+            if (depthUnder(oarRootPath, folder) >= 2) knownCycleDar.push_back(std::move(folder));
+        }
+        for (auto& folder : index.LoadedFoldersWith(FolderFlags::kCycleDar)) {
+            if (depthUnder(darRootPath, folder) == 1) knownCycleDar.push_back(std::move(folder));
+        }
 
-                    // Lógica de verificação de DPA e CPA
-                    if (lowerFilename == "bfco_powerattacka.hkx")
-                        subAnimDef.dpaTags.hasA = true;
-                    else if (lowerFilename == "bfco_powerattackb.hkx")
-                        subAnimDef.dpaTags.hasB = true;
-                    else if (lowerFilename == "bfco_powerattackl.hkx")
-                        subAnimDef.dpaTags.hasL = true;
-                    else if (lowerFilename == "bfco_powerattackr.hkx")
-                        subAnimDef.dpaTags.hasR = true;
-                    else if (lowerFilename == "bfco_powerattackcomb.hkx")
-                        subAnimDef.hasCPA = true;
+        // Pastas de topo que o índice nunca viu (mods novos; tudo, na primeira execução) são percorridas
+        struct NewFolder {
+            WalkRoot kind;
+            std::filesystem::path path;
+            int depth;
+        };
+        std::vector<NewFolder> newFolders;
+        auto collectNew = [&](const std::filesystem::path& root, WalkRoot kind, int depth) {
+            std::error_code ec;
+            for (std::filesystem::directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+                if (it->is_directory(ec) && !index.HasLoadedFolder(it->path())) {
+                    newFolders.push_back({kind, it->path(), depth});
                 }
             }
-        }
+        };
+        collectNew(oarRootPath, WalkRoot::OAR, 0);
+        collectNew(darRootPath, WalkRoot::DAR, 1);
+
+        WorkStealingPool pool;
+        pool.ParallelFor(knownCycleDar.size(),
+                         [&](size_t i) { ProcessCycleDarFile(knownCycleDar[i] / "CycleDar.json"); });
+        pool.ParallelFor(newFolders.size(), [&](size_t i) {
+            const auto& folder = newFolders[i];
+            LibraryWalker(folder.kind, &index, &pool, false, true).Walk(folder.path, folder.depth);
+        });
+        // As pastas novas já listadas aqui não são listadas de novo pelo scan
+        index.AdoptCurrent();
+
+        const auto importProgress = HkxImportQueue::Get().GetProgress();
+        SKSE::log::info("[CycleDar] Import concluído em {} ms: {} CycleDar.json conhecidos, {} pastas novas, {} hkx "
+                        "importados.",
+                        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                              importStart)
+                            .count(),
+                        knownCycleDar.size(), newFolders.size(), importProgress.done);
+    }
 
-        if (hkxFileCount > 0) {
-            subAnimDef.hasAnimations = true;
+    void AnimationManager::DrawLibraryScanProgress() {
+        const size_t total = _scanModsTotal.load(std::memory_order_relaxed);
+        const size_t done = _scanModsDone.load(std::memory_order_relaxed);
+        ImGui::Text("Scanning animation library... %s", _scanPhase.load(std::memory_order_relaxed));
+        if (total > 0) {
+            ImGui::Text("%zu / %zu mods (%d%%)", done, total, static_cast<int>(done * 100 / total));
+        }
+        const auto& importQueue = HkxImportQueue::Get();
+        if (importQueue.IsBusy()) {
+            const auto progress = importQueue.GetProgress();
+            ImGui::Text("CycleDar: %zu / %zu hkx (%.1f MB/s)", progress.done, progress.queued,
+                        progress.MegabytesPerSecond());
         }
-
-
-         logger::info("Scan da pasta '{}': hasDPA (A:{}, B:{}, L:{}, R:{}), hasCPA:{}", subAnimDef.name,
-                        subAnimDef.dpaTags.hasA, subAnimDef.dpaTags.hasB, subAnimDef.dpaTags.hasL,
-                        subAnimDef.dpaTags.hasR, subAnimDef.hasCPA);
     }
 
     // --- Lógica de Escaneamento (Carrega a Biblioteca) ---
+    // Roda na thread do StartLibraryScan: só os consumidores que aguardam IsLibraryReady podem ler o estado.
     void AnimationManager::ScanAnimationMods() {
         SKSE::log::info("Iniciando escaneamento da biblioteca de animações...");
+        FsCounters::Reset();
+        const auto scanStart = std::chrono::steady_clock::now();
+        auto phaseStart = scanStart;
+        auto phaseCounters = FsCounters::Take();
+        // Tempo e chamadas ao sistema de arquivos de cada fase, para o resumo no fim do scan.
+        struct PhaseSample {
+            const char* name;
+            long long ms;
+            FsCounters::Snapshot fs;
+        };
+        std::vector<PhaseSample> phaseSamples;
+        // Loga o tempo de cada fase e avança o texto mostrado na barra de progresso do menu.
+        auto enterPhase = [&](const char* finishedPhase, const char* nextPhase) {
+            const auto now = std::chrono::steady_clock::now();
+            const auto counters = FsCounters::Take();
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - phaseStart).count();
+            SKSE::log::info("[Scan] Fase '{}': {} ms", finishedPhase, ms);
+            phaseSamples.push_back({finishedPhase, ms, counters - phaseCounters});
+            phaseStart = now;
+            phaseCounters = counters;
+            _scanPhase.store(nextPhase, std::memory_order_relaxed);
+        };
+        _scanModsDone.store(0, std::memory_order_relaxed);
+        _scanModsTotal.store(0, std::memory_order_relaxed);
+        _scanPhase.store("Categories", std::memory_order_relaxed);
         _categories.clear();
         _allMods.clear();
+        _library.Clear();
 
-        const std::filesystem::path oarRootPath = "Data\\meshes\\actors\\character\\animations\\OpenAnimationReplacer";
+        const std::filesystem::path oarRootPath = oar_root_path;
         // ESTRUTURA MELHORADA: Facilita a definição de categorias e suas propriedades
         struct CategoryDefinition {
             std::string name;
@@ -309,8 +397,23 @@
         }
         LoadCustomCategories();
         LoadStanceNames();
-
-        ScanDarAnimations();
+        enterPhase("Categories", "DAR");
+
+        // Pastas cujo carimbo não mudou desde a última sessão vêm direto do índice em disco.
+        // Normalmente o ImportCycleDarFolders já carregou e completou o índice.
+        const std::filesystem::path scanIndexPath = scan_index_path;
+        // O índice fica vivo depois do scan para os rescans incrementais (RescanMod/RescanSubmoveset).
+        if (!_scanIndex) {
+            _scanIndex = std::make_shared<ScanIndex>();
+            _scanIndex->Load(scanIndexPath);
+        }
+        auto& scanIndex = *_scanIndex;
+        // Com manifesto, os config.json gerenciados vêm dele; sem manifesto (primeira execução),
+        // o walk procura o marcador em cada config.json e o manifesto é criado a partir disso.
+        const bool hasManifest = _managedManifest.Load(managed_manifest_path);
+        WorkStealingPool pool;
+
+        ScanDarAnimations(&pool, &scanIndex, false);
         if (!_darSubMovesets.empty()) {
             AnimationModDef darModDef;
             darModDef.name = "[DAR] Animations";
@@ -320,85 +423,520 @@
             SKSE::log::info("Integrou {} animações DAR como um mod virtual.", _darSubMovesets.size());
         }
 
+        enterPhase("DAR", "OAR");
+
+        _oarRuleFiles.clear();
+        _managedFiles.clear();
+        if (!std::filesystem::exists(oarRootPath)) {
+            scanIndex.Save(scanIndexPath);
+            return;
+        }
 
-        if (!std::filesystem::exists(oarRootPath)) return;
+        // Cada mod de topo vira uma tarefa independente no pool. Os resultados ficam em slots
+        // indexados pela ordem de enumeração, então o merge em _allMods é determinístico.
+        std::vector<std::filesystem::path> topLevelMods;
+        FsCounters::listings.fetch_add(1, std::memory_order_relaxed);
         for (const auto& entry : std::filesystem::directory_iterator(oarRootPath)) {
             if (entry.is_directory()) {
-                ProcessTopLevelMod(entry.path());
+                topLevelMods.push_back(entry.path());
             }
         }
-        SKSE::log::info("Escaneamento de arquivos finalizado. {} mods carregados.", _allMods.size());
 
-        // Agora que temos todos os mods, vamos encontrar quais arquivos já gerenciamos.
-        SKSE::log::info("Verificando arquivos previamente gerenciados...");
-        _managedFiles.clear();
-        for (const auto& mod : _allMods) {
-            for (const auto& subAnim : mod.subAnimations) {
-                if (std::filesystem::exists(subAnim.path)) {
-                    std::ifstream fileStream(subAnim.path);
-                    std::string content((std::istreambuf_iterator<char>(fileStream)), std::istreambuf_iterator<char>());
-                    fileStream.close();
-                    if (content.find("OAR_CYCLE_MANAGER_CONDITIONS") != std::string::npos) {
-                        _managedFiles.insert(subAnim.path);
+        std::vector<TopLevelModScan> scannedMods(topLevelMods.size());
+        _scanModsTotal.store(topLevelMods.size(), std::memory_order_relaxed);
+        pool.ParallelFor(topLevelMods.size(), [&](size_t i) {
+            scannedMods[i] = ProcessTopLevelMod(topLevelMods[i], &pool, &scanIndex, !hasManifest, false);
+            _scanModsDone.fetch_add(1, std::memory_order_relaxed);
+        });
+        scanIndex.Save(scanIndexPath);
+        SKSE::log::info("[ScanIndex] {} pastas reaproveitadas do índice, {} listadas de novo.", scanIndex.GetHits(),
+                        scanIndex.GetMisses());
+
+        // O walk de cada mod já trouxe os (User_)CycleMoveset.json, então o LoadCycleMovesets
+        // não precisa percorrer a árvore de novo.
+        for (auto& scanned : scannedMods) {
+            if (scanned.mod) {
+                _allMods.push_back(std::move(*scanned.mod));
+            }
+            _managedFiles.insert(scanned.managedConfigs.begin(), scanned.managedConfigs.end());
+            std::move(scanned.ruleFiles.begin(), scanned.ruleFiles.end(), std::back_inserter(_oarRuleFiles));
+        }
+
+        enterPhase("OAR", "Managed files");
+        if (hasManifest) {
+            const auto managedKeys = _managedManifest.CollectManaged(&pool);
+            for (const auto& mod : _allMods) {
+                for (const auto& subAnim : mod.subAnimations) {
+                    auto configPath = subAnim.path.get();
+                    if (managedKeys.contains(ManagedManifest::KeyOf(configPath))) {
+                        _managedFiles.insert(std::move(configPath));
                     }
                 }
             }
+        } else {
+            for (const auto& managedPath : _managedFiles) {
+                _managedManifest.Record(managedPath);
+            }
         }
+        _managedManifest.Save(managed_manifest_path);
+        enterPhase("Managed files", "Movesets");
+        const auto scanMs =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - scanStart).count();
+        SKSE::log::info("Escaneamento de arquivos finalizado. {} mods carregados em {} ms ({} workers + thread principal).",
+                        _allMods.size(), scanMs, pool.GetThreadCount());
         SKSE::log::info("Encontrados {} arquivos gerenciados.", _managedFiles.size());
+        FsCounters::Log("Scan da biblioteca");
+
+        // A biblioteca (e os índices por nome) precisa estar pronta para resolver os movesets do usuário
+        _library.Sync(_allMods);
 
         // --- NOVA SEÇÃO: Carregar e integrar movesets do usuário ---
         //LoadUserMovesets();
-
-        for (const auto& userMoveset : _userMovesets) {
-            AnimationModDef modDef;
-            modDef.name = userMoveset.name;
-            modDef.author = "Usuário";  // Autor padrão
-
-            for (const auto& subInstance : userMoveset.subAnimations) {
-                // Verifica se os índices são válidos para evitar crashes
-                if (subInstance.sourceModIndex < _allMods.size()) {
-                    const auto& sourceMod = _allMods[subInstance.sourceModIndex];
-                    if (subInstance.sourceSubAnimIndex < sourceMod.subAnimations.size()) {
-                        // Adiciona a definição da sub-animação original ao nosso novo mod virtual
-                        modDef.subAnimations.push_back(sourceMod.subAnimations[subInstance.sourceSubAnimIndex]);
-                    }
-                }
-            }
-            _allMods.push_back(modDef);
-        }
+        _userModSlots.clear();
+        _freeUserModSlots.clear();
+        RebuildUserMovesetLibrary();
         SKSE::log::info("Integração finalizada. Total de {} mods na biblioteca (incluindo de usuário).", _allMods.size());
-        // -- -NOVA CHAMADA-- -
+        LogLibraryMemoryReport(_allMods, _darSubMovesets);
+        // Os CycleDar foram importados antes do scan (ImportCycleDarFolders): dá para recolher blobs sem uso
+        HkxStore::Get().CollectGarbage();
         // Agora que a biblioteca de mods (_allMods) está completa, carregamos a configuração da UI.
         _npcCategories = _categories;
         LoadCycleMovesets();
+        enterPhase("Movesets", "Done");
         
         SKSE::log::info("Categorias de armas para NPCs inicializadas.");
+
+        // Uma linha só com todas as fases: é o número para comparar entre versões e entre máquinas.
+        std::string summary;
+        for (const auto& sample : phaseSamples) {
+            summary += std::format("{}{}={}ms [{}L {}E {}S {}R]", summary.empty() ? "" : " | ", sample.name, sample.ms,
+                                   sample.fs.listings, sample.fs.entries, sample.fs.stats, sample.fs.fileReads);
+        }
+        const auto importProgress = HkxImportQueue::Get().GetProgress();
+        SKSE::log::info("[Scan] Resumo: {} | Total={}ms | {} mods, {} sub-movesets, {} hkx importados",
+                        summary,
+                        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - scanStart)
+                            .count(),
+                        _allMods.size(), _library.Size(), importProgress.done);
+        SKSE::log::info("[Scan] Legenda: L = pastas listadas, E = entradas, S = stats, R = arquivos lidos.");
     }
 
-    void AnimationManager::ProcessTopLevelMod(const std::filesystem::path& modPath) {
-        std::filesystem::path configPath = modPath / "config.json";
-        if (!std::filesystem::exists(configPath)) return;
-        std::ifstream fileStream(configPath);
-        std::string jsonContent((std::istreambuf_iterator<char>(fileStream)), std::istreambuf_iterator<char>());
-        fileStream.close();
-        rapidjson::Document doc;
-        doc.Parse(jsonContent.c_str());
-        if (doc.IsObject() && doc.HasMember("name") && doc.HasMember("author")) {
-            AnimationModDef modDef;
+    // Roda em uma thread do pool: não pode tocar no estado do AnimationManager.
+    TopLevelModScan AnimationManager::ProcessTopLevelMod(const std::filesystem::path& modPath, WorkStealingPool* pool,
+                                                         ScanIndex* index, bool readManagedMarker,
+                                                         bool importCycleDar) {
+        TopLevelModScan result;
+
+        // Um único walk traz tudo: sub-movesets (pastas com config.json), tags dos .hkx,
+        // arquivos de regra e, se pedido, o marcador de arquivo gerenciado.
+        LibraryWalker walker(WalkRoot::OAR, index, pool, readManagedMarker, importCycleDar);
+        const auto folders = walker.Walk(modPath);
+        for (const auto& folder : folders) {
+            if (!folder.ruleFile.empty()) {
+                result.ruleFiles.push_back(folder.ruleFile);
+            }
+        }
+
+        if (folders.empty() || !folders.front().Has(FolderFlags::kConfig)) return result;
+
+        AnimationModDef modDef;
+        const std::filesystem::path configPath = modPath / "config.json";
+        modDef.path = modPath;
+        if (!index || !index->TryGetModHeader(configPath, modDef.name, modDef.author)) {
+            FsCounters::fileReads.fetch_add(1, std::memory_order_relaxed);
+            // Roda nas threads do scan: um leitor (e arena) por thread
+            thread_local JsonReader reader;
+            if (!reader.Load(configPath)) {
+                SKSE::log::warn("Falha ao ler {}. Mod ignorado.", configPath.string());
+                return result;
+            }
+            const rapidjson::Document& doc = reader.ParseInsitu();
+            if (!doc.IsObject() || !doc.HasMember("name") || !doc.HasMember("author")) return result;
             modDef.name = doc["name"].GetString();
             modDef.author = doc["author"].GetString();
-            for (const auto& subEntry : std::filesystem::recursive_directory_iterator(modPath)) {
-                if (subEntry.is_directory() && std::filesystem::exists(subEntry.path() / "config.json")) {
-                    if (std::filesystem::equivalent(modPath, subEntry.path())) continue;
-                    SubAnimationDef subAnimDef;
-                    subAnimDef.name = subEntry.path().filename().string();
-                    subAnimDef.path = subEntry.path() / "config.json";
-                    ScanSubAnimationFolderForTags(subEntry.path(), subAnimDef);
-                    modDef.subAnimations.push_back(subAnimDef);
+            if (index) index->PutModHeader(configPath, modDef.name, modDef.author);
+        }
+
+        for (const auto& folder : folders) {
+            if (folder.depth == 0 || !folder.Has(FolderFlags::kConfig)) continue;
+            SubAnimationDef subAnimDef;
+            subAnimDef.name = folder.path.filename().string();
+            subAnimDef.path = folder.path / "config.json";
+            folder.tags.ApplyTo(subAnimDef);
+            if (folder.hasManagedMarker) {
+                result.managedConfigs.push_back(subAnimDef.path.get());
+            }
+            modDef.subAnimations.push_back(std::move(subAnimDef));
+        }
+        result.mod = std::move(modDef);
+        return result;
+    }
+
+    // Caminho 'key' (ManagedManifest::KeyOf) igual a 'scopeKey' ou dentro dele.
+    static bool IsUnderKey(const std::string& key, const std::string& scopeKey) {
+        if (!key.starts_with(scopeKey)) return false;
+        return key.size() == scopeKey.size() || key[scopeKey.size()] == '\\' || key[scopeKey.size()] == '/';
+    }
+
+    // Pasta de primeiro nível de 'root' que contém 'path' (ex.: o mod de um arquivo alterado).
+    static std::optional<std::filesystem::path> TopLevelFolderOf(const std::filesystem::path& root,
+                                                                 const std::filesystem::path& path) {
+        const auto relative = path.lexically_normal().lexically_relative(root.lexically_normal());
+        if (relative.empty() || *relative.begin() == ".." || *relative.begin() == ".") return std::nullopt;
+        return root / *relative.begin();
+    }
+
+    struct RescanStats {
+        size_t added = 0;
+        size_t updated = 0;
+        size_t missing = 0;
+    };
+
+    // Aplica o resultado de um rescan sem mudar a posição do que já existia: entradas reencontradas
+    // são substituídas no lugar, as que estão dentro de 'scope' e sumiram ficam com isMissing e as
+    // novas vão para o fim. Assim os índices guardados em SubAnimationInstance continuam válidos.
+    static RescanStats MergeRescannedSubAnimations(std::vector<SubAnimationDef>& existing,
+                                                   std::vector<SubAnimationDef>&& fresh,
+                                                   const std::filesystem::path& scope) {
+        RescanStats stats;
+        std::unordered_map<std::string, size_t> freshByKey;
+        for (size_t i = 0; i < fresh.size(); ++i) {
+            freshByKey.emplace(ManagedManifest::KeyOf(fresh[i].path.get()), i);
+        }
+        std::vector<bool> consumed(fresh.size(), false);
+        const auto scopeKey = ManagedManifest::KeyOf(scope);
+
+        for (auto& def : existing) {
+            const auto key = ManagedManifest::KeyOf(def.path.get());
+            if (auto it = freshByKey.find(key); it != freshByKey.end()) {
+                def = std::move(fresh[it->second]);
+                consumed[it->second] = true;
+                ++stats.updated;
+            } else if (!def.isMissing && IsUnderKey(key, scopeKey)) {
+                def.isMissing = true;
+                ++stats.missing;
+            }
+        }
+        for (size_t i = 0; i < fresh.size(); ++i) {
+            if (consumed[i]) continue;
+            existing.push_back(std::move(fresh[i]));
+            ++stats.added;
+        }
+        return stats;
+    }
+
+    // Os sourceDef do criador apontam para dentro dos vetores da biblioteca, que podem realocar
+    // num rescan: guarda os caminhos antes e reaponta depois.
+    std::vector<std::filesystem::path> AnimationManager::SnapshotCreatorSources() const {
+        std::vector<std::filesystem::path> sources;
+        for (const auto& [categoryName, stances] : _movesetCreatorStances) {
+            for (const auto& stance : stances) {
+                for (const auto& instance : stance.subMovesets) {
+                    sources.push_back(instance.sourceDef ? instance.sourceDef->path.get() : std::filesystem::path{});
+                }
+            }
+        }
+        return sources;
+    }
+
+    void AnimationManager::RebindCreatorSources(const std::vector<std::filesystem::path>& sources) {
+        std::unordered_map<std::string, const SubAnimationDef*> byKey;
+        for (const auto& def : _darSubMovesets) {
+            byKey.emplace(ManagedManifest::KeyOf(def.path.get()), &def);
+        }
+        for (const auto& mod : _allMods) {
+            for (const auto& def : mod.subAnimations) {
+                byKey.emplace(ManagedManifest::KeyOf(def.path.get()), &def);
+            }
+        }
+
+        size_t next = 0;
+        for (auto& [categoryName, stances] : _movesetCreatorStances) {
+            for (auto& stance : stances) {
+                for (auto& instance : stance.subMovesets) {
+                    const auto& source = sources[next++];
+                    if (source.empty()) continue;
+                    auto it = byKey.find(ManagedManifest::KeyOf(source));
+                    instance.sourceDef = it != byKey.end() ? it->second : nullptr;
+                }
+            }
+        }
+    }
+
+    bool AnimationManager::RescanMod(const std::filesystem::path& modPath) {
+        if (!IsLibraryReady()) return false;
+        const auto creatorSources = SnapshotCreatorSources();
+
+        TopLevelModScan scan;
+        if (std::filesystem::is_directory(modPath)) {
+            scan = ProcessTopLevelMod(modPath, nullptr, _scanIndex.get(), false, true);
+        }
+
+        const auto modKey = ManagedManifest::KeyOf(modPath);
+        auto modIt = std::find_if(_allMods.begin(), _allMods.end(), [&](const AnimationModDef& mod) {
+            return !mod.path.empty() && ManagedManifest::KeyOf(mod.path) == modKey;
+        });
+
+        RescanStats stats;
+        const bool known = modIt != _allMods.end();
+        const size_t modIdx = known ? static_cast<size_t>(modIt - _allMods.begin()) : _allMods.size();
+        if (known) {
+            // Nome e autor ficam como estão: os CycleMoveset.json já salvos referenciam o mod por nome.
+            stats = MergeRescannedSubAnimations(modIt->subAnimations,
+                                                scan.mod ? std::move(scan.mod->subAnimations)
+                                                         : std::vector<SubAnimationDef>{},
+                                                modPath);
+        } else if (scan.mod) {
+            stats.added = scan.mod->subAnimations.size();
+            _allMods.push_back(std::move(*scan.mod));
+        }
+
+        std::erase_if(_oarRuleFiles,
+                      [&](const std::filesystem::path& p) { return IsUnderKey(ManagedManifest::KeyOf(p), modKey); });
+        std::move(scan.ruleFiles.begin(), scan.ruleFiles.end(), std::back_inserter(_oarRuleFiles));
+
+        RebindCreatorSources(creatorSources);
+        if (modIdx < _allMods.size()) {
+            _library.SyncMod(modIdx, _allMods[modIdx]);
+        }
+        SKSE::log::info("[Rescan] Mod '{}': {} novos, {} atualizados, {} removidos.", modPath.string(), stats.added,
+                        stats.updated, stats.missing);
+        return known || stats.added > 0;
+    }
+
+    bool AnimationManager::RescanSubmoveset(const std::filesystem::path& folder) {
+        if (!IsLibraryReady()) return false;
+        const auto key = ManagedManifest::KeyOf(folder);
+        if (IsUnderKey(key, ManagedManifest::KeyOf(dar_root_path))) {
+            return RescanDarFolder(folder);
+        }
+
+        const auto topLevel = TopLevelFolderOf(oar_root_path, folder);
+        if (!topLevel) {
+            SKSE::log::warn("[Rescan] '{}' não está dentro das pastas do OAR ou do DAR.", folder.string());
+            return false;
+        }
+        const auto topKey = ManagedManifest::KeyOf(*topLevel);
+        if (key != topKey) {
+            for (size_t modIdx = 0; modIdx < _allMods.size(); ++modIdx) {
+                const auto& mod = _allMods[modIdx];
+                if (!mod.path.empty() && ManagedManifest::KeyOf(mod.path) == topKey) {
+                    return RescanOarSubmoveset(modIdx, folder);
+                }
+            }
+        }
+        // A própria pasta de topo ou um mod que ainda não está na biblioteca
+        return RescanMod(*topLevel);
+    }
+
+    bool AnimationManager::RescanOarSubmoveset(size_t modIdx, const std::filesystem::path& folder) {
+        const auto creatorSources = SnapshotCreatorSources();
+        auto& mod = _allMods[modIdx];
+
+        std::vector<SubAnimationDef> fresh;
+        std::vector<std::filesystem::path> ruleFiles;
+        if (std::filesystem::is_directory(folder)) {
+            // Mesma profundidade que a pasta teria no walk do mod inteiro (regras do CycleDar dependem disso)
+            const auto relative = folder.lexically_normal().lexically_relative(mod.path.lexically_normal());
+            const int depth = static_cast<int>(std::distance(relative.begin(), relative.end()));
+            LibraryWalker walker(WalkRoot::OAR, _scanIndex.get(), nullptr, false, true);
+            for (const auto& walked : walker.Walk(folder, depth)) {
+                if (!walked.ruleFile.empty()) {
+                    ruleFiles.push_back(walked.ruleFile);
+                }
+                if (!walked.Has(FolderFlags::kConfig)) continue;
+                SubAnimationDef subAnimDef;
+                subAnimDef.name = walked.path.filename().string();
+                subAnimDef.path = walked.path / "config.json";
+                walked.tags.ApplyTo(subAnimDef);
+                fresh.push_back(std::move(subAnimDef));
+            }
+        }
+
+        const auto stats = MergeRescannedSubAnimations(mod.subAnimations, std::move(fresh), folder);
+        const auto folderKey = ManagedManifest::KeyOf(folder);
+        std::erase_if(_oarRuleFiles,
+                      [&](const std::filesystem::path& p) { return IsUnderKey(ManagedManifest::KeyOf(p), folderKey); });
+        std::move(ruleFiles.begin(), ruleFiles.end(), std::back_inserter(_oarRuleFiles));
+
+        RebindCreatorSources(creatorSources);
+        _library.SyncMod(modIdx, mod);
+        SKSE::log::info("[Rescan] Sub-moveset '{}' de '{}': {} novos, {} atualizados, {} removidos.", folder.string(),
+                        mod.name, stats.added, stats.updated, stats.missing);
+        return true;
+    }
+
+    bool AnimationManager::RescanDarFolder(const std::filesystem::path& folder) {
+        const auto creatorSources = SnapshotCreatorSources();
+
+        std::vector<SubAnimationDef> fresh;
+        std::vector<std::filesystem::path> ruleFiles;
+        if (std::filesystem::is_directory(folder)) {
+            LibraryWalker walker(WalkRoot::DAR, _scanIndex.get(), nullptr, false, true);
+            for (const auto& walked : walker.Walk(folder, 1)) {
+                if (!walked.ruleFile.empty()) {
+                    ruleFiles.push_back(walked.ruleFile);
+                }
+                if (walked.depth != 1) continue;
+                SubAnimationDef subAnimDef;
+                auto u8_filename = walked.path.filename().u8string();
+                subAnimDef.name = std::string(u8_filename.begin(), u8_filename.end());
+                subAnimDef.path = walked.path;
+                walked.tags.ApplyTo(subAnimDef);
+                if (subAnimDef.hasAnimations) {
+                    fresh.push_back(std::move(subAnimDef));
+                }
+            }
+        }
+
+        // _darSubMovesets e o mod virtual "[DAR] Animations" andam juntos (mesma ordem e índices)
+        auto darMod = std::find_if(_allMods.begin(), _allMods.end(),
+                                   [](const AnimationModDef& mod) { return mod.name == "[DAR] Animations"; });
+        if (darMod == _allMods.end() && !fresh.empty()) {
+            AnimationModDef darModDef;
+            darModDef.name = "[DAR] Animations";
+            darModDef.author = "Dynamic Animation Replacer";
+            darModDef.subAnimations = _darSubMovesets;
+            _allMods.push_back(std::move(darModDef));
+            darMod = std::prev(_allMods.end());
+        }
+        if (darMod != _allMods.end()) {
+            auto freshCopy = fresh;
+            MergeRescannedSubAnimations(darMod->subAnimations, std::move(freshCopy), folder);
+        }
+        const auto stats = MergeRescannedSubAnimations(_darSubMovesets, std::move(fresh), folder);
+
+        const auto folderKey = ManagedManifest::KeyOf(folder);
+        std::erase_if(_darRuleFiles,
+                      [&](const std::filesystem::path& p) { return IsUnderKey(ManagedManifest::KeyOf(p), folderKey); });
+        std::move(ruleFiles.begin(), ruleFiles.end(), std::back_inserter(_darRuleFiles));
+
+        RebindCreatorSources(creatorSources);
+        if (darMod != _allMods.end()) {
+            _library.SyncMod(static_cast<size_t>(darMod - _allMods.begin()), *darMod);
+        }
+        SKSE::log::info("[Rescan] DAR '{}': {} novos, {} atualizados, {} removidos.", folder.string(), stats.added,
+                        stats.updated, stats.missing);
+        return true;
+    }
+
+    // Rescan de todas as pastas DAR, no lugar (usado sem watcher ou quando ele perdeu eventos).
+    void AnimationManager::RescanDarLibrary() {
+        if (!IsLibraryReady()) return;
+        const std::filesystem::path darRootPath = dar_root_path;
+        std::vector<std::filesystem::path> folders;
+        if (std::filesystem::is_directory(darRootPath)) {
+            for (const auto& entry : std::filesystem::directory_iterator(darRootPath)) {
+                if (entry.is_directory()) {
+                    folders.push_back(entry.path());
+                }
+            }
+        }
+        // Pastas que sumiram do disco também passam pelo rescan, para ficarem marcadas com isMissing
+        for (const auto& def : _darSubMovesets) {
+            if (def.isMissing) continue;
+            auto folder = def.path.get();
+            if (!std::filesystem::exists(folder)) {
+                folders.push_back(std::move(folder));
+            }
+        }
+        for (const auto& folder : folders) {
+            RescanDarFolder(folder);
+        }
+        RebuildUserMovesetLibrary();
+
+        const auto available = std::count_if(_darSubMovesets.begin(), _darSubMovesets.end(),
+                                             [](const SubAnimationDef& def) { return !def.isMissing; });
+        RE::DebugNotification(std::format("{} Animações DAR carregadas.", available).c_str());
+    }
+
+    void AnimationManager::StartLibraryWatchers() {
+        _oarWatcher = CreateDirectoryWatcher();
+        if (!_oarWatcher->Start(oar_root_path)) _oarWatcher.reset();
+        _darWatcher = CreateDirectoryWatcher();
+        if (!_darWatcher->Start(dar_root_path)) _darWatcher.reset();
+    }
+
+    bool AnimationManager::HasPendingLibraryChanges() const {
+        return (_oarWatcher && _oarWatcher->HasChanges()) || (_darWatcher && _darWatcher->HasChanges());
+    }
+
+    void AnimationManager::ApplyLibraryChanges() {
+        if (!IsLibraryReady()) return;
+        const std::filesystem::path oarRootPath = oar_root_path;
+        const std::filesystem::path darRootPath = dar_root_path;
+
+        if (_oarWatcher && _oarWatcher->HasChanges()) {
+            std::vector<std::filesystem::path> changed;
+            std::set<std::filesystem::path> modsToRescan;
+            std::set<std::filesystem::path> subMovesetsToRescan;
+            if (!_oarWatcher->Drain(changed)) {
+                // Eventos perdidos: cada mod de topo passa pelo rescan (no lugar), inclusive os que sumiram
+                SKSE::log::warn("[Rescan] Watcher do OAR perdeu eventos. Reescaneando todos os mods.");
+                if (std::filesystem::is_directory(oarRootPath)) {
+                    for (const auto& entry : std::filesystem::directory_iterator(oarRootPath)) {
+                        if (entry.is_directory()) modsToRescan.insert(entry.path());
+                    }
+                }
+                for (const auto& mod : _allMods) {
+                    if (!mod.path.empty()) modsToRescan.insert(mod.path);
+                }
+            } else {
+                std::unordered_set<std::string> knownFolders;
+                for (const auto& mod : _allMods) {
+                    if (mod.path.empty()) continue;
+                    for (const auto& subAnim : mod.subAnimations) {
+                        knownFolders.insert(ManagedManifest::KeyOf(subAnim.path.get().parent_path()));
+                    }
                 }
+                // Cada mudança vai para o sub-moveset conhecido mais próximo; sem um, o mod inteiro
+                for (const auto& path : changed) {
+                    const auto topLevel = TopLevelFolderOf(oarRootPath, path);
+                    if (!topLevel) continue;
+                    const auto topKey = ManagedManifest::KeyOf(*topLevel);
+                    bool found = false;
+                    for (auto current = path; current.has_relative_path(); current = current.parent_path()) {
+                        const auto currentKey = ManagedManifest::KeyOf(current);
+                        if (currentKey == topKey || !IsUnderKey(currentKey, topKey)) break;
+                        if (knownFolders.contains(currentKey)) {
+                            subMovesetsToRescan.insert(current);
+                            found = true;
+                            break;
+                        }
+                    }
+                    if (!found) modsToRescan.insert(*topLevel);
+                }
+            }
+
+            for (const auto& modPath : modsToRescan) {
+                RescanMod(modPath);
+            }
+            for (const auto& folder : subMovesetsToRescan) {
+                const auto topLevel = TopLevelFolderOf(oarRootPath, folder);
+                if (topLevel && modsToRescan.contains(*topLevel)) continue;
+                RescanSubmoveset(folder);
             }
-            _allMods.push_back(modDef);
         }
+
+        if (_darWatcher && _darWatcher->HasChanges()) {
+            std::vector<std::filesystem::path> changed;
+            if (!_darWatcher->Drain(changed)) {
+                SKSE::log::warn("[Rescan] Watcher do DAR perdeu eventos. Reescaneando todas as pastas DAR.");
+                RescanDarLibrary();
+            } else {
+                std::set<std::filesystem::path> folders;
+                for (const auto& path : changed) {
+                    if (auto topLevel = TopLevelFolderOf(darRootPath, path)) folders.insert(*topLevel);
+                }
+                for (const auto& folder : folders) {
+                    RescanDarFolder(folder);
+                }
+            }
+        }
+        // Movesets de usuário copiam os sub-movesets de origem: os que usam algo reescaneado são remontados
+        RebuildUserMovesetLibrary();
+        // Sub-movesets podem ter ganhado ou perdido animações: a playlist compilada é refeita
+        UpdateMaxMovesetCache();
     }
 
     // --- Lógica da Interface de Usuário ---
@@ -426,6 +964,7 @@
                 std::transform(filter_str.begin(), filter_str.end(), filter_str.begin(), ::tolower);
                 for (size_t modIdx = 0; modIdx < _allMods.size(); ++modIdx) {
                     const auto& modDef = _allMods[modIdx];
+                    if (modDef.name.empty()) continue;  // Slot livre de um moveset de usuário apagado
                     std::string mod_name_str = modDef.name;
                     std::transform(mod_name_str.begin(), mod_name_str.end(), mod_name_str.begin(), ::tolower);
                     if (filter_str.empty() || mod_name_str.find(filter_str) != std::string::npos) {
@@ -434,9 +973,11 @@
                             ModInstance newModInstance;
                             newModInstance.sourceModIndex = modIdx;
                             for (size_t subIdx = 0; subIdx < modDef.subAnimations.size(); ++subIdx) {
+                                if (modDef.subAnimations[subIdx].isMissing) continue;
                                 SubAnimationInstance newSubInstance;
                                 newSubInstance.sourceModIndex = modIdx;
                                 newSubInstance.sourceSubAnimIndex = subIdx;
+                                newSubInstance.subMovesetId = _library.IdOf(modIdx, subIdx);
                                 newModInstance.subAnimationInstances.push_back(newSubInstance);
                             }
                             _instanceToAddTo->modInstances.push_back(newModInstance);
@@ -468,6 +1009,7 @@
 
                 for (size_t modIdx = 0; modIdx < _allMods.size(); ++modIdx) {
                     const auto& modDef = _allMods[modIdx];
+                    if (modDef.name.empty()) continue;  // Slot livre de um moveset de usuário apagado
                     std::string mod_name_str = modDef.name;
                     std::transform(mod_name_str.begin(), mod_name_str.end(), mod_name_str.begin(), ::tolower);
                     if (filter_str.empty() || mod_name_str.find(filter_str) != std::string::npos) {
@@ -476,6 +1018,7 @@
                             // Loop interno pelos submovesets (filhos)
                             for (size_t subAnimIdx = 0; subAnimIdx < modDef.subAnimations.size(); ++subAnimIdx) {
                                 const auto& subAnimDef = modDef.subAnimations[subAnimIdx];
+                                if (subAnimDef.isMissing) continue;
 
                                 // NENHUM FILTRO AQUI DENTRO. Mostra todos os filhos.
 
@@ -489,10 +1032,11 @@
                                     SubAnimationInstance newSubInstance;
                                     newSubInstance.sourceModIndex = modIdx;
                                     newSubInstance.sourceSubAnimIndex = subAnimIdx;
+                                    newSubInstance.subMovesetId = _library.IdOf(modIdx, subAnimIdx);
                                     const auto& sourceMod = _allMods[modIdx];
                                     const auto& sourceSubAnim = sourceMod.subAnimations[subAnimIdx];
                                     newSubInstance.sourceModName = sourceMod.name;
-                                    newSubInstance.sourceSubName = sourceSubAnim.name;
+                                    newSubInstance.sourceSubName = sourceSubAnim.name.str();
                                     if (_modInstanceToAddTo) {
                                         _modInstanceToAddTo->subAnimationInstances.push_back(newSubInstance);
                                     } else if (_userMovesetToAddTo) {
@@ -532,6 +1076,13 @@
 
     // Esta é a nova função principal da UI que você registrará no SKSEMenuFramework
     void AnimationManager::DrawMainMenu() {
+        if (!IsLibraryReady()) {
+            DrawLibraryScanProgress();
+            return;
+        }
+        if (HasPendingLibraryChanges()) {
+            ApplyLibraryChanges();
+        }
         // Primeiro, desenhamos o sistema de abas
         if (ImGui::BeginTabBar("MainTabs")) {
             if (ImGui::BeginTabItem(LOC("tab_movesets"))) {
@@ -572,7 +1123,17 @@
         }
         ImGui::SameLine();
         if (ImGui::Button("Read DAR animations")) {
-            ScanDarAnimations();
+            // Com watcher, só o que mudou desde o scan é relido; sem ele, todas as pastas DAR (no lugar)
+            if (_darWatcher) {
+                if (_darWatcher->HasChanges()) {
+                    ApplyLibraryChanges();
+                    RE::DebugNotification("Animações DAR atualizadas.");
+                } else {
+                    RE::DebugNotification("Nenhuma mudança nas pastas DAR desde a última leitura.");
+                }
+            } else {
+                RescanDarLibrary();
+            }
         }
         ImGui::Separator();
 
@@ -742,6 +1303,10 @@
     }
 
     void AnimationManager::DrawNPCMenu() { 
+        if (!IsLibraryReady()) {
+            DrawLibraryScanProgress();
+            return;
+        }
         DrawNPCManager();
         DrawAddModModal();
         DrawRestartPopup();
@@ -750,17 +1315,13 @@
 
     int AnimationManager::GetMaxMovesetsFor(const std::string& category, int stanceIndex) { 
     
-        if (stanceIndex < 0 || stanceIndex >= 4) {
+        if (stanceIndex < 0 || stanceIndex >= 4 || !GetSingleton()->IsLibraryReady()) {
             return 0;
         }
-        // Procura a categoria no mapa
-        auto it = _maxMovesetsPerCategory.find(category);
-        if (it != _maxMovesetsPerCategory.end()) {
-            // Se encontrou, retorna o valor para a stance específica
-            return it->second[stanceIndex];
-        }
+        const auto table = GetSingleton()->_playlists.load();
+        const auto categoryId = table->CategoryIdOf(category);
         // Se não encontrou a categoria, não há movesets
-        return 0;
+        return categoryId ? table->CountOf(*categoryId, stanceIndex) : 0;
     }
 
 //int AnimationManager::GetMaxMovesetsForNPC(RE::Actor* actor, const std::string& category, int stanceIndex) {
@@ -1087,6 +1648,20 @@ void AnimationManager::DrawCategoryUI(WeaponCategory& category) {
         }
         ImGui::SameLine();
         ImGui::Checkbox(LOC("save_oldconditions"), &_preserveConditions);
+        ImGui::SameLine();
+        if (ImGui::Checkbox(LOC("save_compact"), &Settings::compactOarConfigs)) {
+            MyMenu::SaveSettings();
+        }
+        if (CycleConditions::IsRegistered()) {
+            ImGui::SameLine();
+            if (ImGui::Checkbox(LOC("save_native_conditions"), &Settings::nativeSlotConditions)) {
+                MyMenu::SaveSettings();
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Checkbox(LOC("save_export_json"), &Settings::exportPerFolderJson)) {
+            MyMenu::SaveSettings();
+        }
         ImGui::Separator();
 
         // DrawAddModModal();
@@ -1503,15 +2078,15 @@ void AnimationManager::DrawNPCCategoryUI(WeaponCategory& category) {
                         std::string label;
                         if (modInstance.isSelected && subInstance.isSelected) {
                             if (playlistNumbers.count(&subInstance)) {
-                                label = std::format("[{}] {}", playlistNumbers.at(&subInstance), originSubAnim.name);
+                                label = std::format("[{}] {}", playlistNumbers.at(&subInstance), originSubAnim.name.view());
                             } else if (parentNumbersForChildren.count(&subInstance)) {
                                 int parentNum = parentNumbersForChildren.at(&subInstance);
-                                label = std::format(" -> [{}] {}", parentNum, originSubAnim.name);
+                                label = std::format(" -> [{}] {}", parentNum, originSubAnim.name.view());
                             } else {
-                                label = originSubAnim.name;  // Fallback
+                                label = originSubAnim.name.str();  // Fallback
                             }
                         } else {
-                            label = originSubAnim.name;  // Mostra nome simples se desmarcado
+                            label = originSubAnim.name.str();  // Mostra nome simples se desmarcado
                         }
 
                         // PONTO-CHAVE: Criamos um Selectable com tamanho definido.
@@ -1582,6 +2157,7 @@ void AnimationManager::SaveAllSettings() {
         SaveCustomCategories();
         SaveStanceNames();
         SaveCycleMovesets();  // Esta já foi corrigida e está funcionando.
+        StateStore::Get().Save();
         SKSE::log::info("Gerando arquivos de condição para OAR...");
         std::map<std::filesystem::path, std::vector<FileSaveConfig>> fileUpdates;
 
@@ -1697,12 +2273,15 @@ void AnimationManager::SaveAllSettings() {
                                 // Para DAR, o 'path' da sub-animação é o diretório.
                                 // Criamos um caminho lógico para um config.json dentro dele
                                 // para que UpdateOrCreateJson possa encontrar o diretório pai corretamente.
-                                configPath = sourceSubAnim.path / "user.json";
+                                configPath = sourceSubAnim.path.get() / "user.json";
                             } else {
                                 // Para OAR, o path já é o arquivo config.json.
-                                configPath = sourceSubAnim.path;
+                                configPath = sourceSubAnim.path.get();
+                            }
+                            // Pasta removida depois do scan: mantém a contagem da playlist, mas não grava nada
+                            if (!(_library.CapsOf(LibraryIdOf(subInst)) & SubmovesetCaps::kMissing)) {
+                                fileUpdates[configPath].push_back(config);
                             }
-                            fileUpdates[configPath].push_back(config);
                         }
                     }
                 }
@@ -1731,41 +2310,78 @@ void AnimationManager::SaveAllSettings() {
 
         // 4. Escreve os arquivos config.json usando a lógica atualizada de UpdateOrCreateJson
         SKSE::log::info("{} arquivos de configuração OAR serão modificados.", fileUpdates.size());
+        const auto writeStart = std::chrono::steady_clock::now();
+        WorkStealingPool pool;
+        const auto failedFiles = WriteConfigFiles(fileUpdates, &pool);
+
+        // Atualiza o manifesto para a próxima inicialização não precisar reler esses arquivos.
+        // Os que falharam ficam de fora: o conteúdo no disco não é o que foi gerado.
+        std::vector<std::filesystem::path> writtenFiles;
+        writtenFiles.reserve(fileUpdates.size());
         for (const auto& updateEntry : fileUpdates) {
-            UpdateOrCreateJson(updateEntry.first, updateEntry.second);
+            if (!failedFiles.contains(updateEntry.first)) writtenFiles.push_back(updateEntry.first);
         }
+        _managedManifest.RecordAll(writtenFiles, &pool);
+        _managedManifest.Save(managed_manifest_path);
+        SKSE::log::info("{} config.json processados em {} ms ({} workers + thread principal).", fileUpdates.size(),
+                        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - writeStart)
+                            .count(),
+                        pool.GetThreadCount());
 
         SKSE::log::info("Salvamento global concluído.");
-        RE::DebugNotification("Todas as configurações foram salvas!");
+        if (failedFiles.empty()) {
+            RE::DebugNotification("Todas as configurações foram salvas!");
+        } else {
+            RE::DebugNotification(std::format("Falha ao gravar {} config.json (veja o log).", failedFiles.size()).c_str());
+        }
         UpdateMaxMovesetCache();
         _showRestartPopup = true;
 }
 
+    std::set<std::filesystem::path> AnimationManager::WriteConfigFiles(
+        const std::map<std::filesystem::path, std::vector<FileSaveConfig>>& fileUpdates, WorkStealingPool* pool) {
+        std::vector<const std::pair<const std::filesystem::path, std::vector<FileSaveConfig>>*> entries;
+        entries.reserve(fileUpdates.size());
+        for (const auto& updateEntry : fileUpdates) {
+            entries.push_back(&updateEntry);
+        }
+        BuildKeywordExclusions();
+        std::vector<JsonWriteResult> results(entries.size());
+        auto write = [&](size_t i) { results[i] = UpdateOrCreateJson(entries[i]->first, entries[i]->second); };
+        if (pool) {
+            pool->ParallelFor(entries.size(), write);
+        } else {
+            for (size_t i = 0; i < entries.size(); ++i) write(i);
+        }
 
-    void AnimationManager::UpdateOrCreateJson(const std::filesystem::path& jsonPath,
-                                              const std::vector<FileSaveConfig>& configs) {
-        rapidjson::Document doc;
-        std::ifstream fileStream(jsonPath);
-        if (fileStream) {
-            std::string jsonContent((std::istreambuf_iterator<char>(fileStream)), std::istreambuf_iterator<char>());
-            fileStream.close();
-            if (doc.Parse(jsonContent.c_str()).HasParseError()) {
-                SKSE::log::error("Erro de Parse ao ler {}. Criando um novo arquivo.", jsonPath.string());
-                doc.SetObject();
+        std::set<std::filesystem::path> failed;
+        size_t written = 0;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (results[i] == JsonWriteResult::Written) {
+                ++written;
+            } else if (results[i] == JsonWriteResult::Failed) {
+                failed.insert(entries[i]->first);
             }
-        } else {
-            doc.SetObject();
         }
+        SKSE::log::info("config.json: {} gravados, {} inalterados (escrita pulada).", written,
+                        entries.size() - written - failed.size());
+        if (!failed.empty()) {
+            SKSE::log::error("config.json: {} falharam na escrita.", failed.size());
+        }
+        return failed;
+    }
 
-        if (!doc.IsObject()) doc.SetObject();
-        auto& allocator = doc.GetAllocator();
+    JsonWriteResult AnimationManager::UpdateOrCreateJson(const std::filesystem::path& jsonPath,
+                                                         const std::vector<FileSaveConfig>& configs) {
+        // Chamado em paralelo pelo WriteConfigFiles: um leitor (e arena) por thread. O texto original
+        // não vira Document: o OarConfigWriter o copia por SAX e ele ainda é comparado com a saída.
+        // O arena do leitor fica só para o bloco gerenciado.
+        thread_local JsonReader reader;
+        const bool fileExisted = reader.Load(jsonPath);
+        const std::string& jsonContent = reader.Text();
+        auto& allocator = reader.Doc().GetAllocator();
 
         std::string movesetName = jsonPath.parent_path().filename().string();
-        if (doc.HasMember("name")) {
-            doc["name"].SetString(movesetName.c_str(), allocator);
-        } else {
-            doc.AddMember("name", rapidjson::Value(movesetName.c_str(), allocator), allocator);
-        }
 
         int basePriority = 2100000000;
         bool isUsedAsParent = false;
@@ -1777,38 +2393,9 @@ void AnimationManager::SaveAllSettings() {
         }
         int finalPriority = isUsedAsParent ? basePriority : basePriority + 1;
 
-        if (doc.HasMember("priority")) {
-            doc["priority"].SetInt(finalPriority);
-        } else {
-            doc.AddMember("priority", finalPriority, allocator);
-        }
-
-        rapidjson::Value oldConditions(rapidjson::kArrayType);
-        if (_preserveConditions && doc.HasMember("conditions") && doc["conditions"].IsArray()) {
-            for (auto& cond : doc["conditions"].GetArray()) {
-                if (cond.IsObject() && cond.HasMember("comment") && cond["comment"] == "OAR_CYCLE_MANAGER_CONDITIONS") {
-                    continue;
-                }
-                rapidjson::Value c;
-                c.CopyFrom(cond, allocator);
-                oldConditions.PushBack(c, allocator);
-            }
-        }
-
-        if (doc.HasMember("conditions")) {
-            doc["conditions"].SetArray();
-        } else {
-            doc.AddMember("conditions", rapidjson::Value(rapidjson::kArrayType), allocator);
-        }
-        rapidjson::Value& conditions = doc["conditions"];
-
-        if (_preserveConditions && !oldConditions.Empty()) {
-            rapidjson::Value oldConditionsBlock(rapidjson::kObjectType);
-            oldConditionsBlock.AddMember("condition", "OR", allocator);
-            oldConditionsBlock.AddMember("comment", "Old Conditions", allocator);
-            oldConditionsBlock.AddMember("Conditions", oldConditions, allocator);
-            conditions.PushBack(oldConditionsBlock, allocator);
-        }
+        // As condições antigas do usuário (com _preserveConditions) são copiadas pelo OarConfigWriter
+        rapidjson::Value masterOrBlock(rapidjson::kObjectType);
+        bool hasManagedBlock = false;
 
         /*std::map<int, std::set<int>> childDirectionsByPlaylist;
         for (const auto& config : configs) {
@@ -1828,10 +2415,10 @@ void AnimationManager::SaveAllSettings() {
         }*/
 
         if (!configs.empty()) {
-            rapidjson::Value masterOrBlock(rapidjson::kObjectType);
             masterOrBlock.AddMember("condition", "OR", allocator);
             masterOrBlock.AddMember("comment", "OAR_CYCLE_MANAGER_CONDITIONS", allocator);
             rapidjson::Value innerConditions(rapidjson::kArrayType);
+            const bool useNativeSlots = Settings::nativeSlotConditions && CycleConditions::IsRegistered();
 
             for (const auto& config : configs) {
                 rapidjson::Value categoryAndBlock(rapidjson::kObjectType);
@@ -1860,9 +2447,33 @@ void AnimationManager::SaveAllSettings() {
                         break;
                 }
 
+                // ADIÇÃO: Correção de segurança para a instância do jogador
+                int final_instance_index = config.instance_index;
+                // Se a configuração é para o jogador (!isNPC) e o índice for inválido (< 1), corrige para 1.
+                if (config.ruleType == RuleType::Player && final_instance_index < 1) {
+                    SKSE::log::warn(
+                        "Índice de instância inválido (0) encontrado para o Jogador em {}. Corrigindo para 1.",
+                        jsonPath.string());
+                    final_instance_index = 1;  // Garante que o valor mínimo para o jogador seja 1
+                    
+                }
+
+                if (config.ruleType != RuleType::Player) {
+                    final_instance_index = 0;
+                }
+
                 // NPC Type condition
                 int priorityValue = GetPriorityForType(config.ruleType);
-                AddCompareValuesCondition(andConditions, "CycleMovesetNpcType", priorityValue, allocator);
+                // Com a condição nativa, tipo de regra, stance, playlist e direções viram um único slot id
+                std::optional<std::uint32_t> slotId;
+                if (useNativeSlots) {
+                    slotId = MakeSlotKey(config, priorityValue, final_instance_index).Encode();
+                }
+                if (slotId) {
+                    AddCycleSlotCondition(andConditions, *slotId, allocator);
+                } else {
+                    AddCompareValuesCondition(andConditions, "CycleMovesetNpcType", priorityValue, allocator);
+                }
 
                 // Right-Hand Equipped Type condition
                 {
@@ -1911,19 +2522,14 @@ void AnimationManager::SaveAllSettings() {
                     // A verificação de keywords da mão esquerda já é feita acima.
                 }
 
-                // ADIÇÃO: Correção de segurança para a instância do jogador
-                int final_instance_index = config.instance_index;
-                // Se a configuração é para o jogador (!isNPC) e o índice for inválido (< 1), corrige para 1.
-                if (config.ruleType == RuleType::Player && final_instance_index < 1) {
-                    SKSE::log::warn(
-                        "Índice de instância inválido (0) encontrado para o Jogador em {}. Corrigindo para 1.",
-                        jsonPath.string());
-                    final_instance_index = 1;  // Garante que o valor mínimo para o jogador seja 1
-                    
-                }
-
-                if (config.ruleType != RuleType::Player) {
-                    final_instance_index = 0;
+                if (slotId) {
+                    // O Random tem estado e fica fora do slot, depois dele como antes ficava depois do testarone
+                    if (config.order_in_playlist > 0 && !config.isParent && config.pRandom) {
+                        AddRandomCondition(andConditions, config.order_in_playlist, allocator);
+                    }
+                    categoryAndBlock.AddMember("Conditions", andConditions, allocator);
+                    innerConditions.PushBack(categoryAndBlock, allocator);
+                    continue;
                 }
                 AddCompareValuesCondition(andConditions, "cycle_instance", final_instance_index, allocator);
                 // Stance and Playlist order
@@ -1989,11 +2595,12 @@ void AnimationManager::SaveAllSettings() {
                 innerConditions.PushBack(categoryAndBlock, allocator);
             }
             if (!innerConditions.Empty()) {
+                // Junta o começo repetido dos ANDs em grupos aninhados; depois, baratas e seletivas primeiro
+                ConditionOptimizer::Optimize(innerConditions, allocator);
                 masterOrBlock.AddMember("Conditions", innerConditions, allocator);
-                conditions.PushBack(masterOrBlock, allocator);
+                hasManagedBlock = true;
             }
         } else {  // "Kill switch" condition
-            rapidjson::Value masterOrBlock(rapidjson::kObjectType);
             masterOrBlock.AddMember("condition", "OR", allocator);
             masterOrBlock.AddMember("comment", "OAR_CYCLE_MANAGER_CONDITIONS", allocator);
             rapidjson::Value innerConditions(rapidjson::kArrayType);
@@ -2004,21 +2611,37 @@ void AnimationManager::SaveAllSettings() {
             andBlock.AddMember("Conditions", andConditions, allocator);
             innerConditions.PushBack(andBlock, allocator);
             masterOrBlock.AddMember("Conditions", innerConditions, allocator);
-            conditions.PushBack(masterOrBlock, allocator);
+            hasManagedBlock = true;
+        }
+
+        // Serializa em memória: se o resultado é idêntico ao arquivo atual (bloco gerenciado, nome,
+        // prioridade e condições preservadas), não há o que gravar e o OAR não precisa reler o arquivo.
+        rapidjson::StringBuffer buffer;
+        buffer.Reserve(jsonContent.size());
+        const OarConfigWriter::Options options{_preserveConditions, Settings::compactOarConfigs};
+        if (!OarConfigWriter::Write(jsonContent, movesetName, finalPriority, hasManagedBlock ? &masterOrBlock : nullptr,
+                                    options, buffer) &&
+            fileExisted) {
+            SKSE::log::error("Erro de Parse ao ler {}. Criando um novo arquivo.", jsonPath.string());
+        }
+        const std::string_view output(buffer.GetString(), buffer.GetSize());
+        if (fileExisted && output == jsonContent) {
+            return JsonWriteResult::Skipped;
         }
 
         // Save the document
-        FILE* fp;
+        FILE* fp = nullptr;
         fopen_s(&fp, jsonPath.string().c_str(), "wb");
         if (!fp) {
             SKSE::log::error("Falha ao abrir o arquivo para escrita: {}", jsonPath.string());
-            return;
+            return JsonWriteResult::Failed;
         }
-        char writeBuffer[65536];
-        rapidjson::FileWriteStream os(fp, writeBuffer, sizeof(writeBuffer));
-        rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer(os);
-        doc.Accept(writer);
-        fclose(fp);
+        const bool complete = fwrite(output.data(), 1, output.size(), fp) == output.size();
+        if (fclose(fp) != 0 || !complete) {
+            SKSE::log::error("Falha ao gravar o arquivo: {}", jsonPath.string());
+            return JsonWriteResult::Failed;
+        }
+        return JsonWriteResult::Written;
     }
 
 
@@ -2038,6 +2661,55 @@ void AnimationManager::SaveAllSettings() {
         conditionsArray.PushBack(newCompare, allocator);
     }
 
+    CycleConditions::SlotKey AnimationManager::MakeSlotKey(const FileSaveConfig& config, int npcType,
+                                                           int instanceIndex) {
+        CycleConditions::SlotKey key;
+        key.npcType = npcType;
+        key.instance = instanceIndex;
+        key.playlist = std::max(config.order_in_playlist, 0);
+        if (key.playlist == 0) return key;
+
+        auto addDirection = [&key](int dir) {
+            if (dir >= 1 && dir <= 8) key.directions |= static_cast<std::uint8_t>(1u << (dir - 1));
+        };
+        if (config.isParent) {
+            for (int dir : config.childDirections) {
+                // Direção fora de 1..8 não cabe na máscara: -1 força o Encode a recusar e o JSON completo é usado
+                if (dir < 1 || dir > 8) key.playlist = -1;
+                addDirection(dir);
+            }
+            key.excludeDirections = true;
+        } else {
+            if (config.pFront) addDirection(1);
+            if (config.pFrontRight) addDirection(2);
+            if (config.pRight) addDirection(3);
+            if (config.pBackRight) addDirection(4);
+            if (config.pBack) addDirection(5);
+            if (config.pBackLeft) addDirection(6);
+            if (config.pLeft) addDirection(7);
+            if (config.pFrontLeft) addDirection(8);
+        }
+        return key;
+    }
+
+    void AnimationManager::AddCycleSlotCondition(rapidjson::Value& conditionsArray, std::uint32_t slotId,
+                                                 rapidjson::Document::AllocatorType& allocator) {
+        rapidjson::Value newSlot(rapidjson::kObjectType);
+        newSlot.AddMember("condition",
+                          rapidjson::StringRef(CycleConditions::CycleMovesetActiveCondition::CONDITION_NAME.data()),
+                          allocator);
+        const auto pluginName = SKSE::PluginDeclaration::GetSingleton()->GetName();
+        newSlot.AddMember("requiredPlugin",
+                          rapidjson::Value(pluginName.data(), static_cast<rapidjson::SizeType>(pluginName.size()),
+                                           allocator),
+                          allocator);
+        newSlot.AddMember("requiredVersion", "1.0.0", allocator);
+        rapidjson::Value slot(rapidjson::kObjectType);
+        slot.AddMember("value", static_cast<double>(slotId), allocator);
+        newSlot.AddMember("Slot", slot, allocator);
+        conditionsArray.PushBack(newSlot, allocator);
+    }
+
     // NOVA FUNÇÃO HELPER: Adiciona uma condição "CompareValues" para um valor booleano.
     // Usada para verificar as checkboxes de movimento (F, B, L, R, etc.).
     void AnimationManager::AddCompareBoolCondition(rapidjson::Value& conditionsArray, const std::string& graphVarName,
@@ -2092,58 +2764,23 @@ void AnimationManager::SaveAllSettings() {
     // Toda a parte de user ta ca pra baixo
 
     std::optional<size_t> AnimationManager::FindModIndexByName(const std::string& name) {
-        for (size_t i = 0; i < _allMods.size(); ++i) {
-            if (_allMods[i].name == name) {
-                return i;
-            }
-        }
-        return std::nullopt;
+        return _library.FindMod(name);
     }
 
     std::optional<size_t> AnimationManager::FindSubAnimIndexByName(size_t modIdx, const std::string& name) {
         if (modIdx >= _allMods.size()) return std::nullopt;
-        const auto& modDef = _allMods[modIdx];
-        for (size_t i = 0; i < modDef.subAnimations.size(); ++i) {
-            if (modDef.subAnimations[i].name == name) {
-                return i;
-            }
-        }
-        return std::nullopt;
+        return _library.FindSub(modIdx, name);
     }
 
 void AnimationManager::UpdateMaxMovesetCache() {
         SKSE::log::info("Atualizando cache de contagem máxima de movesets...");
-        _maxMovesetsPerCategory.clear();
         _maxMovesetsPerCategory_NPC.clear();
 
-        // 1. Cache do JOGADOR (lógica inalterada)
-        for (auto& pair : _categories) {
-            WeaponCategory& category = pair.second;
-            std::array<int, 4> counts = {0, 0, 0, 0};
-            for (int i = 0; i < 4; ++i) {
-                CategoryInstance& instance = category.instances[i];
-                int parentMovesetCount = 0;
-                for (auto& modInst : instance.modInstances) {
-                    if (!modInst.isSelected) continue;
-                    for (auto& subInst : modInst.subAnimationInstances) {
-                        if (!subInst.isSelected) continue;
-                        const auto& sourceSubAnim =
-                            _allMods[subInst.sourceModIndex].subAnimations[subInst.sourceSubAnimIndex];
-                        if (!sourceSubAnim.hasAnimations) {
-                            continue;
-                        }
-                        bool isParent = !(subInst.pFront || subInst.pBack || subInst.pLeft || subInst.pRight ||
-                                          subInst.pFrontRight || subInst.pFrontLeft || subInst.pBackRight ||
-                                          subInst.pBackLeft || subInst.pRandom || subInst.pDodge);
-                        if (isParent) {
-                            parentMovesetCount++;
-                        }
-                    }
-                }
-                counts[i] = parentMovesetCount;
-            }
-            _maxMovesetsPerCategory[category.name] = counts;
-        }
+        // 1. Playlist do JOGADOR: compilada uma vez aqui; contagem, nome e tags saem dela
+        auto playlists = std::make_shared<PlaylistTable>();
+        playlists->Build(_categories, _allMods, _library,
+                         [this](const SubAnimationInstance& subInst) { return LibraryIdOf(subInst); });
+        _playlists.store(std::move(playlists));
         SKSE::log::info("Cache do Jogador atualizado.");
 
         // 2. Cache dos NPCS GERAIS (usando FormID 0 como chave)
@@ -2258,37 +2895,109 @@ void AnimationManager::UpdateMaxMovesetCache() {
     //    parentArray.PushBack(mainAndBlock, allocator);
     //}
 
+    void AnimationManager::BuildKeywordExclusions() {
+        auto cache = std::make_unique<KeywordExclusionCache>();
+        auto& allocator = cache->allocator;
+
+        std::unordered_map<std::string, size_t> keywordIds;
+        auto idOf = [&](const std::string& keyword) {
+            auto [it, inserted] = keywordIds.try_emplace(keyword, cache->keywordNames.size());
+            if (inserted) cache->keywordNames.push_back(keyword);
+            return it->second;
+        };
+        std::unordered_map<std::string, std::vector<size_t>> ownIds;
+        for (const auto& [name, category] : _categories) {
+            auto& ids = ownIds[name];
+            for (const auto& keyword : category.keywords) ids.push_back(idOf(keyword));
+        }
+        const size_t words = (cache->keywordNames.size() + 63) / 64;
+        auto setBits = [](std::vector<std::uint64_t>& bits, const std::vector<size_t>& ids) {
+            for (size_t id : ids) bits[id / 64] |= std::uint64_t{1} << (id % 64);
+        };
+
+        for (const auto& [name, category] : _categories) {
+            std::vector<std::uint64_t> bits(words, 0);
+            for (const auto& [otherName, otherCategory] : _categories) {
+                if (otherName != name && otherCategory.equippedTypeValue == category.equippedTypeValue &&
+                    !otherCategory.keywords.empty()) {
+                    setBits(bits, ownIds[otherName]);
+                }
+            }
+            auto& fragments = cache->fragments[name];
+            for (int hand = 0; hand < 2; ++hand) {
+                fragments[hand] = BuildCompetingKeywordBlock(bits, cache->keywordNames, hand == 1,
+                                                             "Exclude competing weapon keywords", allocator);
+            }
+        }
+
+        std::vector<std::uint64_t> shieldBits(words, 0);
+        for (const auto& [name, category] : _categories) {
+            if (category.isCustom && category.isShieldCategory && !category.keywords.empty()) {
+                setBits(shieldBits, ownIds[name]);
+            }
+        }
+        cache->shieldFragment = BuildCompetingKeywordBlock(
+            shieldBits, cache->keywordNames, false, "Exclude competing custom Shield + Weapon categories", allocator);
+
+        _keywordExclusions = std::move(cache);
+    }
+
+    rapidjson::Value AnimationManager::BuildCompetingKeywordBlock(const std::vector<std::uint64_t>& bits,
+                                                                  const std::vector<std::string>& keywordNames,
+                                                                  bool isLeftHand, const char* comment,
+                                                                  rapidjson::Document::AllocatorType& allocator) {
+        rapidjson::Value innerExclusionConditions(rapidjson::kArrayType);
+        for (size_t word = 0; word < bits.size(); ++word) {
+            for (std::uint64_t rest = bits[word]; rest != 0; rest &= rest - 1) {
+                const size_t id = word * 64 + static_cast<size_t>(std::countr_zero(rest));
+                AddKeywordCondition(innerExclusionConditions, keywordNames[id], isLeftHand, true, allocator);
+            }
+        }
+        if (innerExclusionConditions.Empty()) {
+            return rapidjson::Value();
+        }
+
+        rapidjson::Value exclusionAndBlock(rapidjson::kObjectType);
+        exclusionAndBlock.AddMember("condition", "AND", allocator);
+        exclusionAndBlock.AddMember("comment", rapidjson::StringRef(comment), allocator);
+        exclusionAndBlock.AddMember("Conditions", innerExclusionConditions, allocator);
+        return exclusionAndBlock;
+    }
+
     void AnimationManager::AddCompetingKeywordExclusions(rapidjson::Value& parentArray,
                                                          const WeaponCategory* currentCategory, bool isLeftHand,
                                                          rapidjson::Document::AllocatorType& allocator) {
-        // 1. Coleta todas as keywords concorrentes primeiro
+        // O bloco vem pronto do cache; só é copiado para o allocator do documento que está sendo gerado
+        if (_keywordExclusions) {
+            auto it = _keywordExclusions->fragments.find(currentCategory->name);
+            if (it != _keywordExclusions->fragments.end()) {
+                const rapidjson::Value& fragment = it->second[isLeftHand ? 1 : 0];
+                if (!fragment.IsNull()) {
+                    parentArray.PushBack(rapidjson::Value(fragment, allocator), allocator);
+                }
+                return;
+            }
+        }
+
+        // Categoria fora de _categories (ou cache ainda não montado): calcula na hora
         std::vector<std::string> competingKeywords;
         for (const auto& pair : _categories) {
             const WeaponCategory& otherCategory = pair.second;
             if (otherCategory.name != currentCategory->name &&
                 otherCategory.equippedTypeValue == currentCategory->equippedTypeValue && !otherCategory.keywords.empty()) {
-                // Adiciona todas as keywords da categoria concorrente à lista de exclusão
                 competingKeywords.insert(competingKeywords.end(), otherCategory.keywords.begin(),
                                          otherCategory.keywords.end());
             }
         }
-
-        if (competingKeywords.empty()) {
-            return;
+        std::vector<std::uint64_t> bits((competingKeywords.size() + 63) / 64, ~std::uint64_t{0});
+        if (!competingKeywords.empty() && competingKeywords.size() % 64 != 0) {
+            bits.back() = (std::uint64_t{1} << (competingKeywords.size() % 64)) - 1;
         }
-
-        rapidjson::Value exclusionAndBlock(rapidjson::kObjectType);
-        exclusionAndBlock.AddMember("condition", "AND", allocator);
-        exclusionAndBlock.AddMember("comment", "Exclude competing weapon keywords", allocator);
-        rapidjson::Value innerExclusionConditions(rapidjson::kArrayType);
-
-        for (const auto& keyword : competingKeywords) {
-            // A lógica interna permanece a mesma, pois AddKeywordCondition já lida com uma keyword por vez
-            AddKeywordCondition(innerExclusionConditions, keyword, isLeftHand, true, allocator);
+        rapidjson::Value block = BuildCompetingKeywordBlock(bits, competingKeywords, isLeftHand,
+                                                            "Exclude competing weapon keywords", allocator);
+        if (!block.IsNull()) {
+            parentArray.PushBack(block, allocator);
         }
-
-        exclusionAndBlock.AddMember("Conditions", innerExclusionConditions, allocator);
-        parentArray.PushBack(exclusionAndBlock, allocator);
     }
 
 
@@ -2319,9 +3028,25 @@ void AnimationManager::UpdateMaxMovesetCache() {
 
 
 void AnimationManager::SaveCycleMovesets() {
-        SKSE::log::info("Iniciando salvamento do estado da UI em arquivos User_CycleMoveset.json...");
+        SKSE::log::info("Iniciando salvamento do estado da UI (User_CycleMoveset)...");
+
+        // Posições do perfil (por FormID), da categoria e da stance nos arrays de cada documento,
+        // mantidas enquanto o documento é montado para não varrer os arrays a cada sub-animação.
+        // Guardam índices e não ponteiros: um PushBack pode realocar o array.
+        struct CategoryIndex {
+            rapidjson::SizeType position = 0;
+            std::unordered_map<std::string, rapidjson::SizeType> stances;  // "<index>|<nome do mod>"
+        };
+        struct ProfileIndex {
+            rapidjson::SizeType position = 0;
+            std::unordered_map<std::string, CategoryIndex> categories;
+        };
+        struct UserDocument {
+            rapidjson::Document doc;
+            std::unordered_map<std::string, ProfileIndex> profiles;
+        };
 
-        std::map<std::filesystem::path, std::unique_ptr<rapidjson::Document>> documents;
+        std::map<std::filesystem::path, std::unique_ptr<UserDocument>> documents;
         std::set<std::filesystem::path> requiredFiles;
 
         auto processActorCategories = [&](const std::map<std::string, WeaponCategory>& sourceCategories,
@@ -2353,6 +3078,7 @@ void AnimationManager::SaveCycleMovesets() {
                         if (!modInst.isSelected) continue;
 
                         const auto& sourceMod = _allMods[modInst.sourceModIndex];
+                        const std::string stanceKey = std::format("{}|{}", i + 1, sourceMod.name);
 
                         int animationIndexCounter = 1;
                         for (const auto& subInst : modInst.subAnimationInstances) {
@@ -2360,32 +3086,30 @@ void AnimationManager::SaveCycleMovesets() {
 
                             const auto& animOriginMod = _allMods[subInst.sourceModIndex];
                             const auto& animOriginSub = animOriginMod.subAnimations[subInst.sourceSubAnimIndex];
+                            // Convertido uma vez por entrada: usado no destino e no sourceConfigPath
+                            const auto originPath = animOriginSub.path.get();
                             std::filesystem::path destJsonPath;
                             // Se a animação for do mod virtual DAR, o path é o próprio diretório
                             if (animOriginMod.name == "[DAR] Animations") {
-                                destJsonPath = animOriginSub.path / "User_CycleMoveset.json";
+                                destJsonPath = originPath / "User_CycleMoveset.json";
                             } else {  // Senão, é o pai do config.json
-                                destJsonPath = animOriginSub.path.parent_path() / "User_CycleMoveset.json";
+                                destJsonPath = originPath.parent_path() / "User_CycleMoveset.json";
                             }
                             requiredFiles.insert(destJsonPath);
 
-                            if (documents.find(destJsonPath) == documents.end()) {
-                                documents[destJsonPath] = std::make_unique<rapidjson::Document>();
-                                documents[destJsonPath]->SetArray();
+                            auto [docIt, docInserted] = documents.try_emplace(destJsonPath);
+                            if (docInserted) {
+                                docIt->second = std::make_unique<UserDocument>();
+                                docIt->second->doc.SetArray();
                             }
-                            rapidjson::Document& doc = *documents[destJsonPath];
+                            UserDocument& userDoc = *docIt->second;
+                            rapidjson::Document& doc = userDoc.doc;
                             auto& allocator = doc.GetAllocator();
 
                             // 1. Encontra/Cria o Perfil do Ator
-                            rapidjson::Value* profileObj = nullptr;
-                            for (auto& item : doc.GetArray()) {
-                                if (item.IsObject() && item.HasMember("FormID") &&
-                                    item["FormID"].GetString() == actorFormIDStr) {
-                                    profileObj = &item;
-                                    break;
-                                }
-                            }
-                            if (!profileObj) {
+                            auto [profileIt, profileInserted] = userDoc.profiles.try_emplace(actorFormIDStr);
+                            ProfileIndex& profileIndex = profileIt->second;
+                            if (profileInserted) {
                                 rapidjson::Value newProfileObj(rapidjson::kObjectType);
                                 newProfileObj.AddMember("Type", rapidjson::Value(actorTypeStr.c_str(), allocator),
                                                         allocator);
@@ -2398,40 +3122,28 @@ void AnimationManager::SaveCycleMovesets() {
                                 newProfileObj.AddMember(
                                     "Identifier", rapidjson::Value(actorIdentifier.c_str(), allocator), allocator);
                                 newProfileObj.AddMember("Menu", rapidjson::kArrayType, allocator);
+                                profileIndex.position = doc.Size();
                                 doc.PushBack(newProfileObj, allocator);
-                                profileObj = &doc.GetArray()[doc.GetArray().Size() - 1];
                             }
+                            rapidjson::Value& profileObj = doc[profileIndex.position];
 
                             // 2. Encontra/Cria a Categoria
-                            rapidjson::Value& menuArray = (*profileObj)["Menu"];
-                            rapidjson::Value* categoryObj = nullptr;
-                            for (auto& item : menuArray.GetArray()) {
-                                if (item.IsObject() && item.HasMember("Category") &&
-                                    item["Category"].GetString() == category.name) {
-                                    categoryObj = &item;
-                                    break;
-                                }
-                            }
-                            if (!categoryObj) {
+                            rapidjson::Value& menuArray = profileObj["Menu"];
+                            auto [categoryIt, categoryInserted] = profileIndex.categories.try_emplace(category.name);
+                            CategoryIndex& categoryIndex = categoryIt->second;
+                            if (categoryInserted) {
                                 rapidjson::Value newCategoryObj(rapidjson::kObjectType);
                                 newCategoryObj.AddMember("Category", rapidjson::Value(category.name.c_str(), allocator),
                                                          allocator);
                                 newCategoryObj.AddMember("stances", rapidjson::kArrayType, allocator);
+                                categoryIndex.position = menuArray.Size();
                                 menuArray.PushBack(newCategoryObj, allocator);
-                                categoryObj = &menuArray.GetArray()[menuArray.GetArray().Size() - 1];
                             }
 
                             // 3. Encontra/Cria a Stance (o moveset)
-                            rapidjson::Value& stancesArray = (*categoryObj)["stances"];
-                            rapidjson::Value* stanceObj = nullptr;
-                            for (auto& item : stancesArray.GetArray()) {
-                                if (item.IsObject() && item["index"].GetInt() == (i + 1) && item.HasMember("name") &&
-                                    strcmp(item["name"].GetString(), sourceMod.name.c_str()) == 0) {
-                                    stanceObj = &item;
-                                    break;
-                                }
-                            }
-                            if (!stanceObj) {
+                            rapidjson::Value& stancesArray = menuArray[categoryIndex.position]["stances"];
+                            auto [stanceIt, stanceInserted] = categoryIndex.stances.try_emplace(stanceKey);
+                            if (stanceInserted) {
                                 rapidjson::Value newStanceObj(rapidjson::kObjectType);
                                 newStanceObj.AddMember("index", i + 1, allocator);
                                 newStanceObj.AddMember("type", "moveset", allocator);
@@ -2447,12 +3159,12 @@ void AnimationManager::SaveCycleMovesets() {
                                 newStanceObj.AddMember("order", static_cast<int>(mod_idx + 1), allocator);
 
                                 newStanceObj.AddMember("animations", rapidjson::kArrayType, allocator);
+                                stanceIt->second = stancesArray.Size();
                                 stancesArray.PushBack(newStanceObj, allocator);
-                                stanceObj = &stancesArray.GetArray()[stancesArray.GetArray().Size() - 1];
                             }
 
                             // 4. Adiciona a Animação individual ao array "animations" da Stance
-                            rapidjson::Value& animationsArray = (*stanceObj)["animations"];
+                            rapidjson::Value& animationsArray = stancesArray[stanceIt->second]["animations"];
                             rapidjson::Value animObj(rapidjson::kObjectType);
                             animObj.AddMember("index", animationIndexCounter++, allocator);
                             animObj.AddMember("sourceModName", rapidjson::Value(animOriginMod.name.c_str(), allocator),
@@ -2468,7 +3180,7 @@ void AnimationManager::SaveCycleMovesets() {
                             animObj.AddMember("hasDPA_R", animOriginSub.dpaTags.hasR, allocator);
                             animObj.AddMember("hasCPA", animOriginSub.hasCPA, allocator);
                             animObj.AddMember("sourceConfigPath",
-                                              rapidjson::Value(animOriginSub.path.string().c_str(), allocator),
+                                              rapidjson::Value(originPath.string().c_str(), allocator),
                                               allocator);
                             animObj.AddMember("pFront", subInst.pFront, allocator);
                             animObj.AddMember("pBack", subInst.pBack, allocator);
@@ -2496,11 +3208,15 @@ void AnimationManager::SaveCycleMovesets() {
             processActorCategories(rule.categories, &rule);
         }
 
-        // Escreve os arquivos no disco
-        SKSE::log::info("Escrevendo {} arquivos User_CycleMoveset.json...", documents.size());
+        // Uma seção por pasta no UserState.bin; os User_CycleMoveset.json soltos só com a exportação ligada
+        const bool exportFiles = Settings::exportPerFolderJson;
+        StateStore::Sections ruleSections;
+        if (exportFiles) SKSE::log::info("Escrevendo {} arquivos User_CycleMoveset.json...", documents.size());
         for (const auto& pair : documents) {
             const auto& path = pair.first;
-            const auto& doc = pair.second;
+            const auto& doc = &pair.second->doc;
+            ruleSections.insert_or_assign(StateStore::RulesKey(path.parent_path()), StateStore::Encode(*doc));
+            if (!exportFiles) continue;
             FILE* fp;
             fopen_s(&fp, path.string().c_str(), "wb");
             if (fp) {
@@ -2515,13 +3231,17 @@ void AnimationManager::SaveCycleMovesets() {
         }
 
         // Limpa arquivos órfãos
-        
+        const std::string emptyRules = StateStore::Encode(rapidjson::Value(rapidjson::kArrayType));
         for (const auto& managedConfigPath : _managedFiles) {
             // Deriva o nome do arquivo de UI a partir do caminho do config.json gerenciado
             std::filesystem::path userCycleMovesetPath = managedConfigPath.parent_path() / "User_CycleMoveset.json";
 
             // Se o arquivo de UI não foi requerido nesta operação de salvamento, ele é um órfão.
             if (requiredFiles.find(userCycleMovesetPath) == requiredFiles.end()) {
+                // A seção vazia também esconde um CycleMoveset.json padrão que esteja na pasta
+                ruleSections.insert_or_assign(StateStore::RulesKey(managedConfigPath.parent_path()), emptyRules);
+                if (!exportFiles) continue;
+
                 // Seja para limpar um arquivo existente ou criar um novo para sobrescrever um fallback,
                 // a operação é a mesma: escrever "[]" no arquivo.
                 SKSE::log::info("Limpando/Criando User_CycleMoveset.json órfão em: {}", userCycleMovesetPath.string());
@@ -2535,7 +3255,25 @@ void AnimationManager::SaveCycleMovesets() {
                 }
             }
         }
-        SKSE::log::info("Salvamento de {} arquivos User_CycleMoveset.json concluído.", documents.size());
+        // Pastas que não estão na biblioteca desta sessão (mod desativado, pasta sumida) mantêm as
+        // regras salvas: sem o arquivo solto na pasta, a seção é a única cópia delas.
+        std::unordered_set<std::string> walkedFolders;
+        for (const auto& mod : _allMods) {
+            for (const auto& def : mod.subAnimations) {
+                if (def.isMissing) continue;
+                auto folder = def.path.get();
+                if (folder.filename() == "config.json") folder = folder.parent_path();
+                walkedFolders.insert(StateStore::RulesKey(folder));
+            }
+        }
+        for (const auto* ruleFiles : {&_oarRuleFiles, &_darRuleFiles}) {
+            for (const auto& ruleFile : *ruleFiles) {
+                walkedFolders.insert(StateStore::RulesKey(ruleFile.parent_path()));
+            }
+        }
+        StateStore::Get().ReplacePrefix("rules/", std::move(ruleSections),
+                                        [&](const std::string& key) { return !walkedFolders.contains(key); });
+        SKSE::log::info("Salvamento de {} pastas de User_CycleMoveset concluído.", documents.size());
     }
 
 
@@ -2552,26 +3290,22 @@ void AnimationManager::LoadCycleMovesets() {
         }
         _npcRules.clear();
 
-        const std::filesystem::path oarRootPath = "Data\\meshes\\actors\\character\\animations\\OpenAnimationReplacer";
+        const std::filesystem::path oarRootPath = oar_root_path;
         if (!std::filesystem::exists(oarRootPath)) {
             SKSE::log::warn("Diretório do OAR não encontrado. Carregamento de regras abortado.");
             return;
         }
-        const std::filesystem::path darRootPath =
-            "Data\\meshes\\actors\\character\\animations\\DynamicAnimationReplacer\\_CustomConditions";
-       
-        std::set<std::filesystem::path> processedFolders;
 
-        auto processJsonFile = [&](const std::filesystem::path& jsonPath) {
-            std::ifstream ifs(jsonPath);
-            if (!ifs.is_open()) return;
-            std::string jsonContent((std::istreambuf_iterator<char>(ifs)), {});
-            ifs.close();
-            rapidjson::Document doc;
-            doc.Parse(jsonContent.c_str());
+        // FormID -> posição em _npcRules, para não formatar o FormID de cada regra a cada perfil lido
+        std::unordered_map<RE::FormID, size_t> ruleIndexByFormID;
+
+        // Um leitor para todos os arquivos: o arena é reaproveitado de um documento para o outro
+        JsonReader reader;
+        auto processLoaded = [&](const std::string& sourceLabel) {
+            const rapidjson::Document& doc = reader.ParseInsitu();
 
             if (doc.HasParseError() || !doc.IsArray()) {
-                SKSE::log::warn("Arquivo mal formatado ou não é um array, pulando: {}", jsonPath.string());
+                SKSE::log::warn("Arquivo mal formatado ou não é um array, pulando: {}", sourceLabel);
                 return;
             }
 
@@ -2595,32 +3329,31 @@ void AnimationManager::LoadCycleMovesets() {
                     _generalNpcRule.type = RuleType::GeneralNPC;
                     _generalNpcRule.formID = 0xFFFFFFFF;  // ID Sentinela
                 } else {
-                    // LÓGICA DE BUSCA CORRIGIDA
-                    auto rule_it = std::find_if(_npcRules.begin(), _npcRules.end(), [&](const MovesetRule& r) {
-                        return std::format("{:08X}", r.formID) == formIdStr;
-                    });
+                    RE::FormID formID = 0;
+                    try {
+                        formID = std::stoul(formIdStr, nullptr, 16);
+                    } catch (const std::exception&) {
+                        continue;
+                    }
 
-                    if (rule_it == _npcRules.end()) {
+                    auto rule_it = ruleIndexByFormID.find(formID);
+                    if (rule_it == ruleIndexByFormID.end()) {
                         MovesetRule newRule;
                         newRule.type = RuleTypeFromString(type);
                         newRule.displayName = profile["Name"].GetString();
                         newRule.identifier = profile["Identifier"].GetString();
                         newRule.pluginName = profile["Plugin"].GetString();
-
-                        try {
-                            newRule.formID = std::stoul(formIdStr, nullptr, 16);
-                        } catch (const std::exception&) {
-                            continue;
-                        }
+                        newRule.formID = formID;
 
                         newRule.categories = _categories;  // Começa com uma cópia limpa
                         for (auto& pair : newRule.categories) {
                             for (auto& instance : pair.second.instances) instance.modInstances.clear();
                         }
+                        ruleIndexByFormID.emplace(formID, _npcRules.size());
                         _npcRules.push_back(newRule);
                         targetCategories = &_npcRules.back().categories;
                     } else {
-                        targetCategories = &rule_it->categories;
+                        targetCategories = &_npcRules[rule_it->second].categories;
                     }
                 }
 
@@ -2696,21 +3429,18 @@ void AnimationManager::LoadCycleMovesets() {
 
                             // Busca a animação usando o caminho como ID único
                             auto indicesOpt = FindSubAnimationByPath(configPathStr);
-
                             if (!indicesOpt) {
-                                indicesOpt = FindSubAnimationByPath(configPathStr);
-                                if (!indicesOpt) {
-                                    SKSE::log::warn(
-                                        "Não foi possível encontrar a animação para o config/path: {}. Pode ter sido "
-                                        "removida. Pulando.",
-                                        configPathStr);
-                                    continue;
-                                }
+                                SKSE::log::warn(
+                                    "Não foi possível encontrar a animação para o config/path: {}. Pode ter sido "
+                                    "removida. Pulando.",
+                                    configPathStr);
+                                continue;
                             }
 
                             SubAnimationInstance newSubInstance;
                             newSubInstance.sourceModIndex = indicesOpt->first;       // Índice do Mod
                             newSubInstance.sourceSubAnimIndex = indicesOpt->second;  // Índice da Sub-Animação
+                            newSubInstance.subMovesetId = _library.IdOf(indicesOpt->first, indicesOpt->second);
                             if (animJson.HasMember("sourceSubName") && animJson["sourceSubName"].IsString()) {
                                 const char* savedName = animJson["sourceSubName"].GetString();
                                 const auto& originSubAnim = _allMods[newSubInstance.sourceModIndex]
@@ -2766,63 +3496,50 @@ void AnimationManager::LoadCycleMovesets() {
             }
         };
 
-        if (std::filesystem::exists(oarRootPath)) {
-            for (const auto& entry : std::filesystem::recursive_directory_iterator(oarRootPath)) {
-                // Iremos procurar apenas por pastas que contenham um config.json, que definem um sub-moveset.
-                if (entry.is_regular_file() && entry.path().filename() == "config.json") {
-                    std::filesystem::path currentFolder = entry.path().parent_path();
-
-                    std::filesystem::path userFile = currentFolder / "User_CycleMoveset.json";
-                    std::filesystem::path defaultFile = currentFolder / "CycleMoveset.json";
-
-                    bool userFileExists = std::filesystem::exists(userFile);
-
-                    // Cenário 1: User_CycleMoveset.json existe.
-                    if (userFileExists) {
-                        // Tentamos processá-lo. A função retorna `true` se tiver conteúdo e for processado.
-                        // Se o arquivo existir mas estiver vazio ou mal-formado, a função retorna `false`
-                        // e nós NÃO tentamos carregar o arquivo de fallback, respeitando a intenção do usuário.
-                        processJsonFile(userFile);
-                    }
-                    // Cenário 2: User_CycleMoveset.json NÃO existe.
-                    else {
-                        // Procuramos pelo arquivo de fallback.
-                        if (std::filesystem::exists(defaultFile)) {
-                            processJsonFile(defaultFile);
-                        }
-                    }
-                }
+        auto& store = StateStore::Get();
+        std::unordered_set<std::string> storedFolders;
+        auto processRuleFile = [&](const std::filesystem::path& jsonPath) {
+            // A seção do UserState.bin tem precedência sobre o arquivo da pasta, exceto um
+            // User_CycleMoveset.json mais novo que ela (ex.: compartilhado por outro usuário), que é importado
+            std::string key = StateStore::RulesKey(jsonPath.parent_path());
+            auto stored = store.Find(key);
+            if (!stored) {
+                if (!reader.Load(jsonPath)) return;
+                processLoaded(jsonPath.string());
+                return;
             }
-        }
-        if (std::filesystem::exists(darRootPath)) {
-            for (const auto& entry : std::filesystem::recursive_directory_iterator(darRootPath)) {
-                // Iremos procurar apenas por pastas que contenham um config.json, que definem um sub-moveset.
-                if (entry.is_regular_file() && entry.path().filename() == "user.json") {
-                    std::filesystem::path currentFolder = entry.path().parent_path();
-
-                    std::filesystem::path userFile = currentFolder / "User_CycleMoveset.json";
-                    std::filesystem::path defaultFile = currentFolder / "CycleMoveset.json";
-
-                    bool userFileExists = std::filesystem::exists(userFile);
-
-                    // Cenário 1: User_CycleMoveset.json existe.
-                    if (userFileExists) {
-                        // Tentamos processá-lo. A função retorna `true` se tiver conteúdo e for processado.
-                        // Se o arquivo existir mas estiver vazio ou mal-formado, a função retorna `false`
-                        // e nós NÃO tentamos carregar o arquivo de fallback, respeitando a intenção do usuário.
-                        processJsonFile(userFile);
-                    }
-                    // Cenário 2: User_CycleMoveset.json NÃO existe.
-                    else {
-                        // Procuramos pelo arquivo de fallback.
-                        if (std::filesystem::exists(defaultFile)) {
-                            processJsonFile(defaultFile);
-                        }
+            if (jsonPath.filename() == "User_CycleMoveset.json" && store.IsNewer(jsonPath, key) &&
+                reader.Load(jsonPath)) {
+                const rapidjson::Document& doc = reader.ParseInsitu();
+                if (!doc.HasParseError() && doc.IsArray()) {
+                    auto imported = StateStore::Encode(doc);
+                    if (imported != *stored) {
+                        SKSE::log::info("Importando {} (mais novo que o UserState.bin).", jsonPath.string());
+                        store.Put(key, imported);
+                        stored = std::move(imported);
                     }
                 }
             }
+            reader.AssignEncoded(*stored);
+            processLoaded(key);
+            storedFolders.insert(std::move(key));
+        };
+
+        // Os arquivos de regra já foram localizados pelo walk do ScanAnimationMods/ScanDarAnimations,
+        // seguindo a precedência: se User_CycleMoveset.json existir, ele é usado (mesmo vazio ou
+        // mal-formado, respeitando a intenção do usuário); senão, o CycleMoveset.json padrão.
+        for (const auto& ruleFile : _oarRuleFiles) {
+            processRuleFile(ruleFile);
         }
-        
+        for (const auto& ruleFile : _darRuleFiles) {
+            processRuleFile(ruleFile);
+        }
+        // Pastas que só existem no UserState.bin (sem exportação por pasta)
+        store.ForEachPrefix("rules/", [&](const std::string& key, const std::string& payload) {
+            if (storedFolders.contains(key)) return;
+            reader.AssignEncoded(payload);
+            processLoaded(key);
+        });
 
         // <<< MUDANÇA: Adiciona um passo de ordenação DEPOIS de carregar todos os arquivos
         SKSE::log::info("Ordenando movesets com base na prioridade definida...");
@@ -2879,16 +3596,15 @@ void AnimationManager::LoadCycleMovesets() {
                     config.isParent = true;  // NPCs não têm direcionais, então tudo é "Pai"
                     config.order_in_playlist = playlistParentCounter++;
 
-                    fileUpdates[sourceSubAnim.path].push_back(config);
+                    fileUpdates[sourceSubAnim.path.get()].push_back(config);
                 }
             }
         }
 
         SKSE::log::info("{} arquivos de configuração de NPC serão modificados.", fileUpdates.size());
-        for (const auto& updateEntry : fileUpdates) {
-            // A mesma função UpdateOrCreateJson é chamada!
-            UpdateOrCreateJson(updateEntry.first, updateEntry.second);
-        }
+        // A mesma função UpdateOrCreateJson é chamada, só que em paralelo
+        WorkStealingPool pool;
+        WriteConfigFiles(fileUpdates, &pool);
         RE::DebugNotification("Configurações dos NPCs salvas!");
     }
 
@@ -2959,54 +3675,17 @@ void AnimationManager::LoadCycleMovesets() {
     // NOVA FUNÇÃO: Busca as tags DPA e CPA para o moveset ativo (baseada em GetCurrentMovesetName)
     MovesetTags AnimationManager::GetCurrentMovesetTags(const std::string& categoryName,
                                                                           int stanceIndex, int movesetIndex) {
-        auto animManager = AnimationManager::GetSingleton();
         if (movesetIndex <= 0) {
             return {false, false};  // Retorna padrão se não houver moveset ativo
         }
-
-        auto cat_it = animManager->GetCategories().find(categoryName);
-        if (cat_it == animManager->GetCategories().end()) {
+        // Tags vêm da biblioteca (o que existe na pasta), gravadas na playlist compilada
+        const auto table = _playlists.load();
+        const auto categoryId = table->CategoryIdOf(categoryName);
+        if (!categoryId) {
             return {false, false};
         }
-
-        const WeaponCategory& category = cat_it->second;
-        if (stanceIndex < 0 || stanceIndex >= 4) {
-            return {false, false};
-        }
-
-        const CategoryInstance& instance = category.instances[stanceIndex];
-        const SubAnimationInstance* targetMoveset = nullptr;
-        int parentCounter = 0;
-
-        // A lógica para encontrar o moveset ativo é a mesma da função GetCurrentMovesetName
-        for (const auto& modInst : instance.modInstances) {
-            if (!modInst.isSelected) continue;
-            for (const auto& subInst : modInst.subAnimationInstances) {
-                if (!subInst.isSelected) continue;
-
-                const auto& sourceSubAnim = _allMods[subInst.sourceModIndex].subAnimations[subInst.sourceSubAnimIndex];
-                if (!sourceSubAnim.hasAnimations) {
-                    continue;
-                }
-
-                bool isParent = !(subInst.pFront || subInst.pBack || subInst.pLeft || subInst.pRight ||
-                                  subInst.pFrontRight || subInst.pFrontLeft || subInst.pBackRight ||
-                                  subInst.pBackLeft || subInst.pRandom || subInst.pDodge);
-
-                if (isParent) {
-                    parentCounter++;
-                    if (parentCounter == movesetIndex) {
-                        targetMoveset = &subInst;
-                        goto found_target;  // Encontramos o moveset pai, podemos parar de procurar
-                    }
-                }
-            }
-        }
-
-    found_target:
-        if (targetMoveset) {
-            // Retorna as tags do moveset encontrado
-            return {targetMoveset->dpaTags, targetMoveset->hasCPA};
+        if (const auto* entry = table->At(*categoryId, stanceIndex, movesetIndex)) {
+            return entry->tags;
         }
 
         // Se não encontrou (índice inválido), retorna o padrão
@@ -3016,104 +3695,50 @@ void AnimationManager::LoadCycleMovesets() {
     // Função para buscar o nome do moveset
     std::string AnimationManager::GetCurrentMovesetName(const std::string& categoryName, int stanceIndex,
                                                         int movesetIndex, int directionalState) {
-        //SKSE::log::info("==========================================================");
-        //SKSE::log::info("[GetCurrentMovesetName] Invocado com: Categoria='{}', Stance={}, MovesetIndex={}, Direcao={}",categoryName, stanceIndex, movesetIndex, directionalState);
         if (movesetIndex <= 0) {
             return "Nenhum";
         }
 
-        auto cat_it = _categories.find(categoryName);
-        if (cat_it == _categories.end()) {
+        const auto table = _playlists.load();
+        const auto categoryId = table->CategoryIdOf(categoryName);
+        if (!categoryId) {
             return "Categoria não encontrada";
         }
 
-        WeaponCategory& category = cat_it->second;
         if (stanceIndex < 0 || stanceIndex >= 4) {
             return "Stance inválida";
         }
 
-        CategoryInstance& instance = category.instances[stanceIndex];
-
-        int parentCounter = 0;
-        const SubAnimationInstance* targetParent = nullptr;
-
-        for (auto& modInst : instance.modInstances) {
-            if (!modInst.isSelected) continue;
-            for (auto& subInst : modInst.subAnimationInstances) {
-                if (!subInst.isSelected) continue;
-
-                const auto& sourceSubAnim = _allMods[subInst.sourceModIndex].subAnimations[subInst.sourceSubAnimIndex];
-                if (!sourceSubAnim.hasAnimations) {
-                    continue;
-                }
-
-                bool isParent = !(subInst.pFront || subInst.pBack || subInst.pLeft || subInst.pRight ||
-                                  subInst.pFrontRight || subInst.pFrontLeft || subInst.pBackRight ||
-                                  subInst.pBackLeft || subInst.pRandom || subInst.pDodge);
-
-                if (isParent) {
-                    parentCounter++;
-                    if (parentCounter == movesetIndex) {
-                        targetParent = &subInst;
-                        // Se não for necessária uma direção, já encontramos o que queríamos.
-                        if (directionalState == 0) {
-                            goto found_target;
-                        }
-                        // Caso contrário, continuamos escaneando em busca de filhos.
-                    } else if (targetParent != nullptr) {
-                        // Se já passamos pelo nosso "pai" alvo e encontramos o PRÓXIMO "pai",
-                        // significa que não havia um filho direcional válido no meio. Paramos a busca.
-                        goto found_target;
-                    }
-                } else if (targetParent != nullptr && directionalState != 0) {
-                    // Se estamos nesta parte, significa que encontramos uma animação "filha" E
-                    // já passamos pelo "pai" que estávamos procurando.
-                    bool isDirectionalMatch =
-                        (directionalState == 1 && subInst.pFront) || (directionalState == 2 && subInst.pFrontRight) ||
-                        (directionalState == 3 && subInst.pRight) || (directionalState == 4 && subInst.pBackRight) ||
-                        (directionalState == 5 && subInst.pBack) || (directionalState == 6 && subInst.pBackLeft) ||
-                        (directionalState == 7 && subInst.pLeft) || (directionalState == 8 && subInst.pFrontLeft);
-
-                    if (isDirectionalMatch) {
-                        // Encontramos o filho direcional que corresponde ao nosso pai! Este é o resultado final.
-                        const auto& sourceSubAnimChild =
-                            _allMods[subInst.sourceModIndex].subAnimations[subInst.sourceSubAnimIndex];
-                        return (subInst.editedName[0] != '\0') ? subInst.editedName.data() : sourceSubAnimChild.name;
-                    }
-                }
-            }
-        }
-
-    found_target:
-        // Se chegamos aqui, ou encontramos o pai e não precisávamos de direção, ou não encontramos um filho válido.
-        // Em ambos os casos, retornamos o nome do pai.
-        if (targetParent) {
-            const auto& sourceSubAnimParent =
-                _allMods[targetParent->sourceModIndex].subAnimations[targetParent->sourceSubAnimIndex];
-            return (targetParent->editedName[0] != '\0') ? targetParent->editedName.data() : sourceSubAnimParent.name;
+        // Direção sem filho direcional já aponta para o nome do pai na tabela
+        if (const auto* entry = table->At(*categoryId, stanceIndex, movesetIndex)) {
+            return std::string(entry->NameFor(directionalState));
         }
 
-        // Se a função terminar aqui, o movesetIndex era inválido (ex: pediu o 5º pai, mas só existem 4).
-        //SKSE::log::warn("[GetCurrentMovesetName] Nenhum moveset 'pai' encontrado para o índice {}", movesetIndex);
+        // O movesetIndex era inválido (ex: pediu o 5º pai, mas só existem 4).
         return "Não encontrado";
     }
 
 
 
     void AnimationManager::SaveStanceNames() {
-        SKSE::log::info("Salvando nomes das stances em arquivos separados por categoria...");
+        SKSE::log::info("Salvando nomes das stances...");
         const std::filesystem::path stancesFolderPath = "Data/SKSE/Plugins/CycleMovesets/Stances";
+        const bool exportFiles = Settings::exportPerFolderJson;
 
-        try {
-            // Garante que o diretório "Stances" existe
-            if (!std::filesystem::exists(stancesFolderPath)) {
-                std::filesystem::create_directories(stancesFolderPath);
+        if (exportFiles) {
+            try {
+                // Garante que o diretório "Stances" existe
+                if (!std::filesystem::exists(stancesFolderPath)) {
+                    std::filesystem::create_directories(stancesFolderPath);
+                }
+            } catch (const std::filesystem::filesystem_error& e) {
+                SKSE::log::error("Falha ao criar o diretório de stances: {}. Erro: {}", stancesFolderPath.string(),
+                                 e.what());
+                return;
             }
-        } catch (const std::filesystem::filesystem_error& e) {
-            SKSE::log::error("Falha ao criar o diretório de stances: {}. Erro: {}", stancesFolderPath.string(), e.what());
-            return;
         }
 
+        StateStore::Sections stanceSections;
         // Itera sobre cada categoria de arma
         for (const auto& pair : _categories) {
             const WeaponCategory& category = pair.second;
@@ -3127,6 +3752,8 @@ void AnimationManager::LoadCycleMovesets() {
             for (const auto& name : category.stanceNames) {
                 doc.PushBack(rapidjson::Value(name.c_str(), allocator), allocator);
             }
+            stanceSections.insert_or_assign("stances/" + category.name, StateStore::Encode(doc));
+            if (!exportFiles) continue;
 
             // Escreve o arquivo JSON específico para esta categoria
             std::ofstream ofs(categorySavePath);
@@ -3141,40 +3768,38 @@ void AnimationManager::LoadCycleMovesets() {
             ofs << buffer.GetString();
             ofs.close();
         }
+        StateStore::Get().ReplacePrefix("stances/", std::move(stanceSections));
 
-        SKSE::log::info("Nomes das stances salvos com sucesso em arquivos individuais.");
+        SKSE::log::info("Nomes das stances salvos com sucesso.");
     }
 
     void AnimationManager::LoadStanceNames() {
-        SKSE::log::info("Carregando nomes das stances de arquivos individuais por categoria...");
+        SKSE::log::info("Carregando nomes das stances...");
         const std::filesystem::path stancesFolderPath = "Data/SKSE/Plugins/CycleMovesets/Stances";
-
-        if (!std::filesystem::exists(stancesFolderPath)) {
-            SKSE::log::info("Diretório de nomes de stance não encontrado. Usando padrões.");
-            return;
-        }
+        const auto& store = StateStore::Get();
+        JsonReader reader;
 
         // Itera sobre cada categoria de arma para carregar seu respectivo arquivo
         for (auto& pair : _categories) {
             WeaponCategory& category = pair.second;
             std::filesystem::path categoryLoadPath = stancesFolderPath / (category.name + ".json");
 
-            if (!std::filesystem::exists(categoryLoadPath)) {
-                // Se o arquivo para esta categoria não existe, apenas pula para a próxima
-                continue;
-            }
+            // A seção do UserState.bin tem precedência; o arquivo solto só vale para estados antigos
+            if (auto stored = store.Find("stances/" + category.name)) {
+                reader.AssignEncoded(*stored);
+            } else {
+                if (!std::filesystem::exists(categoryLoadPath)) {
+                    // Se o arquivo para esta categoria não existe, apenas pula para a próxima
+                    continue;
+                }
 
-            std::ifstream ifs(categoryLoadPath);
-            if (!ifs) {
-                SKSE::log::error("Falha ao abrir {} para leitura!", categoryLoadPath.string());
-                continue;
+                if (!reader.Load(categoryLoadPath)) {
+                    SKSE::log::error("Falha ao abrir {} para leitura!", categoryLoadPath.string());
+                    continue;
+                }
             }
 
-            std::string jsonContent((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-            ifs.close();
-
-            rapidjson::Document doc;
-            doc.Parse(jsonContent.c_str());
+            const rapidjson::Document& doc = reader.ParseInsitu();
 
             if (doc.HasParseError() || !doc.IsArray()) {
                 SKSE::log::error("Erro no parse do JSON ou o arquivo não é um array para a categoria: {}", category.name);
@@ -3192,7 +3817,7 @@ void AnimationManager::LoadCycleMovesets() {
             }
         }
 
-        SKSE::log::info("Nomes de stance individuais carregados com sucesso.");
+        SKSE::log::info("Nomes de stance carregados com sucesso.");
     }
 
     void AnimationManager::DrawStanceEditorPopup() {
@@ -3285,7 +3910,7 @@ void AnimationManager::LoadCycleMovesets() {
         }
 
         SKSE::log::info("Iniciando salvamento do moveset do usuário: {}", movesetName);
-        const std::filesystem::path oarRootPath = "Data\\meshes\\actors\\character\\animations\\OpenAnimationReplacer";
+        const std::filesystem::path oarRootPath = oar_root_path;
         std::filesystem::path newMovesetPath = oarRootPath / movesetName;
 
         try {
@@ -3372,6 +3997,7 @@ void AnimationManager::LoadCycleMovesets() {
             }
         }
 
+        BuildKeywordExclusions();
         for (const auto& pair : uniqueSubmovesets) {
             const std::string& subName = pair.first;
             const SubmovesetSaveData& data = pair.second;
@@ -3402,11 +4028,12 @@ void AnimationManager::LoadCycleMovesets() {
                 for (const auto* instancePtr : data.instances) {
                     if (!instancePtr || !instancePtr->sourceDef) continue;
 
+                    const auto sourcePath = instancePtr->sourceDef->path.get();
                     std::string originalPathStr;
-                    if (instancePtr->sourceDef->path.filename() == "config.json") {
-                        originalPathStr = instancePtr->sourceDef->path.parent_path().string();
+                    if (sourcePath.filename() == "config.json") {
+                        originalPathStr = sourcePath.parent_path().string();
                     } else {
-                        originalPathStr = instancePtr->sourceDef->path.string();
+                        originalPathStr = sourcePath.string();
                     }
                     size_t pos = originalPathStr.find("Data\\");
                     if (pos != std::string::npos) {
@@ -3551,14 +4178,14 @@ void AnimationManager::LoadCycleMovesets() {
     }
 
 
-    void AnimationManager::ScanDarAnimations() {
+    void AnimationManager::ScanDarAnimations(WorkStealingPool* pool, ScanIndex* index, bool importCycleDar) {
         SKSE::log::info("[ScanDarAnimations] Iniciando a função de escaneamento DAR.");
         try {
             _darSubMovesets.clear();
+            _darRuleFiles.clear();
             SKSE::log::info("[ScanDarAnimations] Vetor _darSubMovesets foi limpo.");
 
-            const std::filesystem::path darRootPath =
-                "Data\\meshes\\actors\\character\\animations\\DynamicAnimationReplacer\\_CustomConditions";
+            const std::filesystem::path darRootPath = dar_root_path;
 
             // Convertendo para std::string para o log
             auto u8_darRootPath = darRootPath.u8string();
@@ -3568,75 +4195,51 @@ void AnimationManager::LoadCycleMovesets() {
             if (!std::filesystem::exists(darRootPath) || !std::filesystem::is_directory(darRootPath)) {
                 SKSE::log::warn("[ScanDarAnimations] A pasta raiz do DAR (_CustomConditions) não foi encontrada em '{}'.",
                                 std::string(u8_darRootPath.begin(), u8_darRootPath.end()));
-                RE::DebugNotification("Pasta do DAR (_CustomConditions) não encontrada.");
+                if (!pool) RE::DebugNotification("Pasta do DAR (_CustomConditions) não encontrada.");
                 return;
             }
 
             SKSE::log::info("[ScanDarAnimations] Pasta encontrada. Iniciando iteração pelas subpastas...");
-            int folderCount = 0;
-            for (const auto& entry : std::filesystem::directory_iterator(darRootPath)) {
-                folderCount++;
-
-                auto u8_entryPath = entry.path().u8string();
-                SKSE::log::info("[ScanDarAnimations] [LOOP {}] Verificando a entrada: '{}'", folderCount,
-                                std::string(u8_entryPath.begin(), u8_entryPath.end()));
-
-                if (entry.is_directory()) {
-                    SKSE::log::info("[ScanDarAnimations] [LOOP {}] É um diretório. Processando...", folderCount);
-
-                    SubAnimationDef subAnimDef;
-
-                    SKSE::log::info("[ScanDarAnimations] [LOOP {}] Extraindo nome da pasta...", folderCount);
-
-                    // ===================================================================
-                    // CORREÇÃO PRINCIPAL: Converter explicitamente std::u8string para std::string
-                    // ===================================================================
-                    auto u8_filename = entry.path().filename().u8string();
-                    subAnimDef.name = std::string(u8_filename.begin(), u8_filename.end());
-                    SKSE::log::info("[ScanDarAnimations] [LOOP {}] Nome extraído: '{}'", folderCount, subAnimDef.name);
-
-                    subAnimDef.path = entry.path();
-                    auto u8_subAnimPath = subAnimDef.path.u8string();
-                    SKSE::log::info("[ScanDarAnimations] [LOOP {}] Path definido como: '{}'", folderCount,
-                                    std::string(u8_subAnimPath.begin(), u8_subAnimPath.end()));
-
-                    SKSE::log::info("[ScanDarAnimations] [LOOP {}] Chamando ScanSubAnimationFolderForTags para '{}'...",
-                                    folderCount, subAnimDef.name);
-                    ScanSubAnimationFolderForTags(entry.path(), subAnimDef);
-                    SKSE::log::info(
-                        "[ScanDarAnimations] [LOOP {}] Retornou de ScanSubAnimationFolderForTags. A pasta tem animações: "
-                        "{}",
-                        folderCount, subAnimDef.hasAnimations);
-
-                    if (subAnimDef.hasAnimations) {
-                        SKSE::log::info("[ScanDarAnimations] [LOOP {}] O submoveset tem animações. Adicionando ao vetor...",
-                                        folderCount);
-                        _darSubMovesets.push_back(subAnimDef);
-                        SKSE::log::info("[ScanDarAnimations] [LOOP {}] Adicionado com sucesso: '{}'", folderCount,
-                                        subAnimDef.name);
-                    } else {
-                        SKSE::log::info(
-                            "[ScanDarAnimations] [LOOP {}] O submoveset '{}' não contém arquivos .hkx e será pulado.",
-                            folderCount, subAnimDef.name);
-                    }
+            // Um único walk da árvore traz as pastas de primeiro nível (os sub-movesets DAR) e os
+            // (User_)CycleMoveset.json ao lado de cada user.json, usados depois pelo LoadCycleMovesets.
+            LibraryWalker walker(WalkRoot::DAR, index, pool, false, importCycleDar);
+            for (const auto& folder : walker.Walk(darRootPath)) {
+                if (!folder.ruleFile.empty()) {
+                    _darRuleFiles.push_back(folder.ruleFile);
+                }
+                if (folder.depth != 1) continue;
+
+                SubAnimationDef subAnimDef;
+                auto u8_filename = folder.path.filename().u8string();
+                subAnimDef.name = std::string(u8_filename.begin(), u8_filename.end());
+                subAnimDef.path = folder.path;
+                folder.tags.ApplyTo(subAnimDef);
+
+                if (subAnimDef.hasAnimations) {
+                    _darSubMovesets.push_back(subAnimDef);
+                    SKSE::log::info("[ScanDarAnimations] Adicionado: '{}' (DPA A:{}, B:{}, L:{}, R:{}, CPA:{})",
+                                    subAnimDef.name.view(), subAnimDef.dpaTags.hasA, subAnimDef.dpaTags.hasB,
+                                    subAnimDef.dpaTags.hasL, subAnimDef.dpaTags.hasR, subAnimDef.hasCPA);
                 } else {
-                    SKSE::log::info("[ScanDarAnimations] [LOOP {}] A entrada não é um diretório. Pulando.", folderCount);
+                    SKSE::log::info("[ScanDarAnimations] O submoveset '{}' não contém arquivos .hkx e será pulado.",
+                                    subAnimDef.name.view());
                 }
             }
         } catch (const std::filesystem::filesystem_error& e) {
             SKSE::log::critical("[ScanDarAnimations] CRASH! ERRO DE FILESYSTEM DURANTE O SCAN: {}", e.what());
-            RE::DebugNotification("ERRO GRAVE ao ler pastas DAR! Verifique os logs.");
+            if (!pool) RE::DebugNotification("ERRO GRAVE ao ler pastas DAR! Verifique os logs.");
         } catch (const std::exception& e) {
             SKSE::log::critical("[ScanDarAnimations] CRASH! ERRO GERAL DURANTE O SCAN: {}", e.what());
-            RE::DebugNotification("ERRO GRAVE ao ler pastas DAR! Verifique os logs.");
+            if (!pool) RE::DebugNotification("ERRO GRAVE ao ler pastas DAR! Verifique os logs.");
         } catch (...) {
             SKSE::log::critical("[ScanDarAnimations] CRASH! ERRO DESCONHECIDO E NÃO IDENTIFICADO DURANTE O SCAN!");
-            RE::DebugNotification("ERRO GRAVE E DESCONHECIDO ao ler pastas DAR! Verifique os logs.");
+            if (!pool) RE::DebugNotification("ERRO GRAVE E DESCONHECIDO ao ler pastas DAR! Verifique os logs.");
         }
 
         SKSE::log::info("[ScanDarAnimations] Escaneamento finalizado. Total de {} submovesets carregados.",
                         _darSubMovesets.size());
-        if (!_darSubMovesets.empty()) {
+        // Com pool, estamos no scan de inicialização (thread de fundo, jogo ainda carregando): só log.
+        if (!pool && !_darSubMovesets.empty()) {
             RE::DebugNotification(std::format("{} Animações DAR carregadas.", _darSubMovesets.size()).c_str());
         }
     }
@@ -3666,7 +4269,8 @@ void AnimationManager::LoadCycleMovesets() {
 
                 for (size_t i = 0; i < _darSubMovesets.size(); ++i) {
                     const auto& darSubDef = _darSubMovesets[i];
-                    std::string name_lower = darSubDef.name;
+                    if (darSubDef.isMissing) continue;
+                    std::string name_lower = darSubDef.name.str();
                     std::transform(name_lower.begin(), name_lower.end(), name_lower.begin(), ::tolower);
 
                     if (filter_str.empty() || name_lower.find(filter_str) != std::string::npos) {
@@ -3680,7 +4284,7 @@ void AnimationManager::LoadCycleMovesets() {
                                          darSubDef.name.c_str());
                                 PopulateHkxFiles(newInstance);
                                 _stanceToAddTo->subMovesets.push_back(newInstance);
-                                SKSE::log::info("Adicionando animação DAR '{}' à stance.", darSubDef.name);
+                                SKSE::log::info("Adicionando animação DAR '{}' à stance.", darSubDef.name.view());
                             }
                         }
                         ImGui::SameLine();
@@ -3717,21 +4321,28 @@ void AnimationManager::LoadCycleMovesets() {
 
     void AnimationManager::SaveCustomCategories() {
         const std::filesystem::path categoriesPath = "Data/SKSE/Plugins/CycleMovesets/Categories";
+        const bool exportFiles = Settings::exportPerFolderJson;
 
         // 1. Garante que o diretório de salvamento existe
-        try {
-            if (!std::filesystem::exists(categoriesPath)) {
-                std::filesystem::create_directories(categoriesPath);
+        if (exportFiles) {
+            try {
+                if (!std::filesystem::exists(categoriesPath)) {
+                    std::filesystem::create_directories(categoriesPath);
+                }
+            } catch (const std::filesystem::filesystem_error& e) {
+                SKSE::log::error("Falha ao criar o diretório de categorias: {}. Erro: {}", categoriesPath.string(),
+                                 e.what());
+                return;
             }
-        } catch (const std::filesystem::filesystem_error& e) {
-            SKSE::log::error("Falha ao criar o diretório de categorias: {}. Erro: {}", categoriesPath.string(), e.what());
-            return;
         }
 
-        SKSE::log::info("Salvando categorias customizadas em arquivos individuais...");
+        SKSE::log::info("Salvando categorias customizadas...");
         std::set<std::filesystem::path> savedFilePaths;
+        StateStore::Sections categorySections;
+        rapidjson::Document names;
+        names.SetArray();
 
-        if (std::filesystem::exists(categoriesPath)) {
+        if (exportFiles && std::filesystem::exists(categoriesPath)) {
             for (const auto& entry : std::filesystem::directory_iterator(categoriesPath)) {
                 if (entry.is_regular_file() && entry.path().extension() == ".json") {
                     savedFilePaths.insert(entry.path());
@@ -3780,6 +4391,10 @@ void AnimationManager::LoadCycleMovesets() {
                     doc.AddMember("leftHandKeywords", leftKeywordsArray, allocator);
                 }
 
+                categorySections.insert_or_assign("categories/" + category.name, StateStore::Encode(doc));
+                names.PushBack(rapidjson::Value(category.name.c_str(), names.GetAllocator()), names.GetAllocator());
+                if (!exportFiles) continue;
+
                 // Define o caminho do arquivo e o salva
                 std::filesystem::path categoryFilePath = categoriesPath / (category.name + ".json");
                 std::ofstream ofs(categoryFilePath);
@@ -3795,6 +4410,12 @@ void AnimationManager::LoadCycleMovesets() {
                 }
             }
         }
+        // "categories" marca que o UserState.bin já é a fonte das categorias, mesmo sem nenhuma customizada
+        auto& store = StateStore::Get();
+        store.Put("categories", StateStore::Encode(names));
+        store.ReplacePrefix("categories/", std::move(categorySections));
+        if (!exportFiles) return;
+
         std::set<std::filesystem::path> currentCustomCategoryFiles;
         for (const auto& pair : _categories) {
             if (pair.second.isCustom) {
@@ -3812,12 +4433,14 @@ void AnimationManager::LoadCycleMovesets() {
 
     void AnimationManager::LoadCustomCategories() {
         const std::filesystem::path categoriesPath = "Data/SKSE/Plugins/CycleMovesets/Categories";
-        if (!std::filesystem::exists(categoriesPath)) {
+        const auto& store = StateStore::Get();
+        const bool fromStore = store.Find("categories").has_value();
+        if (!fromStore && !std::filesystem::exists(categoriesPath)) {
             SKSE::log::info("Diretório de categorias customizadas não encontrado. Pulando.");
             return;
         }
 
-        SKSE::log::info("Carregando categorias customizadas de arquivos individuais...");
+        SKSE::log::info("Carregando categorias customizadas...");
 
         std::map<std::string, const WeaponCategory*> baseCategories;
         for (const auto& pair : _categories) {
@@ -3826,27 +4449,13 @@ void AnimationManager::LoadCycleMovesets() {
             }
         }
 
-        // Itera sobre cada arquivo no diretório de categorias
-        for (const auto& entry : std::filesystem::directory_iterator(categoriesPath)) {
-            if (!entry.is_regular_file() || entry.path().extension() != ".json") {
-                continue;
-            }
-
-            std::ifstream ifs(entry.path());
-            if (!ifs) {
-                SKSE::log::error("Falha ao abrir o arquivo de categoria: {}", entry.path().string());
-                continue;
-            }
-
-            std::string jsonContent((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-            ifs.close();
-
-            rapidjson::Document doc;
-            doc.Parse(jsonContent.c_str());
+        JsonReader reader;
+        auto loadCategory = [&](const std::string& sourceLabel) {
+            const rapidjson::Document& doc = reader.ParseInsitu();
 
             if (doc.HasParseError() || !doc.IsObject()) {
-                SKSE::log::error("Erro no parse do JSON ou o arquivo não é um objeto para: {}", entry.path().string());
-                continue;
+                SKSE::log::error("Erro no parse do JSON ou o arquivo não é um objeto para: {}", sourceLabel);
+                return;
             }
 
             const rapidjson::Value& categoryObj = doc;  // O documento raiz é o próprio objeto
@@ -3857,8 +4466,8 @@ void AnimationManager::LoadCycleMovesets() {
                 !categoryObj.HasMember("isDualWield") || !categoryObj["isDualWield"].IsBool() ||
                 !categoryObj.HasMember("keywords") || !categoryObj["keywords"].IsArray()) {
                 SKSE::log::warn("Objeto de categoria customizada malformado ou com campos faltando em {}. Pulando.",
-                                entry.path().string());
-                continue;
+                                sourceLabel);
+                return;
             }
 
             std::string name = categoryObj["name"].GetString();
@@ -3867,7 +4476,7 @@ void AnimationManager::LoadCycleMovesets() {
             auto it = baseCategories.find(baseName);
             if (it == baseCategories.end()) {
                 SKSE::log::warn("Categoria base '{}' para '{}' não encontrada. Pulando.", baseName, name);
-                continue;
+                return;
             }
             const WeaponCategory* baseCat = it->second;
 
@@ -3892,7 +4501,7 @@ void AnimationManager::LoadCycleMovesets() {
                     !categoryObj["leftHandBaseCategoryName"].IsString() || !categoryObj.HasMember("leftHandKeywords") ||
                     !categoryObj["leftHandKeywords"].IsArray()) {
                     SKSE::log::warn("Categoria dual '{}' não tem campos de mão esquerda. Pulando.", name);
-                    continue;
+                    return;
                 }
                 std::string leftHandBaseName = categoryObj["leftHandBaseCategoryName"].GetString();
                 auto itLeft = baseCategories.find(leftHandBaseName);
@@ -3915,6 +4524,27 @@ void AnimationManager::LoadCycleMovesets() {
             }
 
             _categories[newCat.name] = newCat;
+        };
+
+        if (fromStore) {
+            store.ForEachPrefix("categories/", [&](const std::string& key, const std::string& payload) {
+                reader.AssignEncoded(payload);
+                loadCategory(key);
+            });
+            return;
+        }
+
+        // Itera sobre cada arquivo no diretório de categorias
+        for (const auto& entry : std::filesystem::directory_iterator(categoriesPath)) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".json") {
+                continue;
+            }
+
+            if (!reader.Load(entry.path())) {
+                SKSE::log::error("Falha ao abrir o arquivo de categoria: {}", entry.path().string());
+                continue;
+            }
+            loadCategory(entry.path().string());
         }
     }
 
@@ -4259,34 +4889,12 @@ void AnimationManager::LoadCycleMovesets() {
 
     void AnimationManager::AddShieldCategoryExclusions(rapidjson::Value& parentArray,
                                                        rapidjson::Document::AllocatorType& allocator) {
-        // 1. Coleta todas as keywords de categorias de escudo customizadas
-        std::vector<std::string> competingKeywords;
-        for (const auto& pair : _categories) {
-            const WeaponCategory& otherCategory = pair.second;
-            // A condição é: ser customizada, ser uma categoria de escudo, E ter keywords
-            if (otherCategory.isCustom && otherCategory.isShieldCategory && !otherCategory.keywords.empty()) {
-                competingKeywords.insert(competingKeywords.end(), otherCategory.keywords.begin(),
-                                         otherCategory.keywords.end());
-            }
-        }
-
-        if (competingKeywords.empty()) {
-            return;  // Nenhuma exclusão necessária
+        // O cache é montado por WriteConfigFiles e SaveUserMoveset antes de qualquer UpdateOrCreateJson
+        if (!_keywordExclusions) return;
+        const rapidjson::Value& fragment = _keywordExclusions->shieldFragment;
+        if (!fragment.IsNull()) {
+            parentArray.PushBack(rapidjson::Value(fragment, allocator), allocator);
         }
-
-        // 2. Cria um único bloco AND para conter todas as exclusões (NOT keyword1 AND NOT keyword2 ...)
-        rapidjson::Value exclusionAndBlock(rapidjson::kObjectType);
-        exclusionAndBlock.AddMember("condition", "AND", allocator);
-        exclusionAndBlock.AddMember("comment", "Exclude competing custom Shield + Weapon categories", allocator);
-        rapidjson::Value innerExclusionConditions(rapidjson::kArrayType);
-
-        for (const auto& keyword : competingKeywords) {
-            // Adiciona a condição 'IsEquippedHasKeyword' negada para a mão direita (onde a arma com keyword está)
-            AddKeywordCondition(innerExclusionConditions, keyword, false, true, allocator);
-        }
-
-        exclusionAndBlock.AddMember("Conditions", innerExclusionConditions, allocator);
-        parentArray.PushBack(exclusionAndBlock, allocator);
     }
 
     void AnimationManager::PopulateNpcList() {
@@ -4574,7 +5182,7 @@ void AnimationManager::DrawNpcSelectionModal() {
         if (!instance.sourceDef) return;
 
         // Garante que o caminho é um diretório
-        std::filesystem::path sourceDirectory = instance.sourceDef->path;
+        std::filesystem::path sourceDirectory = instance.sourceDef->path.get();
         if (std::filesystem::is_regular_file(sourceDirectory)) {
             sourceDirectory = sourceDirectory.parent_path();
         }
@@ -4906,16 +5514,17 @@ void AnimationManager::LoadGameDataForNpcRules() {
         SKSE::log::info("Teclas de movimento sincronizadas para o runtime.");
     }
 
+    SubmovesetId AnimationManager::LibraryIdOf(const SubAnimationInstance& instance) const {
+        if (instance.subMovesetId != kInvalidSubmoveset) return instance.subMovesetId;
+        return _library.IdOf(instance.sourceModIndex, instance.sourceSubAnimIndex);
+    }
+
     std::optional<std::pair<size_t, size_t>> AnimationManager::FindSubAnimationByPath(
         const std::filesystem::path& configPath) {
-        for (size_t modIdx = 0; modIdx < _allMods.size(); ++modIdx) {
-            const auto& mod = _allMods[modIdx];
-            for (size_t subIdx = 0; subIdx < mod.subAnimations.size(); ++subIdx) {
-                // Compara os caminhos canônicos para garantir consistência (ignora diferenças como / vs \)
-                if (std::filesystem::equivalent(mod.subAnimations[subIdx].path, configPath)) {
-                    return std::make_pair(modIdx, subIdx);
-                }
-            }
+        // Índice de caminhos normalizados montado no Sync da biblioteca: nenhuma chamada ao disco por entrada
+        const SubmovesetId id = _library.FindByPath(configPath);
+        if (id == kInvalidSubmoveset) {
+            return std::nullopt;  // Não encontrado
         }
-        return std::nullopt;  // Não encontrado
+        return std::make_pair(_library.ModIndexOf(id), _library.SubIndexOf(id));
     }
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "JsonReader.h"
+
+#include <Windows.h>
+#include "StateStore.h"
+
+namespace {
+    constexpr DWORD kMaxChunk = 1u << 30;
+
+    // L o arquivo inteiro num buffer j dimensionado, sem passar por iostream/istreambuf_iterator.
+    bool ReadWholeFile(const std::filesystem::path& path, std::string& out) {
+        // Qualquer falha deixa 'out' vazio: o texto do arquivo anterior nunca  reaproveitado
+        out.clear();
+        const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        bool ok = false;
+        LARGE_INTEGER size{};
+        if (GetFileSizeEx(file, &size)) {
+            out.resize(static_cast<std::size_t>(size.QuadPart));
+            std::size_t total = 0;
+            ok = true;
+            while (total < out.size()) {
+                const std::size_t remaining = out.size() - total;
+                const DWORD chunk = remaining > kMaxChunk ? kMaxChunk : static_cast<DWORD>(remaining);
+                DWORD read = 0;
+                if (!ReadFile(file, out.data() + total, chunk, &read, nullptr) || read == 0) {
+                    ok = false;
+                    break;
+                }
+                total += read;
+            }
+        }
+        CloseHandle(file);
+        if (!ok) out.clear();
+        return ok;
+    }
+}
+
+JsonReader::JsonReader() : _arena(kArenaSize), _pool(_arena.data(), _arena.size()), _doc(&_pool) {}
+
+void JsonReader::Reset() {
+    // O pool no libera valores individualmente: zerar a raiz e limpar o pool descarta o documento
+    // anterior de uma vez e mantm s o arena para o prximo.
+    _doc.SetNull();
+    _pool.Clear();
+    _decoded = false;
+}
+
+bool JsonReader::Load(const std::filesystem::path& path) {
+    Reset();
+    return ReadWholeFile(path, _text);
+}
+
+void JsonReader::Assign(std::string text) {
+    Reset();
+    _text = std::move(text);
+}
+
+void JsonReader::AssignEncoded(std::string_view bytes) {
+    Reset();
+    _text.clear();
+    // Falha deixa o Document nulo: os loaders j tratam "no  array/objeto" como arquivo invlido
+    StateStore::Decode(bytes, _doc);
+    _decoded = true;
+}
+
+rapidjson::Document& JsonReader::ParseInsitu() {
+    if (!_decoded) _doc.ParseInsitu(_text.data());
+    return _doc;
+}
+
+rapidjson::Document& JsonReader::Parse() {
+    if (!_decoded) _doc.Parse(_text.data(), _text.size());
+    return _doc;
+}
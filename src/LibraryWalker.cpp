@@ -0,0 +1,182 @@
+#include "LibraryWalker.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include "FileClassifier.h"
+#include "ManagedManifest.h"
+#include "ScanIndex.h"
+#include "ThreadPool.h"
+
+namespace {
+    std::string ToUtf8(const std::filesystem::path& p) {
+        const auto u8 = p.u8string();
+        return std::string(u8.begin(), u8.end());
+    }
+
+    std::filesystem::path FromUtf8(const std::string& s) { return std::filesystem::path(std::u8string(s.begin(), s.end())); }
+
+    // Lista a pasta uma nica vez, classificando arquivos e guardando as subpastas.
+    FolderListing ListFolder(const std::filesystem::path& folder) {
+        FolderListing listing;
+        FsCounters::listings.fetch_add(1, std::memory_order_relaxed);
+
+        std::error_code ec;
+        std::filesystem::directory_iterator it(folder, ec);
+        if (ec) {
+            SKSE::log::warn("[LibraryWalker] Falha ao listar {}: {}", folder.string(), ec.message());
+            return listing;
+        }
+
+        std::size_t entryCount = 0;
+        for (const std::filesystem::directory_iterator end; it != end; it.increment(ec)) {
+            if (ec) break;
+            ++entryCount;
+            const auto& entry = *it;
+            if (entry.is_directory(ec) && !entry.is_symlink(ec)) {
+                listing.childDirs.push_back(ToUtf8(entry.path().filename()));
+                continue;
+            }
+            if (!entry.is_regular_file(ec)) continue;
+
+            // Classifica direto sobre o nome nativo, sem copiar nem converter para minsculas
+            const std::basic_string_view<std::filesystem::path::value_type> native = entry.path().native();
+            const auto separator = native.find_last_of(std::filesystem::path::preferred_separator);
+            const auto filename = separator == native.npos ? native : native.substr(separator + 1);
+            const auto tags = FileClassifier::Classify(filename);
+            if (tags & FileClassifier::kConfigJson) {
+                listing.flags |= FolderFlags::kConfig;
+            } else if (tags & FileClassifier::kUserCycleMovesetJson) {
+                listing.flags |= FolderFlags::kUserCycleMoveset;
+            } else if (tags & FileClassifier::kCycleMovesetJson) {
+                listing.flags |= FolderFlags::kCycleMoveset;
+            } else if (tags & FileClassifier::kCycleDarJson) {
+                listing.flags |= FolderFlags::kCycleDar;
+            } else if (tags & FileClassifier::kDarUserJson) {
+                listing.flags |= FolderFlags::kDarUserJson;
+            } else if (tags & FileClassifier::kHkx) {
+                listing.tags.AddFile(tags);
+            }
+        }
+        FsCounters::entries.fetch_add(entryCount, std::memory_order_relaxed);
+        return listing;
+    }
+}
+
+void HkxTags::AddFile(std::uint32_t fileTags) {
+    hasAnimations = true;
+
+    // Lgica de contagem de ataques
+    if (fileTags & FileClassifier::kAttack) attackCount++;
+    if (fileTags & FileClassifier::kPowerAttack) powerAttackCount++;
+    if (fileTags & FileClassifier::kIdle) hasIdle = true;
+
+    // Lgica de verificao de DPA e CPA
+    if (fileTags & FileClassifier::kDpaA) dpaTags.hasA = true;
+    if (fileTags & FileClassifier::kDpaB) dpaTags.hasB = true;
+    if (fileTags & FileClassifier::kDpaL) dpaTags.hasL = true;
+    if (fileTags & FileClassifier::kDpaR) dpaTags.hasR = true;
+    if (fileTags & FileClassifier::kCpa) hasCPA = true;
+}
+
+void HkxTags::ApplyTo(SubAnimationDef& def) const {
+    def.attackCount = attackCount;
+    def.powerAttackCount = powerAttackCount;
+    def.hasIdle = hasIdle;
+    def.hasAnimations = hasAnimations;
+    def.dpaTags = dpaTags;
+    def.hasCPA = hasCPA;
+}
+
+FsCounters::Snapshot FsCounters::Take() {
+    return {listings.load(std::memory_order_relaxed), entries.load(std::memory_order_relaxed),
+            stats.load(std::memory_order_relaxed), fileReads.load(std::memory_order_relaxed)};
+}
+
+void FsCounters::Reset() {
+    listings = 0;
+    entries = 0;
+    stats = 0;
+    fileReads = 0;
+}
+
+void FsCounters::Log(std::string_view phase) {
+    SKSE::log::info("[FsCounters] {}: {} pastas listadas, {} entradas, {} stats, {} arquivos lidos.", phase,
+                    listings.load(), entries.load(), stats.load(), fileReads.load());
+}
+
+LibraryWalker::LibraryWalker(WalkRoot kind, ScanIndex* index, WorkStealingPool* pool, bool readManagedMarker,
+                             bool importCycleDar)
+    : _kind(kind),
+      _index(index),
+      _pool(pool),
+      _readManagedMarker(readManagedMarker),
+      _importCycleDar(importCycleDar) {}
+
+std::vector<WalkedFolder> LibraryWalker::Walk(const std::filesystem::path& root, int rootDepth) const {
+    std::vector<WalkedFolder> result;
+    WalkInto(root, rootDepth, result);
+    return result;
+}
+
+bool LibraryWalker::ShouldProcessCycleDar(const WalkedFolder& folder) const {
+    if (!_importCycleDar || !folder.Has(FolderFlags::kCycleDar)) return false;
+    // Mesmas pastas que antes passavam por ScanSubAnimationFolderForTags:
+    // sub-movesets do OAR (com config.json) e pastas de primeiro nvel do DAR.
+    return _kind == WalkRoot::OAR ? (folder.depth > 0 && folder.Has(FolderFlags::kConfig)) : folder.depth == 1;
+}
+
+void LibraryWalker::WalkInto(const std::filesystem::path& folder, int depth, std::vector<WalkedFolder>& out) const {
+    WalkedFolder walked;
+    walked.path = folder;
+    walked.depth = depth;
+
+    FolderListing listing;
+    if (!_index || !_index->TryGetFolder(folder, listing)) {
+        listing = ListFolder(folder);
+        walked.flags = listing.flags;
+        if (ShouldProcessCycleDar(walked) && ProcessCycleDarFile(folder / "CycleDar.json")) {
+            // O CycleDar copiou/renomeou .hkx: a listagem anterior ficou desatualizada.
+            listing = ListFolder(folder);
+        }
+        if (_index) {
+            // O carimbo  tirado depois do CycleDar, para a prxima sesso j pegar a pasta convertida.
+            listing.stamp = FolderStamp::Of(folder, (listing.flags & FolderFlags::kCycleDar) != 0);
+            _index->PutFolder(folder, listing);
+        }
+    }
+    walked.flags = listing.flags;
+    walked.tags = listing.tags;
+
+    // Mesma precedncia do LoadCycleMovesets: User_CycleMoveset.json, se existir, substitui o padro.
+    const std::uint8_t ruleTrigger = _kind == WalkRoot::OAR ? FolderFlags::kConfig : FolderFlags::kDarUserJson;
+    if (walked.Has(ruleTrigger)) {
+        if (walked.Has(FolderFlags::kUserCycleMoveset)) {
+            walked.ruleFile = folder / "User_CycleMoveset.json";
+        } else if (walked.Has(FolderFlags::kCycleMoveset)) {
+            walked.ruleFile = folder / "CycleMoveset.json";
+        }
+    }
+
+    if (_readManagedMarker && depth > 0 && walked.Has(FolderFlags::kConfig)) {
+        walked.hasManagedMarker = ManagedManifest::FileContainsMarker(folder / "config.json");
+    }
+
+    out.push_back(std::move(walked));
+
+    const auto& children = listing.childDirs;
+    if (!_pool || children.size() < 2) {
+        for (const auto& child : children) {
+            WalkInto(folder / FromUtf8(child), depth + 1, out);
+        }
+        return;
+    }
+
+    std::vector<std::vector<WalkedFolder>> parts(children.size());
+    _pool->ParallelFor(children.size(),
+                       [&](std::size_t i) { WalkInto(folder / FromUtf8(children[i]), depth + 1, parts[i]); });
+    for (auto& part : parts) {
+        std::move(part.begin(), part.end(), std::back_inserter(out));
+    }
+}
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <fstream>
+#include "JsonReader.h"
 #include "MCP.h"
 #include "SKSE/SKSE.h"
 #include "rapidjson/error/en.h" 
@@ -45,13 +46,9 @@ bool LocalizationManager::LoadLanguage(const std::string& languageName) {
     // 1. Carregar o ingls como fallback, se ainda no foi carregado
     if (!_englishLoaded) {
         std::filesystem::path englishPath = "Data/SKSE/Plugins/CycleMovesets/Language/English.json";
-        std::ifstream englishFile(englishPath);
-        if (englishFile.is_open()) {
-            std::string jsonContent((std::istreambuf_iterator<char>(englishFile)), std::istreambuf_iterator<char>());
-            englishFile.close();
-
-            rapidjson::Document doc;
-            doc.Parse(jsonContent.c_str());
+        JsonReader reader;
+        if (reader.Load(englishPath)) {
+            const rapidjson::Document& doc = reader.ParseInsitu();
             if (!doc.HasParseError() && doc.IsObject()) {
                 for (auto it = doc.MemberBegin(); it != doc.MemberEnd(); ++it) {
                     if (it->name.IsString() && it->value.IsString()) {
@@ -82,18 +79,13 @@ bool LocalizationManager::LoadLanguage(const std::string& languageName) {
 
     // 4. Carregar o arquivo de idioma solicitado
     std::filesystem::path langPath = "Data/SKSE/Plugins/CycleMovesets/Language/" + languageName + ".json";
-    std::ifstream langFile(langPath);
-
-    if (!langFile.is_open()) {
+    JsonReader reader;
+    if (!reader.Load(langPath)) {
         SKSE::log::error("Arquivo de idioma no encontrado: {}", langPath.string());
         return false;
     }
 
-    std::string jsonContent((std::istreambuf_iterator<char>(langFile)), std::istreambuf_iterator<char>());
-    langFile.close();
-
-    rapidjson::Document doc;
-    doc.Parse(jsonContent.c_str());
+    const rapidjson::Document& doc = reader.ParseInsitu();
 
     if (doc.HasParseError() || !doc.IsObject()) {
         // --- CORRIGIDO ---
@@ -0,0 +1,274 @@
+#include "ManagedManifest.h"
+
+#include <Windows.h>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <vector>
+#include "BinaryIO.h"
+#include "LibraryWalker.h"
+#include "ThreadPool.h"
+
+namespace {
+    using namespace BinaryIO;
+
+    constexpr std::uint32_t kManifestMagic = 0x464D4D43;  // "CMMF"
+
+    // Arquivo mapeado somente para leitura (RAII).
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::filesystem::path& path) {
+            _file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (_file == INVALID_HANDLE_VALUE) return;
+
+            LARGE_INTEGER size{};
+            if (!GetFileSizeEx(_file, &size)) return;
+            _size = static_cast<std::size_t>(size.QuadPart);
+            _opened = true;
+            if (_size == 0) return;  // No d para mapear um arquivo vazio
+
+            _mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!_mapping) {
+                _opened = false;
+                return;
+            }
+            _data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+            if (!_data) _opened = false;
+        }
+
+        ~MappedFile() {
+            if (_data) UnmapViewOfFile(_data);
+            if (_mapping) CloseHandle(_mapping);
+            if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool IsOpen() const { return _opened; }
+        std::string_view View() const { return _data ? std::string_view(_data, _size) : std::string_view(); }
+
+    private:
+        HANDLE _file = INVALID_HANDLE_VALUE;
+        HANDLE _mapping = nullptr;
+        const char* _data = nullptr;
+        std::size_t _size = 0;
+        bool _opened = false;
+    };
+
+    // memchr pelo primeiro caractere (vetorizado pela CRT) e memcmp s nos candidatos.
+    bool ContainsMarker(std::string_view haystack) {
+        const auto marker = ManagedManifest::kMarker;
+        if (haystack.size() < marker.size()) return false;
+        const char* cursor = haystack.data();
+        const char* const last = haystack.data() + haystack.size() - marker.size();
+        while (cursor <= last) {
+            const void* hit = std::memchr(cursor, marker.front(), static_cast<std::size_t>(last - cursor) + 1);
+            if (!hit) return false;
+            const char* candidate = static_cast<const char*>(hit);
+            if (std::memcmp(candidate + 1, marker.data() + 1, marker.size() - 1) == 0) return true;
+            cursor = candidate + 1;
+        }
+        return false;
+    }
+
+    std::uint64_t Fnv1a64(std::string_view bytes) {
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        for (const unsigned char c : bytes) {
+            hash ^= c;
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    bool StatFile(const std::filesystem::path& path, std::int64_t& mtime, std::uint64_t& size) {
+        FsCounters::stats.fetch_add(2, std::memory_order_relaxed);
+        std::error_code ec;
+        const auto time = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        const auto bytes = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+        mtime = static_cast<std::int64_t>(time.time_since_epoch().count());
+        size = static_cast<std::uint64_t>(bytes);
+        return true;
+    }
+
+    std::filesystem::path FromKey(const std::string& key) {
+        return std::filesystem::path(std::u8string(key.begin(), key.end()));
+    }
+}
+
+std::string ManagedManifest::KeyOf(const std::filesystem::path& p) {
+    auto key = p.lexically_normal().u8string();
+    return std::string(key.begin(), key.end());
+}
+
+bool ManagedManifest::FileContainsMarker(const std::filesystem::path& configPath) {
+    FsCounters::fileReads.fetch_add(1, std::memory_order_relaxed);
+    MappedFile file(configPath);
+    return file.IsOpen() && ContainsMarker(file.View());
+}
+
+bool ManagedManifest::Inspect(const std::filesystem::path& configPath, Entry& entry, const Entry* previous) {
+    if (!StatFile(configPath, entry.mtime, entry.size)) return false;
+    FsCounters::fileReads.fetch_add(1, std::memory_order_relaxed);
+    MappedFile file(configPath);
+    if (!file.IsOpen()) return false;
+    entry.hash = Fnv1a64(file.View());
+    // Mesmo contedo (s o mtime mudou): o que foi registrado continua valendo, sem procurar o marcador.
+    entry.managed = (previous && previous->hash == entry.hash) ? previous->managed : ContainsMarker(file.View());
+    return true;
+}
+
+bool ManagedManifest::Load(const std::filesystem::path& manifestPath) {
+    _entries.clear();
+    _loaded = false;
+
+    std::ifstream in(manifestPath, std::ios::binary);
+    if (!in) {
+        SKSE::log::info("[ManagedManifest] Nenhum manifesto em {}. Os config.json sero verificados um a um.",
+                        manifestPath.string());
+        return false;
+    }
+
+    std::uint32_t magic = 0, version = 0, count = 0;
+    if (!ReadPod(in, magic) || !ReadPod(in, version) || magic != kManifestMagic || version != kVersion ||
+        !ReadPod(in, count)) {
+        SKSE::log::warn("[ManagedManifest] Manifesto {} invlido ou de outra verso.", manifestPath.string());
+        return false;
+    }
+
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::string key;
+        Entry entry;
+        std::uint8_t managed = 0;
+        if (!ReadString(in, key) || !ReadPod(in, entry.mtime) || !ReadPod(in, entry.size) || !ReadPod(in, entry.hash) ||
+            !ReadPod(in, managed)) {
+            SKSE::log::warn("[ManagedManifest] Manifesto {} truncado.", manifestPath.string());
+            _entries.clear();
+            return false;
+        }
+        entry.managed = managed != 0;
+        _entries.insert_or_assign(std::move(key), entry);
+    }
+
+    _loaded = true;
+    SKSE::log::info("[ManagedManifest] Manifesto carregado com {} arquivos.", _entries.size());
+    return true;
+}
+
+bool ManagedManifest::Save(const std::filesystem::path& manifestPath) const {
+    std::error_code ec;
+    std::filesystem::create_directories(manifestPath.parent_path(), ec);
+
+    auto tempPath = manifestPath;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            SKSE::log::error("[ManagedManifest] Falha ao abrir {} para escrita.", tempPath.string());
+            return false;
+        }
+        WritePod(out, kManifestMagic);
+        WritePod(out, kVersion);
+        WritePod(out, static_cast<std::uint32_t>(_entries.size()));
+        for (const auto& [key, entry] : _entries) {
+            WriteString(out, key);
+            WritePod(out, entry.mtime);
+            WritePod(out, entry.size);
+            WritePod(out, entry.hash);
+            WritePod(out, static_cast<std::uint8_t>(entry.managed ? 1 : 0));
+        }
+        if (!out) {
+            SKSE::log::error("[ManagedManifest] Falha ao gravar {}.", tempPath.string());
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, manifestPath, ec);
+    if (ec) {
+        SKSE::log::error("[ManagedManifest] Falha ao substituir {}: {}", manifestPath.string(), ec.message());
+        return false;
+    }
+    return true;
+}
+
+void ManagedManifest::Record(const std::filesystem::path& configPath) {
+    Entry entry;
+    if (Inspect(configPath, entry)) {
+        _entries.insert_or_assign(KeyOf(configPath), entry);
+    } else {
+        _entries.erase(KeyOf(configPath));
+    }
+}
+
+void ManagedManifest::RecordAll(const std::vector<std::filesystem::path>& configPaths, WorkStealingPool* pool) {
+    std::vector<Entry> inspected(configPaths.size());
+    std::vector<std::uint8_t> ok(configPaths.size(), 0);
+    auto inspect = [&](std::size_t i) { ok[i] = Inspect(configPaths[i], inspected[i]) ? 1 : 0; };
+    if (pool) {
+        pool->ParallelFor(configPaths.size(), inspect);
+    } else {
+        for (std::size_t i = 0; i < configPaths.size(); ++i) inspect(i);
+    }
+
+    for (std::size_t i = 0; i < configPaths.size(); ++i) {
+        if (ok[i]) {
+            _entries.insert_or_assign(KeyOf(configPaths[i]), inspected[i]);
+        } else {
+            _entries.erase(KeyOf(configPaths[i]));
+        }
+    }
+}
+
+std::unordered_set<std::string> ManagedManifest::CollectManaged(WorkStealingPool* pool) {
+    std::vector<std::pair<const std::string, Entry>*> entries;
+    entries.reserve(_entries.size());
+    for (auto& pair : _entries) entries.push_back(&pair);
+
+    // 0 = confivel (mtime/tamanho iguais), 1 = reverificado, 2 = sumiu
+    std::vector<std::uint8_t> outcome(entries.size(), 0);
+    auto verify = [&](std::size_t i) {
+        auto& [key, entry] = *entries[i];
+        const auto path = FromKey(key);
+        std::int64_t mtime = 0;
+        std::uint64_t size = 0;
+        if (!StatFile(path, mtime, size)) {
+            outcome[i] = 2;
+            return;
+        }
+        if (mtime == entry.mtime && size == entry.size) return;
+
+        Entry current;
+        if (!Inspect(path, current, &entry)) {
+            outcome[i] = 2;
+            return;
+        }
+        entry = current;
+        outcome[i] = 1;
+    };
+    if (pool) {
+        pool->ParallelFor(entries.size(), verify);
+    } else {
+        for (std::size_t i = 0; i < entries.size(); ++i) verify(i);
+    }
+
+    std::unordered_set<std::string> managed;
+    std::size_t reverified = 0, missing = 0;
+    std::vector<std::string> toErase;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (outcome[i] == 2) {
+            ++missing;
+            toErase.push_back(entries[i]->first);
+            continue;
+        }
+        if (outcome[i] == 1) ++reverified;
+        if (entries[i]->second.managed) managed.insert(entries[i]->first);
+    }
+    for (const auto& key : toErase) _entries.erase(key);
+
+    SKSE::log::info("[ManagedManifest] {} arquivos gerenciados; {} reverificados, {} removidos do manifesto.",
+                    managed.size(), reverified, missing);
+    return managed;
+}
@@ -1,4 +1,6 @@
 #include "Events.h"
+#include "JsonReader.h"
+#include "StateStore.h"
 #include "SKSEMCP/SKSEMenuFramework.hpp"
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
@@ -15,17 +17,16 @@ void AnimationManager::LoadUserMovesets() {
     _userMovesets.clear();
     const std::filesystem::path userMovesetsPath = "Data/SKSE/Plugins/CycleMovesets/UserMovesets.json";
 
-    if (!std::filesystem::exists(userMovesetsPath)) {
+    JsonReader reader;
+    if (auto stored = StateStore::Get().Find("user_movesets")) {
+        reader.AssignEncoded(*stored);
+    } else if (!reader.Load(userMovesetsPath)) {
         SKSE::log::info("Arquivo UserMovesets.json no encontrado. Nenhum moveset de usurio carregado.");
         return;
     }
 
-    std::ifstream fileStream(userMovesetsPath);
-    std::string jsonContent((std::istreambuf_iterator<char>(fileStream)), std::istreambuf_iterator<char>());
-    fileStream.close();
-
-    rapidjson::Document doc;
-    if (doc.Parse(jsonContent.c_str()).HasParseError() || !doc.IsArray()) {
+    const rapidjson::Document& doc = reader.ParseInsitu();
+    if (doc.HasParseError() || !doc.IsArray()) {
         SKSE::log::error("Erro ao fazer parse do UserMovesets.json.");
         return;
     }
@@ -51,6 +52,7 @@ void AnimationManager::LoadUserMovesets() {
                     auto subAnimIdxOpt = FindSubAnimIndexByName(*modIdxOpt, subInstance.sourceSubName);
                     if (subAnimIdxOpt) {
                         subInstance.sourceSubAnimIndex = *subAnimIdxOpt;  // Preenche o ndice da sub-animao
+                        subInstance.subMovesetId = _library.IdOf(*modIdxOpt, *subAnimIdxOpt);
                     } else {
                         SKSE::log::warn("Sub-animao '{}' do moveset de usurio no encontrada no mod '{}'. Pulando.",
                                         subInstance.sourceSubName, subInstance.sourceModName);
@@ -71,7 +73,6 @@ void AnimationManager::LoadUserMovesets() {
 
 void AnimationManager::SaveUserMovesets() {
     const std::filesystem::path userMovesetsPath = "Data/SKSE/Plugins/CycleMovesets/UserMovesets.json";
-    std::filesystem::create_directories(userMovesetsPath.parent_path());
 
     rapidjson::Document doc;
     doc.SetArray();
@@ -91,7 +92,7 @@ void AnimationManager::SaveUserMovesets() {
             // Salva os nomes e o caminho, conforme seu novo formato
             subAnimObj.AddMember("sourceModName", rapidjson::Value(originMod.name.c_str(), allocator), allocator);
             subAnimObj.AddMember("sourceSubName", rapidjson::Value(originSubAnim.name.c_str(), allocator), allocator);
-            subAnimObj.AddMember("sourceConfigPath", rapidjson::Value(originSubAnim.path.string().c_str(), allocator),
+            subAnimObj.AddMember("sourceConfigPath", rapidjson::Value(originSubAnim.path.get().string().c_str(), allocator),
                                  allocator);
 
             // Nota: As checkboxes como pLeft no so salvas AQUI. Elas so salvas no _Cycle.json
@@ -103,6 +104,15 @@ void AnimationManager::SaveUserMovesets() {
         doc.PushBack(movesetObj, allocator);
     }
 
+    auto& store = StateStore::Get();
+    store.Put("user_movesets", StateStore::Encode(doc));
+    store.Save();
+    if (!Settings::exportPerFolderJson) {
+        SKSE::log::info("Movesets de usurio salvos com sucesso.");
+        return;
+    }
+
+    std::filesystem::create_directories(userMovesetsPath.parent_path());
     FILE* fp;
     fopen_s(&fp, userMovesetsPath.string().c_str(), "wb");
     if (!fp) {
@@ -229,30 +239,100 @@ void AnimationManager::DrawUserMovesetManager() {
     }
 }
 
+std::optional<SubmovesetId> AnimationManager::ResolveUserSource(const SubAnimationInstance& subInstance) const {
+    // Os nomes so a referncia persistida; o id guardado s vale para entradas sem nome
+    SubmovesetId id = kInvalidSubmoveset;
+    if (auto modIdx = _library.FindMod(subInstance.sourceModName)) {
+        if (auto subIdx = _library.FindSub(*modIdx, subInstance.sourceSubName)) {
+            id = _library.IdOf(*modIdx, *subIdx);
+        }
+    } else if (subInstance.sourceModName.empty() && subInstance.subMovesetId < _library.Size()) {
+        id = subInstance.subMovesetId;
+    }
+    if (id == kInvalidSubmoveset || (_library.CapsOf(id) & SubmovesetCaps::kMissing)) return std::nullopt;
+    return id;
+}
+
 void AnimationManager::RebuildUserMovesetLibrary() {
     SKSE::log::info("Reconstruindo a biblioteca de movesets do usurio em tempo real...");
 
-    // Remove todos os mods que foram previamente adicionados como "Usurio" para evitar duplicatas
-    _allMods.erase(std::remove_if(_allMods.begin(), _allMods.end(),
-                                  [](const AnimationModDef& mod) { return mod.author == "Usurio"; }),
-                   _allMods.end());
+    // Cada moveset fica no mesmo slot de _allMods entre rebuilds: os mods escaneados (e os que um
+    // rescan acrescentou depois) no mudam de ndice, e s os movesets alterados so remontados.
+    auto previous = std::move(_userModSlots);
+    _userModSlots.clear();
+    size_t rebuilt = 0;
 
-    // Readiciona os movesets da lista _userMovesets (que est atualizada em memria)
     for (const auto& userMoveset : _userMovesets) {
-        AnimationModDef modDef;
-        modDef.name = userMoveset.name;
-        modDef.author = "Usurio";
+        std::string key = userMoveset.name;
+        for (int copy = 2; _userModSlots.contains(key); ++copy) {
+            key = std::format("{}#{}", userMoveset.name, copy);  // Nomes repetidos ganham slots prprios
+        }
 
+        std::vector<SubmovesetId> sources;
+        std::vector<std::uint32_t> revisions;
+        sources.reserve(userMoveset.subAnimations.size());
+        revisions.reserve(userMoveset.subAnimations.size());
         for (const auto& subInstance : userMoveset.subAnimations) {
-            auto modIdxOpt = FindModIndexByName(subInstance.sourceModName);
-            if (modIdxOpt) {
-                auto subAnimIdxOpt = FindSubAnimIndexByName(*modIdxOpt, subInstance.sourceSubName);
-                if (subAnimIdxOpt) {
-                    modDef.subAnimations.push_back(_allMods[*modIdxOpt].subAnimations[*subAnimIdxOpt]);
-                }
+            if (auto id = ResolveUserSource(subInstance)) {
+                sources.push_back(*id);
+                revisions.push_back(_library.RevisionOf(*id));
+            }
+        }
+
+        UserModSlot slot;
+        if (auto it = previous.find(key); it != previous.end()) {
+            slot = std::move(it->second);
+            previous.erase(it);
+            if (slot.sources == sources && slot.revisions == revisions) {
+                _userModSlots.emplace(std::move(key), std::move(slot));
+                continue;
             }
+        } else if (!_freeUserModSlots.empty()) {
+            slot.modIndex = _freeUserModSlots.back();
+            _freeUserModSlots.pop_back();
+        } else {
+            slot.modIndex = _allMods.size();
+            _allMods.emplace_back();
         }
-        _allMods.push_back(modDef);
+
+        // SubAnimationDef s guarda ids internados: a cpia  uma viso barata da definio de origem
+        std::vector<SubAnimationDef> subAnimations;
+        subAnimations.reserve(sources.size());
+        for (const SubmovesetId id : sources) {
+            subAnimations.push_back(_allMods[_library.ModIndexOf(id)].subAnimations[_library.SubIndexOf(id)]);
+        }
+        AnimationModDef& modDef = _allMods[slot.modIndex];
+        modDef.name = userMoveset.name;
+        modDef.author = "Usurio";
+        modDef.path.clear();
+        modDef.subAnimations = std::move(subAnimations);
+        slot.sources = std::move(sources);
+        slot.revisions = std::move(revisions);
+        _library.SyncMod(slot.modIndex, modDef);
+        _userModSlots.emplace(std::move(key), std::move(slot));
+        ++rebuilt;
+    }
+
+    // Movesets apagados: o slot fica vazio (sem nome, fora dos ndices) at ser reaproveitado
+    for (auto& [key, slot] : previous) {
+        AnimationModDef& modDef = _allMods[slot.modIndex];
+        modDef.name.clear();
+        modDef.subAnimations.clear();
+        _library.SyncMod(slot.modIndex, modDef);
+        _freeUserModSlots.push_back(slot.modIndex);
     }
-    SKSE::log::info("Biblioteca reconstruda. Total de {} mods.", _allMods.size());
+    // Slots livres no fim de _allMods saem de vez
+    std::sort(_freeUserModSlots.begin(), _freeUserModSlots.end());
+    size_t modCount = _allMods.size();
+    while (!_freeUserModSlots.empty() && _freeUserModSlots.back() + 1 == modCount) {
+        _freeUserModSlots.pop_back();
+        --modCount;
+    }
+    if (modCount < _allMods.size()) {
+        _allMods.erase(_allMods.begin() + modCount, _allMods.end());
+        _library.Truncate(modCount);
+    }
+
+    SKSE::log::info("Biblioteca reconstruda: {} movesets de usurio remontados, {} removidos. Total de {} mods.",
+                    rebuilt, previous.size(), _allMods.size());
 }
\ No newline at end of file
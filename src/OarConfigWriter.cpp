@@ -0,0 +1,251 @@
+#include "OarConfigWriter.h"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "ManagedManifest.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/reader.h"
+#include "rapidjson/writer.h"
+
+namespace {
+    enum class EventKind { kScalar, kKey, kOpenObject, kOpenArray, kClose };
+
+    // Recebe os eventos do Reader sobre o config.json atual e os repassa ao Writer de sada.
+    // _depth conta os containers abertos: a raiz  o nvel 0, os membros dela o nvel 1 e os
+    // elementos de "conditions" o nvel 2.
+    template <class Writer>
+    class ConfigFilter {
+    public:
+        ConfigFilter(Writer& out, std::string_view name, int priority, const rapidjson::Value* managedBlock,
+                     const OarConfigWriter::Options& options)
+            : _out(out),
+              _name(name),
+              _priority(priority),
+              _managedBlock(managedBlock),
+              _options(options),
+              _elementWriter(_element) {}
+
+        bool Null() {
+            return Event(EventKind::kScalar, [](auto& w) { return w.Null(); });
+        }
+        bool Bool(bool b) {
+            return Event(EventKind::kScalar, [b](auto& w) { return w.Bool(b); });
+        }
+        bool Int(int i) {
+            return Event(EventKind::kScalar, [i](auto& w) { return w.Int(i); });
+        }
+        bool Uint(unsigned u) {
+            return Event(EventKind::kScalar, [u](auto& w) { return w.Uint(u); });
+        }
+        bool Int64(std::int64_t i) {
+            return Event(EventKind::kScalar, [i](auto& w) { return w.Int64(i); });
+        }
+        bool Uint64(std::uint64_t u) {
+            return Event(EventKind::kScalar, [u](auto& w) { return w.Uint64(u); });
+        }
+        bool Double(double d) {
+            return Event(EventKind::kScalar, [d](auto& w) { return w.Double(d); });
+        }
+        bool RawNumber(const char* str, rapidjson::SizeType length, bool copy) {
+            return Event(EventKind::kScalar, [=](auto& w) { return w.RawNumber(str, length, copy); });
+        }
+        bool String(const char* str, rapidjson::SizeType length, bool copy) {
+            if (_inConditions && _depth == 3 && _commentKey && std::string_view(str, length) == ManagedManifest::kMarker) {
+                _elementManaged = true;
+            }
+            return Event(EventKind::kScalar, [=](auto& w) { return w.String(str, length, copy); });
+        }
+        bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+            if (_depth == 1) return TopLevelKey(str, length, copy);
+            if (_inConditions && _depth == 3) _commentKey = std::string_view(str, length) == "comment";
+            return Event(EventKind::kKey, [=](auto& w) { return w.Key(str, length, copy); });
+        }
+        bool StartObject() {
+            return Event(EventKind::kOpenObject, [](auto& w) { return w.StartObject(); });
+        }
+        bool EndObject(rapidjson::SizeType count) {
+            return Event(EventKind::kClose, [count](auto& w) { return w.EndObject(count); });
+        }
+        bool StartArray() {
+            return Event(EventKind::kOpenArray, [](auto& w) { return w.StartArray(); });
+        }
+        bool EndArray(rapidjson::SizeType count) {
+            return Event(EventKind::kClose, [count](auto& w) { return w.EndArray(count); });
+        }
+
+        // Arquivo novo (ou ilegvel): s os trs membros do manager
+        bool WriteFresh() { return _out.StartObject() && AppendMissing() && _out.EndObject(); }
+
+    private:
+        template <class Emit>
+        bool Event(EventKind kind, Emit&& emit) {
+            const bool opens = kind == EventKind::kOpenObject || kind == EventKind::kOpenArray;
+            if (kind == EventKind::kClose) --_depth;
+            const int level = _depth;
+            if (opens) ++_depth;
+
+            // Valor antigo de "name", "priority" ou "conditions", j substitudo na sada
+            if (_skipDepth >= 0) {
+                if (level == _skipDepth && !opens) _skipDepth = -1;
+                return true;
+            }
+
+            if (_awaitConditions) {
+                _awaitConditions = false;
+                if (kind == EventKind::kOpenArray) {
+                    _inConditions = true;
+                    return true;
+                }
+                if (opens) _skipDepth = level;
+                return EmitConditions();
+            }
+
+            if (_inConditions) {
+                if (level == 1) {
+                    _inConditions = false;
+                    return EmitConditions();
+                }
+                if (level == 2 && kind != EventKind::kClose) {
+                    _element.Clear();
+                    _elementWriter.Reset(_element);
+                    _elementManaged = false;
+                    _commentKey = false;
+                }
+                emit(_elementWriter);
+                if (level == 3 && kind != EventKind::kKey) _commentKey = false;
+                if (level == 2 && !opens && !_elementManaged) {
+                    _kept.emplace_back(_element.GetString(), _element.GetSize());
+                }
+                return true;
+            }
+
+            if (level == 0) {
+                if (kind == EventKind::kOpenObject) return emit(_out);
+                if (kind == EventKind::kClose) return AppendMissing() && emit(_out);
+                return false;  // A raiz no  um objeto
+            }
+            return emit(_out);
+        }
+
+        bool TopLevelKey(const char* str, rapidjson::SizeType length, bool copy) {
+            const std::string_view key(str, length);
+            if (key == "name") {
+                _hasName = true;
+                _skipDepth = 1;
+                return _out.Key(str, length, copy) &&
+                       _out.String(_name.data(), static_cast<rapidjson::SizeType>(_name.size()));
+            }
+            if (key == "priority") {
+                _hasPriority = true;
+                _skipDepth = 1;
+                return _out.Key(str, length, copy) && _out.Int(_priority);
+            }
+            if (key == "conditions") {
+                _hasConditions = true;
+                if (!_out.Key(str, length, copy)) return false;
+                if (_options.preserveConditions) {
+                    _awaitConditions = true;
+                    return true;
+                }
+                _skipDepth = 1;
+                return EmitConditions();
+            }
+            return _out.Key(str, length, copy);
+        }
+
+        bool AppendMissing() {
+            if (!_hasName) {
+                _hasName = true;
+                if (!_out.Key("name") || !_out.String(_name.data(), static_cast<rapidjson::SizeType>(_name.size()))) {
+                    return false;
+                }
+            }
+            if (!_hasPriority) {
+                _hasPriority = true;
+                if (!_out.Key("priority") || !_out.Int(_priority)) return false;
+            }
+            if (!_hasConditions) {
+                _hasConditions = true;
+                if (!_out.Key("conditions") || !EmitConditions()) return false;
+            }
+            return true;
+        }
+
+        bool EmitConditions() {
+            _out.StartArray();
+            if (_options.preserveConditions && !_kept.empty()) {
+                _out.StartObject();
+                _out.Key("condition");
+                _out.String("OR");
+                _out.Key("comment");
+                _out.String("Old Conditions");
+                _out.Key("Conditions");
+                _out.StartArray();
+                // Cada condio guardada volta pelo Reader; preciso total porque o Writer gravou o
+                // double mais curto que representa o valor lido
+                for (const auto& text : _kept) {
+                    rapidjson::StringStream stream(text.c_str());
+                    rapidjson::Reader reader;
+                    if (!reader.Parse<rapidjson::kParseFullPrecisionFlag>(stream, _out)) return false;
+                }
+                _out.EndArray();
+                _out.EndObject();
+            }
+            if (_managedBlock && !_managedBlock->Accept(_out)) return false;
+            return _out.EndArray();
+        }
+
+        Writer& _out;
+        std::string_view _name;
+        int _priority;
+        const rapidjson::Value* _managedBlock;
+        const OarConfigWriter::Options& _options;
+
+        int _depth = 0;
+        int _skipDepth = -1;
+        bool _hasName = false;
+        bool _hasPriority = false;
+        bool _hasConditions = false;
+        bool _awaitConditions = false;
+        bool _inConditions = false;
+
+        // Elemento de "conditions" em andamento: s d para saber se  o bloco gerenciado no fim dele
+        rapidjson::StringBuffer _element;
+        rapidjson::Writer<rapidjson::StringBuffer> _elementWriter;
+        bool _elementManaged = false;
+        bool _commentKey = false;
+        std::vector<std::string> _kept;
+    };
+
+    template <class Writer>
+    bool WriteWith(const std::string& original, std::string_view name, int priority,
+                   const rapidjson::Value* managedBlock, const OarConfigWriter::Options& options,
+                   rapidjson::StringBuffer& out) {
+        if (!original.empty()) {
+            Writer writer(out);
+            ConfigFilter<Writer> filter(writer, name, priority, managedBlock, options);
+            rapidjson::StringStream stream(original.c_str());
+            rapidjson::Reader reader;
+            if (reader.Parse(stream, filter) && writer.IsComplete()) return true;
+            out.Clear();
+        }
+        Writer writer(out);
+        ConfigFilter<Writer> filter(writer, name, priority, managedBlock, options);
+        filter.WriteFresh();
+        return original.empty();
+    }
+}
+
+namespace OarConfigWriter {
+    bool Write(const std::string& original, std::string_view name, int priority, const rapidjson::Value* managedBlock,
+               const Options& options, rapidjson::StringBuffer& out) {
+        out.Clear();
+        if (options.compact) {
+            return WriteWith<rapidjson::Writer<rapidjson::StringBuffer>>(original, name, priority, managedBlock,
+                                                                         options, out);
+        }
+        return WriteWith<rapidjson::PrettyWriter<rapidjson::StringBuffer>>(original, name, priority, managedBlock,
+                                                                           options, out);
+    }
+}
@@ -0,0 +1,86 @@
+#include "PlaylistTable.h"
+
+namespace {
+    bool IsParent(const SubAnimationInstance& subInst) {
+        return !(subInst.pFront || subInst.pBack || subInst.pLeft || subInst.pRight || subInst.pFrontRight ||
+                 subInst.pFrontLeft || subInst.pBackRight || subInst.pBackLeft || subInst.pRandom || subInst.pDodge);
+    }
+
+    // Mesma ordem do directionalState (ndice 0 = pai, sem flag)
+    std::array<bool, PlaylistTable::kDirections> DirectionsOf(const SubAnimationInstance& subInst) {
+        return {false,         subInst.pFront,    subInst.pFrontRight, subInst.pRight,    subInst.pBackRight,
+                subInst.pBack, subInst.pBackLeft, subInst.pLeft,       subInst.pFrontLeft};
+    }
+}
+
+void PlaylistTable::Build(const std::map<std::string, WeaponCategory>& categories,
+                          const std::vector<AnimationModDef>& mods, const SubmovesetTable& library,
+                          const IdResolver& resolveId) {
+    _categoryIds.clear();
+    _stances.clear();
+    _entries.clear();
+
+    auto nameOf = [&](const SubAnimationInstance& subInst) -> std::string_view {
+        if (subInst.editedName[0] != '\0') return PooledString(subInst.editedName.data()).view();
+        if (subInst.sourceModIndex >= mods.size()) return {};
+        const auto& subAnimations = mods[subInst.sourceModIndex].subAnimations;
+        if (subInst.sourceSubAnimIndex >= subAnimations.size()) return {};
+        return subAnimations[subInst.sourceSubAnimIndex].name.view();
+    };
+
+    for (const auto& [key, category] : categories) {
+        const auto categoryId = static_cast<std::uint32_t>(_stances.size());
+        _categoryIds.emplace(key, categoryId);
+        auto& ranges = _stances.emplace_back();
+
+        for (int stance = 0; stance < 4; ++stance) {
+            ranges[stance].first = static_cast<std::uint32_t>(_entries.size());
+            // Direes j preenchidas por um filho do pai atual: vale o primeiro, como na busca antiga
+            std::uint32_t filled = 0;
+            for (const auto& modInst : category.instances[stance].modInstances) {
+                if (!modInst.isSelected) continue;
+                for (const auto& subInst : modInst.subAnimationInstances) {
+                    if (!subInst.isSelected) continue;
+                    const SubmovesetId id = resolveId(subInst);
+                    if (!library.HasAnimations(id)) continue;
+
+                    if (IsParent(subInst)) {
+                        auto& entry = _entries.emplace_back();
+                        entry.names.fill(nameOf(subInst));
+                        entry.tags = library.TagsOf(id);
+                        filled = 0;
+                        continue;
+                    }
+                    // Filho antes de qualquer pai da stance no pertence a ningum
+                    if (_entries.size() == ranges[stance].first) continue;
+                    auto& entry = _entries.back();
+                    const auto directions = DirectionsOf(subInst);
+                    for (int dir = 1; dir < kDirections; ++dir) {
+                        if (!directions[dir] || (filled & (1u << dir))) continue;
+                        entry.names[dir] = nameOf(subInst);
+                        filled |= 1u << dir;
+                    }
+                }
+            }
+            ranges[stance].count = static_cast<std::uint32_t>(_entries.size()) - ranges[stance].first;
+        }
+    }
+}
+
+std::optional<std::uint32_t> PlaylistTable::CategoryIdOf(const std::string& name) const {
+    const auto it = _categoryIds.find(name);
+    if (it == _categoryIds.end()) return std::nullopt;
+    return it->second;
+}
+
+const PlaylistTable::Entry* PlaylistTable::At(std::uint32_t categoryId, int stanceIndex, int movesetIndex) const {
+    if (categoryId >= _stances.size() || stanceIndex < 0 || stanceIndex >= 4 || movesetIndex <= 0) return nullptr;
+    const Range& range = _stances[categoryId][stanceIndex];
+    if (static_cast<std::uint32_t>(movesetIndex) > range.count) return nullptr;
+    return &_entries[range.first + movesetIndex - 1];
+}
+
+int PlaylistTable::CountOf(std::uint32_t categoryId, int stanceIndex) const {
+    if (categoryId >= _stances.size() || stanceIndex < 0 || stanceIndex >= 4) return 0;
+    return static_cast<int>(_stances[categoryId][stanceIndex].count);
+}
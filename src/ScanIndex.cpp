@@ -0,0 +1,246 @@
+#include "ScanIndex.h"
+
+#include <fstream>
+#include <system_error>
+#include "BinaryIO.h"
+
+namespace {
+    using namespace BinaryIO;
+
+    constexpr std::uint32_t kScanIndexMagic = 0x49534D43;  // "CMSI"
+
+    std::int64_t FileTimeOf(const std::filesystem::path& p) {
+        FsCounters::stats.fetch_add(1, std::memory_order_relaxed);
+        std::error_code ec;
+        const auto time = std::filesystem::last_write_time(p, ec);
+        return ec ? 0 : static_cast<std::int64_t>(time.time_since_epoch().count());
+    }
+
+    std::uint64_t FileSizeOf(const std::filesystem::path& p) {
+        FsCounters::stats.fetch_add(1, std::memory_order_relaxed);
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(p, ec);
+        return ec ? 0 : static_cast<std::uint64_t>(size);
+    }
+
+    // Os campos bool das tags vo empacotados em um nico byte.
+    std::uint8_t PackTags(const HkxTags& tags) {
+        std::uint8_t flags = 0;
+        if (tags.hasIdle) flags |= 1 << 0;
+        if (tags.hasAnimations) flags |= 1 << 1;
+        if (tags.dpaTags.hasA) flags |= 1 << 2;
+        if (tags.dpaTags.hasB) flags |= 1 << 3;
+        if (tags.dpaTags.hasL) flags |= 1 << 4;
+        if (tags.dpaTags.hasR) flags |= 1 << 5;
+        if (tags.hasCPA) flags |= 1 << 6;
+        return flags;
+    }
+
+    void UnpackTags(std::uint8_t flags, HkxTags& tags) {
+        tags.hasIdle = flags & (1 << 0);
+        tags.hasAnimations = flags & (1 << 1);
+        tags.dpaTags.hasA = flags & (1 << 2);
+        tags.dpaTags.hasB = flags & (1 << 3);
+        tags.dpaTags.hasL = flags & (1 << 4);
+        tags.dpaTags.hasR = flags & (1 << 5);
+        tags.hasCPA = flags & (1 << 6);
+    }
+}
+
+FolderStamp FolderStamp::Of(const std::filesystem::path& folder, bool withCycleDar) {
+    FolderStamp stamp;
+    stamp.folderTime = FileTimeOf(folder);
+    if (withCycleDar) {
+        const auto cycleDarPath = folder / "CycleDar.json";
+        stamp.cycleDarTime = FileTimeOf(cycleDarPath);
+        stamp.cycleDarSize = FileSizeOf(cycleDarPath);
+    }
+    return stamp;
+}
+
+std::string ScanIndex::KeyOf(const std::filesystem::path& p) {
+    auto key = p.lexically_normal().u8string();
+    return std::string(key.begin(), key.end());
+}
+
+bool ScanIndex::Load(const std::filesystem::path& indexPath) {
+    _loadedMods.clear();
+    _loadedFolders.clear();
+
+    std::ifstream in(indexPath, std::ios::binary);
+    if (!in) {
+        SKSE::log::info("[ScanIndex] Nenhum ndice encontrado em {}. Scan completo.", indexPath.string());
+        return false;
+    }
+
+    std::uint32_t magic = 0, version = 0, modCount = 0, folderCount = 0;
+    if (!ReadPod(in, magic) || !ReadPod(in, version) || magic != kScanIndexMagic || version != kVersion) {
+        SKSE::log::warn("[ScanIndex] ndice {} invlido ou de outra verso. Scan completo.", indexPath.string());
+        return false;
+    }
+
+    bool ok = ReadPod(in, modCount);
+    for (std::uint32_t i = 0; ok && i < modCount; ++i) {
+        std::string key;
+        ModHeaderEntry entry;
+        ok = ReadString(in, key) && ReadPod(in, entry.configTime) && ReadPod(in, entry.configSize) &&
+             ReadString(in, entry.name) && ReadString(in, entry.author);
+        if (ok) _loadedMods.emplace(std::move(key), std::move(entry));
+    }
+
+    ok = ok && ReadPod(in, folderCount);
+    for (std::uint32_t i = 0; ok && i < folderCount; ++i) {
+        std::string key;
+        FolderListing entry;
+        std::int32_t attackCount = 0, powerAttackCount = 0;
+        std::uint8_t tagFlags = 0;
+        std::uint32_t childCount = 0;
+        ok = ReadString(in, key) && ReadPod(in, entry.stamp.folderTime) && ReadPod(in, entry.stamp.cycleDarTime) &&
+             ReadPod(in, entry.stamp.cycleDarSize) && ReadPod(in, entry.flags) && ReadPod(in, attackCount) &&
+             ReadPod(in, powerAttackCount) && ReadPod(in, tagFlags) && ReadPod(in, childCount);
+        for (std::uint32_t c = 0; ok && c < childCount; ++c) {
+            ok = ReadString(in, entry.childDirs.emplace_back());
+        }
+        if (ok) {
+            entry.tags.attackCount = attackCount;
+            entry.tags.powerAttackCount = powerAttackCount;
+            UnpackTags(tagFlags, entry.tags);
+            _loadedFolders.emplace(std::move(key), std::move(entry));
+        }
+    }
+
+    if (!ok) {
+        SKSE::log::warn("[ScanIndex] ndice {} truncado. Scan completo.", indexPath.string());
+        _loadedMods.clear();
+        _loadedFolders.clear();
+        return false;
+    }
+
+    SKSE::log::info("[ScanIndex] ndice carregado: {} mods, {} pastas.", _loadedMods.size(), _loadedFolders.size());
+    return true;
+}
+
+bool ScanIndex::Save(const std::filesystem::path& indexPath) const {
+    std::lock_guard lock(_mutex);
+
+    std::error_code ec;
+    std::filesystem::create_directories(indexPath.parent_path(), ec);
+
+    // Grava em um arquivo temporrio e renomeia, para no deixar um ndice pela metade.
+    auto tempPath = indexPath;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            SKSE::log::error("[ScanIndex] Falha ao abrir {} para escrita.", tempPath.string());
+            return false;
+        }
+
+        WritePod(out, kScanIndexMagic);
+        WritePod(out, kVersion);
+
+        WritePod(out, static_cast<std::uint32_t>(_currentMods.size()));
+        for (const auto& [key, entry] : _currentMods) {
+            WriteString(out, key);
+            WritePod(out, entry.configTime);
+            WritePod(out, entry.configSize);
+            WriteString(out, entry.name);
+            WriteString(out, entry.author);
+        }
+
+        WritePod(out, static_cast<std::uint32_t>(_currentFolders.size()));
+        for (const auto& [key, entry] : _currentFolders) {
+            WriteString(out, key);
+            WritePod(out, entry.stamp.folderTime);
+            WritePod(out, entry.stamp.cycleDarTime);
+            WritePod(out, entry.stamp.cycleDarSize);
+            WritePod(out, entry.flags);
+            WritePod(out, static_cast<std::int32_t>(entry.tags.attackCount));
+            WritePod(out, static_cast<std::int32_t>(entry.tags.powerAttackCount));
+            WritePod(out, PackTags(entry.tags));
+            WritePod(out, static_cast<std::uint32_t>(entry.childDirs.size()));
+            for (const auto& child : entry.childDirs) {
+                WriteString(out, child);
+            }
+        }
+
+        if (!out) {
+            SKSE::log::error("[ScanIndex] Falha ao gravar {}.", tempPath.string());
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, indexPath, ec);
+    if (ec) {
+        SKSE::log::error("[ScanIndex] Falha ao substituir {}: {}", indexPath.string(), ec.message());
+        return false;
+    }
+    return true;
+}
+
+bool ScanIndex::TryGetModHeader(const std::filesystem::path& configPath, std::string& name, std::string& author) {
+    const auto key = KeyOf(configPath);
+    const auto it = _loadedMods.find(key);
+    if (it == _loadedMods.end() || it->second.configTime != FileTimeOf(configPath) ||
+        it->second.configSize != FileSizeOf(configPath)) {
+        return false;
+    }
+    name = it->second.name;
+    author = it->second.author;
+
+    std::lock_guard lock(_mutex);
+    _currentMods.insert_or_assign(key, it->second);
+    return true;
+}
+
+void ScanIndex::PutModHeader(const std::filesystem::path& configPath, const std::string& name,
+                             const std::string& author) {
+    ModHeaderEntry entry{FileTimeOf(configPath), FileSizeOf(configPath), name, author};
+    std::lock_guard lock(_mutex);
+    _currentMods.insert_or_assign(KeyOf(configPath), std::move(entry));
+}
+
+bool ScanIndex::TryGetFolder(const std::filesystem::path& folder, FolderListing& out) {
+    const auto key = KeyOf(folder);
+    const auto it = _loadedFolders.find(key);
+    if (it == _loadedFolders.end() ||
+        !(it->second.stamp == FolderStamp::Of(folder, (it->second.flags & FolderFlags::kCycleDar) != 0))) {
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    out = it->second;
+    _hits.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard lock(_mutex);
+    _currentFolders.insert_or_assign(key, it->second);
+    return true;
+}
+
+void ScanIndex::PutFolder(const std::filesystem::path& folder, const FolderListing& listing) {
+    std::lock_guard lock(_mutex);
+    _currentFolders.insert_or_assign(KeyOf(folder), listing);
+}
+
+std::vector<std::filesystem::path> ScanIndex::LoadedFoldersWith(std::uint8_t flags) const {
+    std::vector<std::filesystem::path> folders;
+    for (const auto& [key, entry] : _loadedFolders) {
+        if ((entry.flags & flags) == flags) {
+            folders.emplace_back(std::u8string(key.begin(), key.end()));
+        }
+    }
+    return folders;
+}
+
+bool ScanIndex::HasLoadedFolder(const std::filesystem::path& folder) const {
+    return _loadedFolders.contains(KeyOf(folder));
+}
+
+void ScanIndex::AdoptCurrent() {
+    std::lock_guard lock(_mutex);
+    for (const auto& [key, entry] : _currentMods) {
+        _loadedMods.insert_or_assign(key, entry);
+    }
+    for (const auto& [key, entry] : _currentFolders) {
+        _loadedFolders.insert_or_assign(key, entry);
+    }
+}
@@ -0,0 +1,405 @@
+#include "StateStore.h"
+
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <spanstream>
+#include <sstream>
+#include <system_error>
+#include "BinaryIO.h"
+#include "ManagedManifest.h"
+
+namespace {
+    using namespace BinaryIO;
+
+    constexpr const char* user_state_path = "Data/SKSE/Plugins/CycleMovesets/UserState.bin";
+    constexpr std::uint32_t kStateMagic = 0x53554D43;  // "CMUS"
+
+    std::uint64_t Fnv1a64(std::string_view bytes) {
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        for (const unsigned char c : bytes) {
+            hash ^= c;
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    // Codificao das sees: tag de 1 byte por valor; inteiros em varint (zigzag para os com
+    // sinal), strings e contagens de array/objeto com tamanho em varint.
+    enum Tag : std::uint8_t { kNull, kFalse, kTrue, kInt, kUint, kDouble, kString, kArray, kObject };
+    constexpr int kMaxDepth = 256;
+
+    void PutVarint(std::string& out, std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    bool GetVarint(std::string_view& in, std::uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && !in.empty(); shift += 7) {
+            const auto byte = static_cast<unsigned char>(in.front());
+            in.remove_prefix(1);
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    void PutString(std::string& out, const char* data, std::size_t size) {
+        PutVarint(out, size);
+        out.append(data, size);
+    }
+
+    bool GetString(std::string_view& in, std::string_view& value) {
+        std::uint64_t size = 0;
+        if (!GetVarint(in, size) || size > in.size()) return false;
+        value = in.substr(0, static_cast<std::size_t>(size));
+        in.remove_prefix(static_cast<std::size_t>(size));
+        return true;
+    }
+
+    void EncodeValue(const rapidjson::Value& value, std::string& out) {
+        switch (value.GetType()) {
+            case rapidjson::kNullType:
+                out.push_back(kNull);
+                break;
+            case rapidjson::kFalseType:
+                out.push_back(kFalse);
+                break;
+            case rapidjson::kTrueType:
+                out.push_back(kTrue);
+                break;
+            case rapidjson::kNumberType:
+                if (value.IsInt64()) {
+                    const std::int64_t i = value.GetInt64();
+                    out.push_back(kInt);
+                    PutVarint(out, (static_cast<std::uint64_t>(i) << 1) ^ static_cast<std::uint64_t>(i >> 63));
+                } else if (value.IsUint64()) {
+                    out.push_back(kUint);
+                    PutVarint(out, value.GetUint64());
+                } else {
+                    const double d = value.GetDouble();
+                    out.push_back(kDouble);
+                    out.append(reinterpret_cast<const char*>(&d), sizeof(d));
+                }
+                break;
+            case rapidjson::kStringType:
+                out.push_back(kString);
+                PutString(out, value.GetString(), value.GetStringLength());
+                break;
+            case rapidjson::kArrayType:
+                out.push_back(kArray);
+                PutVarint(out, value.Size());
+                for (const auto& element : value.GetArray()) EncodeValue(element, out);
+                break;
+            case rapidjson::kObjectType:
+                out.push_back(kObject);
+                PutVarint(out, value.MemberCount());
+                for (const auto& member : value.GetObject()) {
+                    PutString(out, member.name.GetString(), member.name.GetStringLength());
+                    EncodeValue(member.value, out);
+                }
+                break;
+        }
+    }
+
+    bool DecodeValue(std::string_view& in, rapidjson::Value& out, rapidjson::Document::AllocatorType& allocator,
+                     int depth) {
+        if (in.empty() || depth > kMaxDepth) return false;
+        const auto tag = static_cast<std::uint8_t>(in.front());
+        in.remove_prefix(1);
+        std::uint64_t number = 0;
+        std::string_view text;
+        switch (tag) {
+            case kNull:
+                out.SetNull();
+                return true;
+            case kFalse:
+            case kTrue:
+                out.SetBool(tag == kTrue);
+                return true;
+            case kInt:
+                if (!GetVarint(in, number)) return false;
+                out.SetInt64(static_cast<std::int64_t>(number >> 1) ^ -static_cast<std::int64_t>(number & 1));
+                return true;
+            case kUint:
+                if (!GetVarint(in, number)) return false;
+                out.SetUint64(number);
+                return true;
+            case kDouble: {
+                double d = 0;
+                if (in.size() < sizeof(d)) return false;
+                std::memcpy(&d, in.data(), sizeof(d));
+                in.remove_prefix(sizeof(d));
+                out.SetDouble(d);
+                return true;
+            }
+            case kString:
+                if (!GetString(in, text)) return false;
+                out.SetString(text.data(), static_cast<rapidjson::SizeType>(text.size()), allocator);
+                return true;
+            case kArray: {
+                // Cada elemento ocupa ao menos 1 byte: uma contagem maior que o resto  corrupo
+                if (!GetVarint(in, number) || number > in.size()) return false;
+                out.SetArray();
+                out.Reserve(static_cast<rapidjson::SizeType>(number), allocator);
+                for (std::uint64_t i = 0; i < number; ++i) {
+                    rapidjson::Value element;
+                    if (!DecodeValue(in, element, allocator, depth + 1)) return false;
+                    out.PushBack(element, allocator);
+                }
+                return true;
+            }
+            case kObject: {
+                if (!GetVarint(in, number) || number > in.size()) return false;
+                out.SetObject();
+                for (std::uint64_t i = 0; i < number; ++i) {
+                    rapidjson::Value value;
+                    if (!GetString(in, text) || !DecodeValue(in, value, allocator, depth + 1)) return false;
+                    rapidjson::Value name(text.data(), static_cast<rapidjson::SizeType>(text.size()), allocator);
+                    out.AddMember(name, value, allocator);
+                }
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+}
+
+StateStore& StateStore::Get() {
+    static StateStore store;
+    static std::once_flag loaded;
+    std::call_once(loaded, [] { store.Load(user_state_path); });
+    return store;
+}
+
+bool StateStore::Load(const std::filesystem::path& path) {
+    _path = path;
+    _sections.clear();
+    _dirty = false;
+    _saveBlocked = false;
+
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) {
+            SKSE::log::info("[StateStore] Nenhum estado consolidado em {}. Usando os arquivos por pasta.",
+                            path.string());
+            return false;
+        }
+        bytes.resize(static_cast<std::size_t>(in.tellg()));
+        in.seekg(0);
+        if (!in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+            SKSE::log::error("[StateStore] Falha ao ler {}. Ele no ser sobrescrito nesta sesso.", path.string());
+            _saveBlocked = true;
+            return false;
+        }
+    }
+
+    // Arquivo existente mas ilegvel: sai do caminho antes que o prximo Save grave por cima dele
+    // s com as sees desta sesso. O .bak guarda o estado antigo para recuperao manual.
+    auto reject = [&](std::string_view reason) {
+        auto backupPath = path;
+        backupPath += ".bak";
+        std::error_code ec;
+        std::filesystem::rename(path, backupPath, ec);
+        if (ec) {
+            SKSE::log::error("[StateStore] {} {}. Falha ao mov-lo para {} ({}); ele no ser sobrescrito nesta "
+                             "sesso.",
+                             path.string(), reason, backupPath.string(), ec.message());
+            _saveBlocked = true;
+        } else {
+            SKSE::log::error("[StateStore] {} {}. Movido para {}; o estado do usurio comea vazio.", path.string(),
+                             reason, backupPath.string());
+        }
+        return false;
+    };
+
+    constexpr std::size_t kChecksumSize = sizeof(std::uint64_t);
+    if (bytes.size() < kChecksumSize) {
+        return reject("truncado");
+    }
+    const std::string_view body(bytes.data(), bytes.size() - kChecksumSize);
+    std::uint64_t checksum = 0;
+    std::memcpy(&checksum, bytes.data() + body.size(), kChecksumSize);
+    if (checksum != Fnv1a64(body)) {
+        return reject("com checksum que no confere");
+    }
+
+    std::ispanstream in(std::span<const char>(body.data(), body.size()));
+    std::uint32_t magic = 0, version = 0, count = 0;
+    if (!ReadPod(in, magic) || !ReadPod(in, version) || magic != kStateMagic || (version != 1 && version != kVersion) ||
+        !ReadPod(in, count)) {
+        return reject("invlido ou de outra verso");
+    }
+
+    // A verso 1 guardava JSON em texto e nenhuma data: as sees viram binrio e ficam com a data do
+    // prprio UserState.bin, para que s arquivos soltos mais novos que ele sejam importados.
+    std::int64_t legacyStamp = 0;
+    if (version == 1) {
+        std::error_code ec;
+        legacyStamp = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    }
+
+    decltype(_sections) sections;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::string key;
+        Section section;
+        if (!ReadString(in, key) || !ReadString(in, section.payload) ||
+            (version == kVersion && !ReadPod(in, section.stamp))) {
+            return reject("truncado");
+        }
+        if (version == 1) {
+            rapidjson::Document doc;
+            doc.Parse(section.payload.data(), section.payload.size());
+            if (doc.HasParseError()) {
+                SKSE::log::warn("[StateStore] Seo '{}' mal formada na verso antiga. Ignorando a seo.", key);
+                continue;
+            }
+            section.payload = Encode(doc);
+            section.stamp = legacyStamp;
+        }
+        sections.insert_or_assign(std::move(key), std::move(section));
+    }
+
+    _sections = std::move(sections);
+    _dirty = version != kVersion;
+    SKSE::log::info("[StateStore] Estado carregado: {} sees, {} bytes.", _sections.size(), bytes.size());
+    return true;
+}
+
+bool StateStore::Save() {
+    std::scoped_lock lock(_lock);
+    if (!_dirty) return true;
+    if (_saveBlocked) {
+        SKSE::log::error("[StateStore] {} no pde ser lido no incio da sesso; gravao recusada.", _path.string());
+        return false;
+    }
+
+    std::ostringstream out(std::ios::binary);
+    WritePod(out, kStateMagic);
+    WritePod(out, kVersion);
+    WritePod(out, static_cast<std::uint32_t>(_sections.size()));
+    for (const auto& [key, section] : _sections) {
+        WriteString(out, key);
+        WriteString(out, section.payload);
+        WritePod(out, section.stamp);
+    }
+    const std::string body = std::move(out).str();
+    const std::uint64_t checksum = Fnv1a64(body);
+
+    std::error_code ec;
+    std::filesystem::create_directories(_path.parent_path(), ec);
+    auto tempPath = _path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            SKSE::log::error("[StateStore] Falha ao abrir {} para escrita.", tempPath.string());
+            return false;
+        }
+        file.write(body.data(), static_cast<std::streamsize>(body.size()));
+        WritePod(file, checksum);
+        if (!file) {
+            SKSE::log::error("[StateStore] Falha ao gravar {}.", tempPath.string());
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, _path, ec);
+    if (ec) {
+        SKSE::log::error("[StateStore] Falha ao substituir {}: {}", _path.string(), ec.message());
+        return false;
+    }
+    _dirty = false;
+    SKSE::log::info("[StateStore] Estado salvo: {} sees, {} bytes.", _sections.size(),
+                    body.size() + sizeof(checksum));
+    return true;
+}
+
+std::optional<std::string> StateStore::Find(std::string_view key) const {
+    std::scoped_lock lock(_lock);
+    const auto it = _sections.find(key);
+    if (it == _sections.end()) return std::nullopt;
+    return it->second.payload;
+}
+
+void StateStore::Put(std::string key, std::string payload) {
+    std::scoped_lock lock(_lock);
+    auto [it, inserted] = _sections.try_emplace(std::move(key));
+    if (inserted || it->second.payload != payload) {
+        it->second.payload = std::move(payload);
+        it->second.stamp = Now();
+        _dirty = true;
+    }
+}
+
+void StateStore::ReplacePrefix(std::string_view prefix, Sections sections,
+                               const std::function<bool(const std::string&)>& keep) {
+    std::scoped_lock lock(_lock);
+    const auto now = Now();
+    for (auto it = _sections.lower_bound(prefix); it != _sections.end() && it->first.starts_with(prefix);) {
+        const auto replacement = sections.find(it->first);
+        if (replacement == sections.end()) {
+            if (keep && keep(it->first)) {
+                ++it;
+                continue;
+            }
+            it = _sections.erase(it);
+            _dirty = true;
+            continue;
+        }
+        if (it->second.payload != replacement->second) {
+            it->second.payload = std::move(replacement->second);
+            it->second.stamp = now;
+            _dirty = true;
+        }
+        sections.erase(replacement);
+        ++it;
+    }
+    for (auto& [key, payload] : sections) {
+        _sections.emplace(key, Section{std::move(payload), now});
+        _dirty = true;
+    }
+}
+
+void StateStore::ForEachPrefix(std::string_view prefix,
+                               const std::function<void(const std::string&, const std::string&)>& fn) const {
+    std::scoped_lock lock(_lock);
+    for (auto it = _sections.lower_bound(prefix); it != _sections.end() && it->first.starts_with(prefix); ++it) {
+        fn(it->first, it->second.payload);
+    }
+}
+
+bool StateStore::IsNewer(const std::filesystem::path& file, std::string_view key) const {
+    std::error_code ec;
+    const auto written = std::filesystem::last_write_time(file, ec);
+    if (ec) return false;
+    std::scoped_lock lock(_lock);
+    const auto it = _sections.find(key);
+    return it == _sections.end() || written.time_since_epoch().count() > it->second.stamp;
+}
+
+std::int64_t StateStore::Now() {
+    return std::filesystem::file_time_type::clock::now().time_since_epoch().count();
+}
+
+std::string StateStore::RulesKey(const std::filesystem::path& folder) {
+    return "rules/" + ManagedManifest::KeyOf(folder);
+}
+
+std::string StateStore::Encode(const rapidjson::Value& value) {
+    std::string out;
+    EncodeValue(value, out);
+    return out;
+}
+
+bool StateStore::Decode(std::string_view bytes, rapidjson::Document& doc) {
+    if (DecodeValue(bytes, doc, doc.GetAllocator(), 0) && bytes.empty()) return true;
+    doc.SetNull();
+    return false;
+}
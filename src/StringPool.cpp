@@ -0,0 +1,72 @@
+#include "StringPool.h"
+
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+StringPool& StringPool::Get() {
+    static StringPool pool;
+    return pool;
+}
+
+StringPool::StringPool() {
+    _views.emplace_back();  // kEmpty
+}
+
+StringPool::Id StringPool::Intern(std::string_view s) {
+    if (s.empty()) return kEmpty;
+    {
+        std::shared_lock lock(_mutex);
+        if (auto it = _ids.find(s); it != _ids.end()) return it->second;
+    }
+
+    std::unique_lock lock(_mutex);
+    if (auto it = _ids.find(s); it != _ids.end()) return it->second;
+
+    const std::size_t needed = s.size() + 1;
+    char* dest;
+    if (needed > kBlockSize) {
+        // String maior que um bloco: ganha um bloco s para ela
+        _blocks.push_back(std::make_unique<char[]>(needed));
+        _arenaBytes += needed;
+        dest = _blocks.back().get();
+        // Mantm o bloco corrente (o penltimo) como destino das prximas strings
+        if (_blocks.size() > 1) std::swap(_blocks[_blocks.size() - 1], _blocks[_blocks.size() - 2]);
+    } else {
+        if (_blockUsed + needed > kBlockSize) {
+            _blocks.push_back(std::make_unique<char[]>(kBlockSize));
+            _arenaBytes += kBlockSize;
+            _blockUsed = 0;
+        }
+        dest = _blocks.back().get() + _blockUsed;
+        _blockUsed += needed;
+    }
+    std::memcpy(dest, s.data(), s.size());
+    dest[s.size()] = '\0';
+    _usedBytes += needed;
+
+    const std::string_view stored(dest, s.size());
+    const auto id = static_cast<Id>(_views.size());
+    _views.push_back(stored);
+    _ids.emplace(stored, id);
+    return id;
+}
+
+std::string_view StringPool::View(Id id) const {
+    if (id == kEmpty) return std::string_view("", 0);
+    std::shared_lock lock(_mutex);
+    return id < _views.size() ? _views[id] : std::string_view("", 0);
+}
+
+StringPool::Stats StringPool::GetStats() const {
+    std::shared_lock lock(_mutex);
+    Stats stats;
+    stats.strings = _views.size() - 1;
+    stats.arenaBytes = _arenaBytes;
+    stats.usedBytes = _usedBytes;
+    // Vetor de views + ns do mapa (chave, id, prximo ponteiro e hash) + buckets
+    stats.indexBytes = _views.capacity() * sizeof(std::string_view) +
+                       _ids.size() * (sizeof(std::string_view) + sizeof(Id) + 2 * sizeof(void*)) +
+                       _ids.bucket_count() * sizeof(void*);
+    return stats;
+}
@@ -0,0 +1,184 @@
+#include "SubmovesetTable.h"
+
+#include <algorithm>
+#include <limits>
+
+void SubmovesetTable::Clear() {
+    _caps.clear();
+    _attackCounts.clear();
+    _powerAttackCounts.clear();
+    _revisions.clear();
+    _modIndex.clear();
+    _subIndex.clear();
+    _idsByMod.clear();
+    _idsByPath.clear();
+    _modNames.clear();
+    _modsByName.clear();
+    _subsByName.clear();
+}
+
+void SubmovesetTable::Sync(const std::vector<AnimationModDef>& mods) {
+    Truncate(mods.size());
+    _idsByMod.resize(mods.size());
+
+    for (std::size_t modIdx = 0; modIdx < mods.size(); ++modIdx) {
+        SyncMod(modIdx, mods[modIdx]);
+    }
+}
+
+void SubmovesetTable::Truncate(std::size_t modCount) {
+    // Mods que saram do fim de _allMods (ex.: slots de movesets de usurio apagados): ids viram "missing"
+    for (std::size_t modIdx = modCount; modIdx < _idsByMod.size(); ++modIdx) {
+        for (const SubmovesetId id : _idsByMod[modIdx]) {
+            MarkMissing(id);
+        }
+    }
+    for (std::size_t modIdx = modCount; modIdx < _modNames.size(); ++modIdx) {
+        UnindexModName(modIdx, modCount);
+    }
+    if (modCount < _idsByMod.size()) _idsByMod.resize(modCount);
+    if (modCount < _modNames.size()) _modNames.resize(modCount);
+    if (modCount < _subsByName.size()) _subsByName.resize(modCount);
+}
+
+void SubmovesetTable::SyncMod(std::size_t modIdx, const AnimationModDef& mod) {
+    if (modIdx >= _idsByMod.size()) _idsByMod.resize(modIdx + 1);
+    if (modIdx >= _modNames.size()) {
+        _modNames.resize(modIdx + 1);
+        _subsByName.resize(modIdx + 1);
+    }
+    IndexModName(modIdx, mod.name);
+    const auto& subAnimations = mod.subAnimations;
+    auto& ids = _idsByMod[modIdx];
+    for (std::size_t subIdx = 0; subIdx < subAnimations.size(); ++subIdx) {
+        if (subIdx < ids.size()) {
+            Store(ids[subIdx], subAnimations[subIdx]);
+            continue;
+        }
+        const auto id = static_cast<SubmovesetId>(_caps.size());
+        _caps.emplace_back();
+        _attackCounts.emplace_back();
+        _powerAttackCounts.emplace_back();
+        _revisions.emplace_back();
+        _modIndex.push_back(static_cast<std::uint32_t>(modIdx));
+        _subIndex.push_back(static_cast<std::uint32_t>(subIdx));
+        ids.push_back(id);
+        Store(id, subAnimations[subIdx]);
+        // O primeiro sub-moveset com o caminho fica com a chave, como na busca linear antiga
+        _idsByPath.try_emplace(PathKey(subAnimations[subIdx].path.get()), id);
+    }
+    for (std::size_t subIdx = subAnimations.size(); subIdx < ids.size(); ++subIdx) {
+        MarkMissing(ids[subIdx]);
+    }
+    ids.resize(std::min(ids.size(), subAnimations.size()));
+
+    // Refeito a cada sync do mod: os slots de movesets de usurio trocam de contedo no lugar
+    auto& subsByName = _subsByName[modIdx];
+    subsByName.clear();
+    for (std::size_t subIdx = 0; subIdx < subAnimations.size(); ++subIdx) {
+        subsByName.try_emplace(subAnimations[subIdx].name.str(), static_cast<std::uint32_t>(subIdx));
+    }
+}
+
+void SubmovesetTable::IndexModName(std::size_t modIdx, const std::string& name) {
+    if (_modNames[modIdx] == name) {
+        if (!name.empty()) _modsByName.try_emplace(name, static_cast<std::uint32_t>(modIdx));
+        return;
+    }
+    UnindexModName(modIdx, _modNames.size());
+    _modNames[modIdx] = name;
+    if (name.empty()) return;
+    auto [it, inserted] = _modsByName.try_emplace(name, static_cast<std::uint32_t>(modIdx));
+    if (!inserted && it->second > modIdx) it->second = static_cast<std::uint32_t>(modIdx);
+}
+
+void SubmovesetTable::UnindexModName(std::size_t modIdx, std::size_t searchLimit) {
+    const std::string& name = _modNames[modIdx];
+    const auto it = _modsByName.find(name);
+    if (it == _modsByName.end() || it->second != modIdx) return;
+    _modsByName.erase(it);
+    for (std::size_t other = 0; other < searchLimit; ++other) {
+        if (other != modIdx && _modNames[other] == name) {
+            _modsByName.emplace(name, static_cast<std::uint32_t>(other));
+            break;
+        }
+    }
+}
+
+std::optional<std::size_t> SubmovesetTable::FindMod(const std::string& name) const {
+    const auto it = _modsByName.find(name);
+    if (it == _modsByName.end()) return std::nullopt;
+    return it->second;
+}
+
+std::optional<std::size_t> SubmovesetTable::FindSub(std::size_t modIdx, const std::string& name) const {
+    if (modIdx >= _subsByName.size()) return std::nullopt;
+    const auto it = _subsByName[modIdx].find(name);
+    if (it == _subsByName[modIdx].end()) return std::nullopt;
+    return it->second;
+}
+
+MovesetTags SubmovesetTable::TagsOf(SubmovesetId id) const {
+    const auto caps = CapsOf(id);
+    MovesetTags tags;
+    tags.dpaTags.hasA = caps & SubmovesetCaps::kDpaA;
+    tags.dpaTags.hasB = caps & SubmovesetCaps::kDpaB;
+    tags.dpaTags.hasL = caps & SubmovesetCaps::kDpaL;
+    tags.dpaTags.hasR = caps & SubmovesetCaps::kDpaR;
+    tags.hasCPA = caps & SubmovesetCaps::kCpa;
+    return tags;
+}
+
+std::uint16_t SubmovesetTable::PackCaps(const SubAnimationDef& def) {
+    std::uint16_t caps = 0;
+    if (def.hasAnimations) caps |= SubmovesetCaps::kHasAnimations;
+    if (def.hasIdle) caps |= SubmovesetCaps::kHasIdle;
+    if (def.dpaTags.hasA) caps |= SubmovesetCaps::kDpaA;
+    if (def.dpaTags.hasB) caps |= SubmovesetCaps::kDpaB;
+    if (def.dpaTags.hasL) caps |= SubmovesetCaps::kDpaL;
+    if (def.dpaTags.hasR) caps |= SubmovesetCaps::kDpaR;
+    if (def.hasCPA) caps |= SubmovesetCaps::kCpa;
+    if (def.isMissing) caps |= SubmovesetCaps::kMissing;
+    return caps;
+}
+
+void SubmovesetTable::Store(SubmovesetId id, const SubAnimationDef& def) {
+    constexpr int kMaxCount = std::numeric_limits<std::uint16_t>::max();
+    const auto caps = PackCaps(def);
+    const auto attackCount = static_cast<std::uint16_t>(std::clamp(def.attackCount, 0, kMaxCount));
+    const auto powerAttackCount = static_cast<std::uint16_t>(std::clamp(def.powerAttackCount, 0, kMaxCount));
+    if (caps == _caps[id] && attackCount == _attackCounts[id] && powerAttackCount == _powerAttackCounts[id]) return;
+    _caps[id] = caps;
+    _attackCounts[id] = attackCount;
+    _powerAttackCounts[id] = powerAttackCount;
+    ++_revisions[id];
+}
+
+void SubmovesetTable::MarkMissing(SubmovesetId id) {
+    if (_caps[id] == SubmovesetCaps::kMissing) return;
+    _caps[id] = SubmovesetCaps::kMissing;
+    ++_revisions[id];
+}
+
+SubmovesetId SubmovesetTable::FindByPath(const std::filesystem::path& path) const {
+    const auto it = _idsByPath.find(PathKey(path));
+    if (it == _idsByPath.end()) return kInvalidSubmoveset;
+    // Ids de mods que saram da biblioteca continuam no mapa, mas no apontam mais para (mod, sub)
+    const SubmovesetId id = it->second;
+    if (IdOf(_modIndex[id], _subIndex[id]) != id) return kInvalidSubmoveset;
+    // Pastas que sumiram do disco mantm o id, mas no devem ser resolvidas pelo caminho
+    return (CapsOf(id) & SubmovesetCaps::kMissing) ? kInvalidSubmoveset : id;
+}
+
+std::string SubmovesetTable::PathKey(const std::filesystem::path& path) {
+    // Diretrio de trabalho lido uma vez: caminhos relativos viram absolutos sem chamada por entrada
+    static const std::filesystem::path base = std::filesystem::current_path();
+    const auto normal = (path.is_absolute() ? path : base / path).lexically_normal();
+    const auto u8 = normal.generic_u8string();
+    std::string key(reinterpret_cast<const char*>(u8.data()), u8.size());
+    while (key.size() > 1 && key.back() == '/') key.pop_back();
+    for (char& c : key) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return key;
+}
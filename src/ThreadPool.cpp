@@ -0,0 +1,142 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+namespace {
+    // Identifica se a thread atual  um worker (e de qual pool), para que Submit
+    // feito de dentro de uma tarefa v para a fila local do prprio worker.
+    thread_local const WorkStealingPool* t_ownerPool = nullptr;
+    thread_local std::size_t t_workerIndex = 0;
+}
+
+WorkStealingPool::WorkStealingPool(std::size_t threadCount) {
+    if (threadCount == 0) {
+        const unsigned int hw = std::thread::hardware_concurrency();
+        threadCount = hw > 1 ? hw - 1 : 1;
+    }
+
+    _queues.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        _queues.push_back(std::make_unique<WorkQueue>());
+    }
+    _workers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        _workers.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    Wait();
+    {
+        std::lock_guard lock(_sleepMutex);
+        _stopping = true;
+    }
+    _wakeCv.notify_all();
+    for (auto& worker : _workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void WorkStealingPool::Submit(Task task) {
+    std::size_t target;
+    if (t_ownerPool == this) {
+        target = t_workerIndex;
+    } else {
+        target = _nextQueue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+    }
+
+    _pending.fetch_add(1, std::memory_order_acq_rel);
+    {
+        std::lock_guard lock(_queues[target]->mutex);
+        _queues[target]->tasks.push_back(std::move(task));
+    }
+    _queued.fetch_add(1, std::memory_order_release);
+
+    // Trava/destrava para no perder o notify de um worker que est prestes a dormir
+    { std::lock_guard lock(_sleepMutex); }
+    _wakeCv.notify_one();
+}
+
+void WorkStealingPool::Wait() {
+    HelpUntil([this] { return _pending.load(std::memory_order_acquire) == 0; });
+}
+
+void WorkStealingPool::HelpUntil(const std::function<bool()>& done) {
+    const std::size_t helperIndex = (t_ownerPool == this) ? t_workerIndex : _queues.size();
+    while (!done()) {
+        Task task;
+        const bool gotTask = (helperIndex < _queues.size() && TryPop(helperIndex, task)) ||
+                             TrySteal(helperIndex, task);
+        if (gotTask) {
+            RunTask(task);
+            continue;
+        }
+        std::unique_lock lock(_sleepMutex);
+        _doneCv.wait_for(lock, std::chrono::milliseconds(2), done);
+    }
+}
+
+void WorkStealingPool::WorkerLoop(std::size_t index) {
+    t_ownerPool = this;
+    t_workerIndex = index;
+
+    while (true) {
+        Task task;
+        if (TryPop(index, task) || TrySteal(index, task)) {
+            RunTask(task);
+            continue;
+        }
+
+        std::unique_lock lock(_sleepMutex);
+        _wakeCv.wait(lock, [this] { return _stopping || _queued.load(std::memory_order_acquire) > 0; });
+        if (_stopping && _queued.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::TryPop(std::size_t index, Task& out) {
+    auto& queue = *_queues[index];
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    out = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    _queued.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+bool WorkStealingPool::TrySteal(std::size_t thief, Task& out) {
+    const std::size_t count = _queues.size();
+    const std::size_t start = thief < count ? thief + 1 : 0;
+    for (std::size_t offset = 0; offset < count; ++offset) {
+        const std::size_t victim = (start + offset) % count;
+        if (victim == thief) continue;
+        auto& queue = *_queues[victim];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        out = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        _queued.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::RunTask(Task& task) {
+    RunGuarded(task);
+    _pending.fetch_sub(1, std::memory_order_acq_rel);
+    { std::lock_guard lock(_sleepMutex); }
+    _doneCv.notify_all();
+}
+
+void WorkStealingPool::RunGuarded(const std::function<void()>& fn) {
+    try {
+        fn();
+    } catch (const std::exception& e) {
+        SKSE::log::error("[WorkStealingPool] Exceo em tarefa: {}", e.what());
+    } catch (...) {
+        SKSE::log::error("[WorkStealingPool] Exceo desconhecida em tarefa.");
+    }
+}
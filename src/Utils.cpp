@@ -958,6 +958,7 @@ void GlobalControl::NpcCombatTracker::RegisterSinksForExistingCombatants() {
 
 void GlobalControl::UpdateSkyPromptTexts() {
     auto animManager = AnimationManager::GetSingleton();
+    if (!animManager->IsLibraryReady()) return;
     std::string category = GetCurrentWeaponCategoryName();
 
     // --- LGICA PARA STANCES  ---
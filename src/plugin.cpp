@@ -4,6 +4,7 @@
 #include "Manager.h"
 #include "Serialization.h"
 #include "OARAPI.h"
+#include "CycleConditions.h"
 
 namespace fs = std::filesystem;
 
@@ -63,7 +64,14 @@ void OnMessage(SKSE::MessagingInterface::Message* message) {
     if (message->type == SKSE::MessagingInterface::kInputLoaded) {
     }
 
+    if (message->type == SKSE::MessagingInterface::kPostLoad) {
+        // O OAR s aceita condies novas at aqui
+        CycleConditions::Register();
+    }
+
     if (message->type == SKSE::MessagingInterface::kDataLoaded) {
+        // As regras de NPC abaixo dependem da biblioteca: espera o scan iniciado no SKSEPluginLoad.
+        AnimationManager::GetSingleton()->WaitForLibraryScan();
         RequestOAR_API();
 
         GlobalControl::g_clientID = SkyPromptAPI::RequestClientID();
@@ -82,6 +90,7 @@ void OnMessage(SKSE::MessagingInterface::Message* message) {
     }
 
     if (message->type == SKSE::MessagingInterface::kNewGame || message->type == SKSE::MessagingInterface::kPostLoadGame) {
+        AnimationManager::GetSingleton()->WaitForLibraryScan();
         WheelerKeys();
         // 2. Requisitar um ClientID da API SkyPrompt
         auto* inputDeviceManager = RE::BSInputDeviceManager::GetSingleton();
@@ -118,8 +127,13 @@ SKSEPluginLoad(const SKSE::LoadInterface *skse) {
 
     SetupLog();
     logger::info("Plugin loaded");
-    AnimationManager::GetSingleton()->ScanAnimationMods();
+    const auto loadStart = std::chrono::steady_clock::now();
     SKSE::Init(skse);
+    // O CycleDar copia/renomeia .hkx que o OAR vai ler: tem que terminar antes de retornarmos.
+    // S o scan da biblioteca, que no escreve nada, roda em segundo plano;
+    // kDataLoaded/kPostLoadGame esperam por ele.
+    AnimationManager::GetSingleton()->ImportCycleDarFolders();
+    AnimationManager::GetSingleton()->StartLibraryScan();
     
     SKSE::GetMessagingInterface()->RegisterListener(OnMessage);
     
@@ -132,7 +146,9 @@ SKSEPluginLoad(const SKSE::LoadInterface *skse) {
 
     UI::RegisterMenu();
     
-
+    logger::info("SKSEPluginLoad concludo em {} ms.",
+                 std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - loadStart)
+                     .count());
 
     return true;
 }
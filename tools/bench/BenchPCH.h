@@ -0,0 +1,36 @@
+#pragma once
+// Substitui o PCH.h do plugin nos executáveis do benchmark: sem CommonLibSSE, o SKSE::log vira
+// um shim que escreve no stdout. Só os fontes que não dependem do jogo/Win32 entram aqui.
+#include <cstdio>
+#include <format>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace SKSE::log {
+    template <class... Args>
+    void Print(std::string_view level, std::format_string<Args...> fmt, Args&&... args) {
+        const std::string line = std::format(fmt, std::forward<Args>(args)...);
+        std::printf("[%.*s] %s\n", static_cast<int>(level.size()), level.data(), line.c_str());
+    }
+
+    template <class... Args>
+    void info(std::format_string<Args...> fmt, Args&&... args) {
+        Print<Args...>("info", fmt, std::forward<Args>(args)...);
+    }
+    template <class... Args>
+    void warn(std::format_string<Args...> fmt, Args&&... args) {
+        Print<Args...>("warn", fmt, std::forward<Args>(args)...);
+    }
+    template <class... Args>
+    void error(std::format_string<Args...> fmt, Args&&... args) {
+        Print<Args...>("error", fmt, std::forward<Args>(args)...);
+    }
+    template <class... Args>
+    void critical(std::format_string<Args...> fmt, Args&&... args) {
+        Print<Args...>("critical", fmt, std::forward<Args>(args)...);
+    }
+}
+
+namespace logger = SKSE::log;
+using namespace std::literals;
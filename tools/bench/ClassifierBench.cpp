@@ -0,0 +1,136 @@
+// Mede o FileClassifier::Classify contra a classificação antiga do ListFolder (cópia em minúsculas
+// do nome e uma comparação de string por regra) sobre uma lista sintética de nomes de arquivo.
+// Os nomes usam o tipo nativo do std::filesystem (wchar_t no Windows), como no walk do plugin, e
+// as duas classificações são conferidas nome a nome.
+// Uso: ClassifierBench [nomes=1000000] [repetições=5]
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FileClassifier.h"
+
+namespace {
+    using NativeString = std::filesystem::path::string_type;
+
+    // Proporções de uma pasta de moveset real: quase tudo .hkx, alguns .json e arquivos soltos
+    std::string RandomName(std::mt19937& rng) {
+        static constexpr std::string_view kFixed[] = {
+            "BFCO_PowerAttackA.hkx",  "BFCO_PowerAttackB.hkx", "BFCO_PowerAttackL.hkx", "BFCO_PowerAttackR.hkx",
+            "BFCO_PowerAttackCOMB.hkx", "config.json",         "User_CycleMoveset.json", "CycleMoveset.json",
+            "CycleDar.json",          "user.json",             "_conditions.txt",        "readme.txt"};
+        const auto roll = rng() % 100;
+        std::string name;
+        if (roll < 8) {
+            name = kFixed[rng() % std::size(kFixed)];
+        } else if (roll < 40) {
+            name = std::format("BFCO_Attack{}.hkx", rng() % 40);
+        } else if (roll < 65) {
+            name = std::format("BFCO_PowerAttack{}.hkx", rng() % 40);
+        } else if (roll < 80) {
+            name = std::format("mco_attack{}.hkx", rng() % 40);
+        } else if (roll < 88) {
+            name = std::format("1hm_idle{}.hkx", rng() % 8);
+        } else {
+            name = std::format("sprint_{}_anim.hkx", rng() % 1000);
+        }
+        // Mods misturam maiúsculas e minúsculas nos nomes
+        if (rng() % 4 == 0) {
+            std::ranges::transform(name, name.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        }
+        return name;
+    }
+
+    // A classificação do ListFolder/HkxTags::AddFile antes do FileClassifier
+    std::uint32_t LegacyClassify(const NativeString& native) {
+        using namespace FileClassifier;
+        std::string lower = std::filesystem::path(native).string();
+        std::ranges::transform(lower, lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        if (lower == "config.json") return kConfigJson;
+        if (lower == "user_cyclemoveset.json") return kUserCycleMovesetJson;
+        if (lower == "cyclemoveset.json") return kCycleMovesetJson;
+        if (lower == "cycledar.json") return kCycleDarJson;
+        if (lower == "user.json") return kDarUserJson;
+        if (!lower.ends_with(".hkx")) return 0;
+
+        std::uint32_t tags = kHkx;
+        if (lower.rfind("bfco_attack", 0) == 0) tags |= kAttack;
+        if (lower.rfind("bfco_powerattack", 0) == 0) tags |= kPowerAttack;
+        if (lower.find("idle") != std::string::npos) tags |= kIdle;
+        if (lower.rfind("mco_", 0) == 0) tags |= kMcoPrefix;
+        if (lower == "bfco_powerattacka.hkx") tags |= kDpaA;
+        else if (lower == "bfco_powerattackb.hkx") tags |= kDpaB;
+        else if (lower == "bfco_powerattackl.hkx") tags |= kDpaL;
+        else if (lower == "bfco_powerattackr.hkx") tags |= kDpaR;
+        else if (lower == "bfco_powerattackcomb.hkx") tags |= kCpa;
+        return tags;
+    }
+
+    // Só as tags que o ListFolder usa: arquivos que não são .hkx nem um dos .json especiais não contam
+    std::uint32_t UsedTags(std::uint32_t tags) {
+        using namespace FileClassifier;
+        constexpr std::uint32_t kJson =
+            kConfigJson | kUserCycleMovesetJson | kCycleMovesetJson | kCycleDarJson | kDarUserJson;
+        if (tags & kJson) return tags & kJson;
+        return (tags & kHkx) ? tags : 0;
+    }
+
+    template <class Fn>
+    double TimeMs(int runs, std::uint64_t& checksum, Fn&& fn) {
+        double best = 0;
+        for (int run = 0; run < runs; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            checksum = fn();
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (run == 0 || ms < best) best = ms;
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000000;
+    const int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+    std::mt19937 rng(42);
+    std::vector<NativeString> names;
+    names.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        names.push_back(std::filesystem::path(RandomName(rng)).native());
+    }
+
+    std::size_t mismatches = 0;
+    for (const auto& name : names) {
+        if (UsedTags(FileClassifier::Classify(std::basic_string_view(name))) != LegacyClassify(name)) ++mismatches;
+    }
+
+    std::uint64_t legacySum = 0;
+    std::uint64_t classifierSum = 0;
+    const double legacyMs = TimeMs(runs, legacySum, [&] {
+        std::uint64_t sum = 0;
+        for (const auto& name : names) sum += LegacyClassify(name);
+        return sum;
+    });
+    const double classifierMs = TimeMs(runs, classifierSum, [&] {
+        std::uint64_t sum = 0;
+        for (const auto& name : names) sum += UsedTags(FileClassifier::Classify(std::basic_string_view(name)));
+        return sum;
+    });
+
+    const auto nsPerName = [&](double ms) { return ms * 1e6 / static_cast<double>(names.size()); };
+    std::printf("%zu nomes, melhor de %d\n", names.size(), runs);
+    std::printf("Antigo (minúsculas + comparações): %.1f ms, %.1f ns/nome\n", legacyMs, nsPerName(legacyMs));
+    std::printf("FileClassifier:                    %.1f ms, %.1f ns/nome (%.1fx)\n", classifierMs,
+                nsPerName(classifierMs), classifierMs > 0 ? legacyMs / classifierMs : 0.0);
+    std::printf("%zu classificações diferentes, somas %s\n", mismatches,
+                legacySum == classifierSum ? "iguais" : "DIFERENTES");
+    return mismatches == 0 && legacySum == classifierSum ? 0 : 1;
+}
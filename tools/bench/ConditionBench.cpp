@@ -0,0 +1,345 @@
+// Avalia o bloco gerenciado de um config.json como o OAR faz (curto-circuito, na ordem do arquivo)
+// antes e depois do ConditionOptimizer::Optimize, sobre estados aleatórios de ator/arma/behavior.
+// O bloco segue os Add*Condition do UpdateOrCreateJson: IsActorBase, CycleMovesetNpcType, tipo
+// equipado, keywords com as exclusões das categorias concorrentes, stance, playlist e direções.
+// Os dois blocos têm de dar o mesmo resultado em todo estado; o custo modelado soma o Estimate
+// de cada folha avaliada.
+// Uso: ConditionBench [categorias=6] [estados=200000] [repetições=5]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ConditionOptimizer.h"
+#include "SyntheticConditions.h"
+#include "rapidjson/document.h"
+
+namespace {
+    using SyntheticConditions::Allocator;
+    using SyntheticConditions::Compare;
+    using Value = rapidjson::Value;
+
+    constexpr int kTypes = 7;  // IsEquippedType de 1 a 6, e 7 para "outra coisa"
+
+    // ---- Montagem do bloco, no layout do UpdateOrCreateJson ----
+
+    Value Negated(Value condition, Allocator& allocator) {
+        condition.AddMember("negated", true, allocator);
+        return condition;
+    }
+
+    Value ActorBase(bool negated, Allocator& allocator) {
+        Value condition(rapidjson::kObjectType);
+        condition.AddMember("condition", "IsActorBase", allocator);
+        if (negated) condition.AddMember("negated", true, allocator);
+        Value params(rapidjson::kObjectType);
+        params.AddMember("pluginName", "Skyrim.esm", allocator);
+        params.AddMember("formID", "000007", allocator);
+        condition.AddMember("Actor base", params, allocator);
+        return condition;
+    }
+
+    Value EquippedType(int type, bool leftHand, Allocator& allocator) {
+        Value condition(rapidjson::kObjectType);
+        condition.AddMember("condition", "IsEquippedType", allocator);
+        Value typeVal(rapidjson::kObjectType);
+        typeVal.AddMember("value", static_cast<double>(type), allocator);
+        condition.AddMember("Type", typeVal, allocator);
+        condition.AddMember("Left hand", leftHand, allocator);
+        return condition;
+    }
+
+    Value Keyword(const std::string& editorID, bool negated, Allocator& allocator) {
+        Value condition(rapidjson::kObjectType);
+        condition.AddMember("condition", "IsEquippedHasKeyword", allocator);
+        condition.AddMember("requiredVersion", "1.0.0.0", allocator);
+        if (negated) condition.AddMember("negated", true, allocator);
+        Value keyword(rapidjson::kObjectType);
+        keyword.AddMember("editorID", Value(editorID.c_str(), allocator), allocator);
+        condition.AddMember("Keyword", keyword, allocator);
+        condition.AddMember("Left hand", false, allocator);
+        return condition;
+    }
+
+    Value Group(const char* kind, const char* comment, Value& conditions, Allocator& allocator) {
+        Value block(rapidjson::kObjectType);
+        block.AddMember("condition", rapidjson::StringRef(kind), allocator);
+        if (comment) block.AddMember("comment", rapidjson::StringRef(comment), allocator);
+        block.AddMember("Conditions", conditions, allocator);
+        return block;
+    }
+
+    std::string KeywordName(int index) { return std::format("BenchWeapTypeKeyword{:02}", index); }
+
+    // Categorias em pares com o mesmo IsEquippedType, separadas por keyword (como espada e katana);
+    // metade delas aceita duas keywords. Cada categoria tem o jogador em duas stances, com um pai e
+    // um filho direcional na playlist, e uma regra de NPC geral.
+    Value BuildBlock(int categories, Allocator& allocator) {
+        Value branches(rapidjson::kArrayType);
+        for (int c = 0; c < categories; ++c) {
+            const int type = 1 + (c / 2) % 6;
+            const int partner = c ^ 1;
+            const int playlist = 1 + c % 5;
+
+            const auto prefix = [&](bool player) {
+                Value conditions(rapidjson::kArrayType);
+                conditions.PushBack(ActorBase(!player, allocator), allocator);
+                conditions.PushBack(Compare("CycleMovesetNpcType", 0, allocator), allocator);
+                conditions.PushBack(EquippedType(type, false, allocator), allocator);
+                if (c % 2 == 0) {
+                    Value any(rapidjson::kArrayType);
+                    any.PushBack(Keyword(KeywordName(c), false, allocator), allocator);
+                    any.PushBack(Keyword(KeywordName(c + 32), false, allocator), allocator);
+                    conditions.PushBack(Group("OR", "Matches any of the required keywords", any, allocator), allocator);
+                } else {
+                    conditions.PushBack(Keyword(KeywordName(c), false, allocator), allocator);
+                }
+                if (partner < categories) {
+                    Value exclusions(rapidjson::kArrayType);
+                    exclusions.PushBack(Keyword(KeywordName(partner), true, allocator), allocator);
+                    conditions.PushBack(Group("AND", "Exclude competing categories", exclusions, allocator),
+                                        allocator);
+                }
+                return conditions;
+            };
+
+            for (int stance = 1; stance <= 2; ++stance) {
+                // Pai: qualquer direção que não seja a do filho
+                Value parent = prefix(true);
+                parent.PushBack(Compare("cycle_instance", stance, allocator), allocator);
+                parent.PushBack(Compare("testarone", playlist, allocator), allocator);
+                Value notChild(rapidjson::kArrayType);
+                notChild.PushBack(Negated(Compare("DirecionalCycleMoveset", 1, allocator), allocator), allocator);
+                notChild.PushBack(Negated(Compare("DirecionalCycleMoveset", 5, allocator), allocator), allocator);
+                parent.PushBack(Group("AND", "Is NOT any child direction", notChild, allocator), allocator);
+                branches.PushBack(Group("AND", nullptr, parent, allocator), allocator);
+
+                Value child = prefix(true);
+                child.PushBack(Compare("cycle_instance", stance, allocator), allocator);
+                child.PushBack(Compare("testarone", playlist, allocator), allocator);
+                Value directions(rapidjson::kArrayType);
+                directions.PushBack(Compare("DirecionalCycleMoveset", 1, allocator), allocator);
+                directions.PushBack(Compare("DirecionalCycleMoveset", 5, allocator), allocator);
+                child.PushBack(Group("OR", nullptr, directions, allocator), allocator);
+                branches.PushBack(Group("AND", nullptr, child, allocator), allocator);
+            }
+
+            Value npc = prefix(false);
+            npc.PushBack(Compare("cycle_instance", 0, allocator), allocator);
+            npc.PushBack(Compare("testarone", playlist, allocator), allocator);
+            branches.PushBack(Group("AND", nullptr, npc, allocator), allocator);
+        }
+        return branches;
+    }
+
+    // ---- Avaliação ----
+
+    enum GraphVariable { kNpcType, kInstance, kPlaylist, kDirection, kGraphVariables };
+
+    struct State {
+        bool isPlayer = false;
+        int type = 0;
+        std::uint64_t keywords = 0;
+        int graph[kGraphVariables] = {};
+    };
+
+    // Folha ou grupo já resolvido, para que o tempo medido seja o da árvore e não o de ler o JSON
+    struct Node {
+        enum class Kind { kAnd, kOr, kActorBase, kGraph, kType, kKeyword };
+        Kind kind = Kind::kAnd;
+        bool negated = false;
+        int index = 0;
+        int value = 0;
+        double cost = 0;
+        std::vector<Node> children;
+    };
+
+    std::string_view StringOf(const Value& v) { return std::string_view(v.GetString(), v.GetStringLength()); }
+
+    Node CompileNode(const Value& v, std::unordered_map<std::string, int>& keywordIds, std::size_t& nodes) {
+        ++nodes;
+        Node node;
+        node.negated = v.HasMember("negated") && v["negated"].GetBool();
+        node.cost = ConditionOptimizer::Estimate(v).cost;
+        const auto name = StringOf(v["condition"]);
+        if (name == "AND" || name == "OR") {
+            node.kind = name == "AND" ? Node::Kind::kAnd : Node::Kind::kOr;
+            for (const auto& child : v["Conditions"].GetArray()) {
+                node.children.push_back(CompileNode(child, keywordIds, nodes));
+            }
+        } else if (name == "IsActorBase") {
+            node.kind = Node::Kind::kActorBase;
+        } else if (name == "IsEquippedType") {
+            node.kind = Node::Kind::kType;
+            node.value = static_cast<int>(v["Type"]["value"].GetDouble());
+        } else if (name == "IsEquippedHasKeyword") {
+            node.kind = Node::Kind::kKeyword;
+            const auto [it, inserted] = keywordIds.try_emplace(std::string(StringOf(v["Keyword"]["editorID"])),
+                                                               static_cast<int>(keywordIds.size()));
+            node.index = it->second;
+        } else {
+            static const std::unordered_map<std::string_view, int> kVariables = {
+                {"CycleMovesetNpcType", kNpcType},
+                {"cycle_instance", kInstance},
+                {"testarone", kPlaylist},
+                {"DirecionalCycleMoveset", kDirection}};
+            node.kind = Node::Kind::kGraph;
+            node.index = kVariables.at(StringOf(v["Value B"]["graphVariable"]));
+            node.value = v["Value A"]["value"].GetInt();
+        }
+        return node;
+    }
+
+    struct Tree {
+        Node root;
+        std::size_t nodes = 0;
+        double expectedCost = 0;
+    };
+
+    Tree Compile(const Value& branches, std::unordered_map<std::string, int>& keywordIds) {
+        Tree tree;
+        tree.root.kind = Node::Kind::kOr;
+        for (const auto& branch : branches.GetArray()) {
+            tree.root.children.push_back(CompileNode(branch, keywordIds, tree.nodes));
+        }
+        rapidjson::Document scratch;
+        Value copy(branches, scratch.GetAllocator());
+        const Value master = Group("OR", nullptr, copy, scratch.GetAllocator());
+        tree.expectedCost = ConditionOptimizer::Estimate(master).cost;
+        return tree;
+    }
+
+    struct Counters {
+        std::uint64_t leaves = 0;
+        double cost = 0;
+    };
+
+    template <bool kCount>
+    bool Evaluate(const Node& node, const State& state, Counters& counters) {
+        bool result = false;
+        switch (node.kind) {
+            case Node::Kind::kAnd:
+                result = true;
+                for (const auto& child : node.children) {
+                    if (!Evaluate<kCount>(child, state, counters)) {
+                        result = false;
+                        break;
+                    }
+                }
+                break;
+            case Node::Kind::kOr:
+                for (const auto& child : node.children) {
+                    if (Evaluate<kCount>(child, state, counters)) {
+                        result = true;
+                        break;
+                    }
+                }
+                break;
+            case Node::Kind::kActorBase:
+                result = state.isPlayer;
+                break;
+            case Node::Kind::kGraph:
+                result = state.graph[node.index] == node.value;
+                break;
+            case Node::Kind::kType:
+                result = state.type == node.value;
+                break;
+            case Node::Kind::kKeyword:
+                result = (state.keywords >> node.index) & 1;
+                break;
+        }
+        if constexpr (kCount) {
+            if (node.kind != Node::Kind::kAnd && node.kind != Node::Kind::kOr) {
+                ++counters.leaves;
+                counters.cost += node.cost;
+            }
+        }
+        return result != node.negated;
+    }
+
+    // Distribuição parecida com a de uma luta: quase sempre NPC tipo 0, arma de uma das categorias
+    State RandomState(std::mt19937& rng, int keywordCount) {
+        State state;
+        state.isPlayer = rng() % 4 == 0;
+        state.type = 1 + static_cast<int>(rng() % kTypes);
+        state.keywords = std::uint64_t{1} << (rng() % keywordCount);
+        if (rng() % 8 == 0) state.keywords |= std::uint64_t{1} << (rng() % keywordCount);
+        state.graph[kNpcType] = rng() % 5 == 0 ? static_cast<int>(1 + rng() % 4) : 0;
+        state.graph[kInstance] = state.isPlayer ? static_cast<int>(1 + rng() % 4) : 0;
+        state.graph[kPlaylist] = static_cast<int>(1 + rng() % 5);
+        state.graph[kDirection] = static_cast<int>(rng() % 9);
+        return state;
+    }
+
+    struct Sample {
+        double bestMs = 0;
+        std::uint64_t matches = 0;
+    };
+
+    Sample Time(const Tree& tree, const std::vector<State>& states, int runs) {
+        Sample sample;
+        Counters unused;
+        for (int run = 0; run < runs; ++run) {
+            std::uint64_t matches = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (const auto& state : states) matches += Evaluate<false>(tree.root, state, unused);
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (run == 0 || ms < sample.bestMs) sample.bestMs = ms;
+            sample.matches = matches;
+        }
+        return sample;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int categories = argc > 1 ? std::clamp(std::atoi(argv[1]), 1, 30) : 6;
+    const int count = argc > 2 ? std::max(1, std::atoi(argv[2])) : 200000;
+    const int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 5;
+
+    rapidjson::Document doc;
+    auto& allocator = doc.GetAllocator();
+    Value original = BuildBlock(categories, allocator);
+    Value optimized(original, allocator);
+    const auto stats = ConditionOptimizer::Optimize(optimized, allocator);
+
+    std::unordered_map<std::string, int> keywordIds;
+    const Tree before = Compile(original, keywordIds);
+    const Tree after = Compile(optimized, keywordIds);
+
+    std::mt19937 rng(42);
+    std::vector<State> states;
+    states.reserve(count);
+    for (int i = 0; i < count; ++i) states.push_back(RandomState(rng, static_cast<int>(keywordIds.size())));
+
+    std::size_t mismatches = 0;
+    Counters countBefore;
+    Counters countAfter;
+    for (const auto& state : states) {
+        if (Evaluate<true>(before.root, state, countBefore) != Evaluate<true>(after.root, state, countAfter)) {
+            ++mismatches;
+        }
+    }
+
+    const Sample timeBefore = Time(before, states, runs);
+    const Sample timeAfter = Time(after, states, runs);
+
+    const double n = static_cast<double>(states.size());
+    std::printf("%d categorias, %u ramos no OR mestre, %zu estados, melhor de %d; Optimize %s\n", categories,
+                static_cast<unsigned>(original.Size()), states.size(), runs, stats.applied ? "aplicado" : "NÃO aplicado");
+    const auto print = [&](const char* label, const Tree& tree, const Counters& counters, const Sample& sample) {
+        std::printf("%s %5zu nós | %.1f folhas/avaliação | custo %.2f por avaliação (Estimate: %.2f) | %.1f ns/avaliação\n",
+                    label, tree.nodes, static_cast<double>(counters.leaves) / n, counters.cost / n, tree.expectedCost,
+                    sample.bestMs * 1e6 / n);
+    };
+    print("Original: ", before, countBefore, timeBefore);
+    print("Otimizado:", after, countAfter, timeAfter);
+    std::printf("%llu estados passam; %zu resultados diferentes\n",
+                static_cast<unsigned long long>(timeBefore.matches), mismatches);
+    return mismatches == 0 && timeBefore.matches == timeAfter.matches ? 0 : 1;
+}
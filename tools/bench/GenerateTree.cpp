@@ -0,0 +1,138 @@
+// Gera uma árvore OAR/DAR sintética para o ScanBench: N mods × M sub-movesets × K .hkx, com
+// config.json, CycleDar.json, User_CycleMoveset.json e o marcador de arquivo gerenciado.
+// Só usa std::filesystem, então roda em qualquer pasta temporária, sem o jogo.
+// Uso: GenerateTree <pasta Data> [mods=200] [subs=8] [hkx=40]
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace {
+    constexpr std::string_view kOarRoot = "meshes/actors/character/animations/OpenAnimationReplacer";
+    constexpr std::string_view kDarRoot =
+        "meshes/actors/character/animations/DynamicAnimationReplacer/_CustomConditions";
+    constexpr std::string_view kManagedMarker = "OAR_CYCLE_MANAGER_CONDITIONS";
+
+    // Proporções aproximadas de uma lista de mods real
+    constexpr int kCycleDarEvery = 6;
+    constexpr int kUserRulesEvery = 4;
+    constexpr int kManagedEvery = 3;
+
+    std::size_t g_files = 0;
+
+    void WriteFile(const std::filesystem::path& path, std::string_view text) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        ++g_files;
+    }
+
+    // Nomes no padrão dos movesets BFCO/MCO: os especiais (DPA, CPA, idle) primeiro, depois ataques numerados
+    std::string HkxName(int index) {
+        static constexpr std::string_view kSpecial[] = {
+            "BFCO_PowerAttackA.hkx", "BFCO_PowerAttackB.hkx", "BFCO_PowerAttackL.hkx",   "BFCO_PowerAttackR.hkx",
+            "1hm_idle.hkx",          "mco_sprintattack.hkx",  "BFCO_PowerAttackCOMB.hkx"};
+        if (index < static_cast<int>(std::size(kSpecial))) return std::string(kSpecial[index]);
+        switch (index % 3) {
+            case 0:
+                return std::format("BFCO_Attack{}.hkx", index);
+            case 1:
+                return std::format("BFCO_PowerAttack{}.hkx", index);
+            default:
+                return std::format("mco_attack{}.hkx", index);
+        }
+    }
+
+    void WriteHkx(const std::filesystem::path& folder, int count) {
+        for (int i = 0; i < count; ++i) {
+            WriteFile(folder / HkxName(i), "hkx");
+        }
+    }
+
+    std::string RuleFile(std::string_view modName, std::string_view subName, const std::filesystem::path& config) {
+        return std::format(
+            R"([{{"Type":"Player","Name":"Player","FormID":"0x14","Plugin":"Skyrim.esm","Identifier":"Player",)"
+            R"("Menu":[{{"Category":"Sword","stances":[{{"index":1,"type":"moveset","name":"{}","order":1,)"
+            R"("animations":[{{"index":1,"sourceModName":"{}","sourceSubName":"{}","sourceConfigPath":"{}",)"
+            R"("pFront":false,"pBack":false,"pLeft":false,"pRight":false}}]}}]}}]}}])",
+            modName, modName, subName, config.generic_string());
+    }
+
+    void GenerateOar(const std::filesystem::path& root, int mods, int subs, int hkx) {
+        for (int m = 0; m < mods; ++m) {
+            const auto modName = std::format("Bench Mod {:03}", m);
+            const auto modPath = root / std::format("BenchMod{:03}", m);
+            std::filesystem::create_directories(modPath);
+            WriteFile(modPath / "config.json", std::format(R"({{"name":"{}","author":"bench"}})", modName));
+
+            for (int s = 0; s < subs; ++s) {
+                const int serial = m * subs + s;
+                const auto subName = std::format("{:02} Stance", s);
+                const auto subPath = modPath / subName;
+                std::filesystem::create_directories(subPath);
+
+                const bool managed = serial % kManagedEvery == 0;
+                WriteFile(subPath / "config.json",
+                          std::format(R"({{"name":"{}","priority":{},"conditions":[{}]}})", subName,
+                                      2000000000 + serial,
+                                      managed ? std::format(R"({{"condition":"OR","comment":"{}","Conditions":[]}})",
+                                                            kManagedMarker)
+                                              : std::string()));
+                if (serial % kCycleDarEvery == 0) {
+                    WriteFile(subPath / "CycleDar.json",
+                              R"({"sources":[{"path":"meshes/bench"}],"convertBFCO":true,"conversionDone":true})");
+                }
+                if (serial % kUserRulesEvery == 0) {
+                    WriteFile(subPath / "User_CycleMoveset.json", RuleFile(modName, subName, subPath / "config.json"));
+                }
+                WriteHkx(subPath, hkx);
+            }
+        }
+    }
+
+    // Cada pasta numerada do DAR é um sub-moveset do mod virtual "[DAR] Animations"
+    void GenerateDar(const std::filesystem::path& root, int folders, int hkx) {
+        for (int f = 0; f < folders; ++f) {
+            const auto folder = root / std::to_string(100000 + f);
+            std::filesystem::create_directories(folder);
+            WriteFile(folder / "_conditions.txt", "IsActorBase(\"Skyrim.esm\" | 0x7)");
+            if (f % 2 == 0) {
+                WriteFile(folder / "user.json", R"({"name":"DAR","conditions":[]})");
+                if (f % kUserRulesEvery == 0) {
+                    WriteFile(folder / "User_CycleMoveset.json",
+                              RuleFile("[DAR] Animations", folder.filename().string(), folder));
+                }
+            }
+            WriteHkx(folder, hkx);
+        }
+    }
+
+    int ArgOr(int argc, char** argv, int index, int fallback) {
+        return argc > index ? std::atoi(argv[index]) : fallback;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("Uso: %s <pasta Data> [mods=200] [subs=8] [hkx=40]\n", argv[0]);
+        return 1;
+    }
+    const std::filesystem::path data = argv[1];
+    const int mods = ArgOr(argc, argv, 2, 200);
+    const int subs = ArgOr(argc, argv, 3, 8);
+    const int hkx = ArgOr(argc, argv, 4, 40);
+
+    std::error_code ec;
+    if (std::filesystem::exists(data / "meshes", ec)) {
+        std::printf("%s já tem uma pasta meshes. Use uma pasta vazia.\n", data.string().c_str());
+        return 1;
+    }
+
+    GenerateOar(data / kOarRoot, mods, subs, hkx);
+    GenerateDar(data / kDarRoot, mods / 4, hkx);
+    std::printf("Árvore gerada em %s: %d mods x %d sub-movesets x %d hkx, %d pastas DAR, %zu arquivos.\n",
+                data.string().c_str(), mods, subs, hkx, mods / 4, g_files);
+    return 0;
+}
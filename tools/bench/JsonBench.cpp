@@ -0,0 +1,195 @@
+// Compara o carregamento dos JSON de config pelo caminho antigo dos loaders (ifstream +
+// istreambuf_iterator para uma std::string e Parse num Document novo) com o do JsonReader (uma
+// leitura dimensionada e Parse/ParseInsitu num MemoryPoolAllocator com arena, reusado a cada
+// arquivo). O JsonReader lê com CreateFileW/ReadFile; aqui a mesma leitura única é feita com fread
+// para rodar fora do Windows. Os arquivos são criados na pasta dada e lidos com o cache do SO
+// quente; o tempo de leitura é mostrado à parte do total. Os Documents dos dois caminhos são
+// comparados arquivo a arquivo.
+// Uso: JsonBench <pasta vazia> [arquivos=2000] [regras por config.json=24] [repetições=5]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "SyntheticConditions.h"
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+namespace {
+    constexpr std::size_t kArenaSize = 64 * 1024;  // O mesmo JsonReader::kArenaSize
+
+    // config.json com membros do usuário e o bloco gerenciado, como o manager grava
+    std::string ConfigText(int index, int rules) {
+        rapidjson::Document doc;
+        doc.SetObject();
+        auto& allocator = doc.GetAllocator();
+        doc.AddMember("name", rapidjson::Value(std::format("{:02} Stance", index % 100).c_str(), allocator), allocator);
+        doc.AddMember("description", "Moveset gerado para o benchmark", allocator);
+        doc.AddMember("priority", 2100000000 + index, allocator);
+        doc.AddMember("interruptible", true, allocator);
+        rapidjson::Value conditions(rapidjson::kArrayType);
+        conditions.PushBack(SyntheticConditions::ManagedBlock(rules, index, allocator), allocator);
+        doc.AddMember("conditions", conditions, allocator);
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        doc.Accept(writer);
+        return std::string(buffer.GetString(), buffer.GetSize());
+    }
+
+    // A leitura do JsonReader: tamanho primeiro, depois uma única leitura no buffer já dimensionado
+    bool ReadWholeFile(const std::filesystem::path& path, std::string& out) {
+        out.clear();
+        std::FILE* file = std::fopen(path.string().c_str(), "rb");
+        if (!file) return false;
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        bool ok = !ec;
+        if (ok) {
+            out.resize(static_cast<std::size_t>(size));
+            ok = std::fread(out.data(), 1, out.size(), file) == out.size();
+        }
+        std::fclose(file);
+        if (!ok) out.clear();
+        return ok;
+    }
+
+    struct Sample {
+        double readMs = 0;
+        double totalMs = 0;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    double Ms(Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); }
+
+    // Como os loaders faziam antes do JsonReader
+    Sample RunLegacy(const std::vector<std::filesystem::path>& files, std::vector<rapidjson::Document>* keep) {
+        Sample sample;
+        const auto start = Clock::now();
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            const auto readStart = Clock::now();
+            std::ifstream ifs(files[i]);
+            std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+            sample.readMs += Ms(Clock::now() - readStart);
+
+            rapidjson::Document doc;
+            doc.Parse(content.c_str());
+            if (keep) (*keep)[i].CopyFrom(doc, (*keep)[i].GetAllocator());
+        }
+        sample.totalMs = Ms(Clock::now() - start);
+        return sample;
+    }
+
+    // O JsonReader: arena e pool reusados, o Document limpo a cada arquivo
+    class ArenaReader {
+    public:
+        ArenaReader() : _arena(kArenaSize), _pool(_arena.data(), _arena.size()), _doc(&_pool) {}
+
+        bool Load(const std::filesystem::path& path) {
+            _doc.SetNull();
+            _pool.Clear();
+            return ReadWholeFile(path, _text);
+        }
+        rapidjson::Document& Parse() { return _doc.Parse(_text.data(), _text.size()); }
+        rapidjson::Document& ParseInsitu() { return _doc.ParseInsitu(_text.data()); }
+
+    private:
+        std::vector<char> _arena;
+        rapidjson::MemoryPoolAllocator<> _pool;
+        rapidjson::Document _doc;
+        std::string _text;
+    };
+
+    Sample RunArena(const std::vector<std::filesystem::path>& files, bool insitu,
+                    const std::vector<rapidjson::Document>* expected, std::size_t& mismatches) {
+        Sample sample;
+        ArenaReader reader;
+        const auto start = Clock::now();
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            const auto readStart = Clock::now();
+            const bool loaded = reader.Load(files[i]);
+            sample.readMs += Ms(Clock::now() - readStart);
+            if (!loaded) {
+                ++mismatches;
+                continue;
+            }
+            const auto& doc = insitu ? reader.ParseInsitu() : reader.Parse();
+            if (expected && (doc.HasParseError() || doc != (*expected)[i])) ++mismatches;
+        }
+        sample.totalMs = Ms(Clock::now() - start);
+        return sample;
+    }
+
+    template <class Run>
+    Sample Best(int runs, Run&& run) {
+        Sample best;
+        for (int i = 0; i < runs; ++i) {
+            const Sample sample = run();
+            if (i == 0 || sample.totalMs < best.totalMs) best = sample;
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("Uso: %s <pasta vazia> [arquivos=2000] [regras por config.json=24] [repetições=5]\n", argv[0]);
+        return 1;
+    }
+    const std::filesystem::path root = argv[1];
+    const int count = argc > 2 ? std::max(1, std::atoi(argv[2])) : 2000;
+    const int rules = argc > 3 ? std::max(1, std::atoi(argv[3])) : 24;
+    const int runs = argc > 4 ? std::max(1, std::atoi(argv[4])) : 5;
+
+    std::error_code ec;
+    if (std::filesystem::exists(root, ec) && !std::filesystem::is_empty(root, ec)) {
+        std::printf("%s não está vazia.\n", root.string().c_str());
+        return 1;
+    }
+
+    std::vector<std::filesystem::path> files;
+    files.reserve(count);
+    std::size_t bytes = 0;
+    for (int i = 0; i < count; ++i) {
+        const auto folder = root / std::format("BenchMod{:03}", i / 8) / std::format("{:02} Stance", i % 8);
+        std::filesystem::create_directories(folder);
+        files.push_back(folder / "config.json");
+        const std::string text = ConfigText(i, rules);
+        std::ofstream(files.back(), std::ios::binary) << text;
+        bytes += text.size();
+    }
+
+    // Passada de conferência: os Documents do caminho antigo viram a referência
+    std::vector<rapidjson::Document> expected(files.size());
+    RunLegacy(files, &expected);
+    std::size_t parseMismatches = 0;
+    std::size_t insituMismatches = 0;
+    RunArena(files, false, &expected, parseMismatches);
+    RunArena(files, true, &expected, insituMismatches);
+
+    const Sample legacy = Best(runs, [&] { return RunLegacy(files, nullptr); });
+    std::size_t unused = 0;
+    const Sample parse = Best(runs, [&] { return RunArena(files, false, nullptr, unused); });
+    const Sample insitu = Best(runs, [&] { return RunArena(files, true, nullptr, unused); });
+
+    const double mb = static_cast<double>(bytes) / (1024.0 * 1024.0);
+    const auto mbps = [&](double ms) { return ms > 0 ? mb / (ms / 1000.0) : 0.0; };
+    const auto print = [&](const char* label, const Sample& sample) {
+        std::printf("%s %8.1f ms (%7.1f MB/s) | leitura %7.1f ms (%7.1f MB/s)\n", label, sample.totalMs,
+                    mbps(sample.totalMs), sample.readMs, mbps(sample.readMs));
+    };
+    std::printf("%zu config.json, %.1f MB, melhor de %d\n", files.size(), mb, runs);
+    print("istreambuf + Parse:         ", legacy);
+    print("Leitura única + Parse:      ", parse);
+    print("Leitura única + ParseInsitu:", insitu);
+    std::printf("Documents diferentes do caminho antigo: %zu (Parse), %zu (ParseInsitu)\n", parseMismatches,
+                insituMismatches);
+    return parseMismatches == 0 && insituMismatches == 0 ? 0 : 1;
+}
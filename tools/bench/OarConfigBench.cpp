@@ -0,0 +1,202 @@
+// Compara a geração do config.json gerenciado pelo caminho antigo (Parse do arquivo inteiro num
+// Document, alterar e Accept) com o OarConfigWriter (SAX do texto original direto para o Writer).
+// Os arquivos são gerados em memória, então só a geração é medida, sem disco. As duas saídas
+// são comparadas byte a byte. Os MB/s contam os bytes gerados.
+// Uso: OarConfigBench [arquivos=5000] [regras por arquivo=24] [condições do usuário=6]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <string>
+#include <vector>
+#include "OarConfigWriter.h"
+#include "SyntheticConditions.h"
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace {
+    using SyntheticConditions::Compare;
+    using SyntheticConditions::ManagedBlock;
+
+    // Um config.json como os que o manager já escreveu: membros do usuário, condições próprias
+    // e o bloco gerenciado da gravação anterior
+    std::string OriginalConfig(int index, int rules, int userConditions) {
+        rapidjson::Document doc;
+        doc.SetObject();
+        auto& allocator = doc.GetAllocator();
+        doc.AddMember("name", rapidjson::Value(std::format("{:02} Stance", index % 100).c_str(), allocator), allocator);
+        doc.AddMember("description", "Moveset gerado para o benchmark", allocator);
+        doc.AddMember("priority", 2100000000 + index, allocator);
+        doc.AddMember("interruptible", true, allocator);
+        doc.AddMember("replaceOnLoop", false, allocator);
+        rapidjson::Value conditions(rapidjson::kArrayType);
+        for (int c = 0; c < userConditions; ++c) {
+            conditions.PushBack(Compare("UserVariable", c, allocator), allocator);
+        }
+        conditions.PushBack(ManagedBlock(rules, index + 1, allocator), allocator);
+        doc.AddMember("conditions", conditions, allocator);
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        doc.Accept(writer);
+        return std::string(buffer.GetString(), buffer.GetSize());
+    }
+
+    // O UpdateOrCreateJson antes do OarConfigWriter, com o mesmo arena reaproveitado do JsonReader
+    class DomGenerator {
+    public:
+        DomGenerator() : _arena(64 * 1024), _pool(_arena.data(), _arena.size()), _doc(&_pool) {}
+
+        void Generate(const std::string& original, const std::string& name, int priority, int rules, int seed,
+                      const OarConfigWriter::Options& options, rapidjson::StringBuffer& out) {
+            _doc.SetNull();
+            _pool.Clear();
+            _doc.Parse(original.data(), original.size());
+            if (_doc.HasParseError() || !_doc.IsObject()) _doc.SetObject();
+            auto& allocator = _doc.GetAllocator();
+
+            if (_doc.HasMember("name")) {
+                _doc["name"].SetString(name.c_str(), allocator);
+            } else {
+                _doc.AddMember("name", rapidjson::Value(name.c_str(), allocator), allocator);
+            }
+            if (_doc.HasMember("priority")) {
+                _doc["priority"].SetInt(priority);
+            } else {
+                _doc.AddMember("priority", priority, allocator);
+            }
+
+            rapidjson::Value oldConditions(rapidjson::kArrayType);
+            if (options.preserveConditions && _doc.HasMember("conditions") && _doc["conditions"].IsArray()) {
+                for (auto& cond : _doc["conditions"].GetArray()) {
+                    if (cond.IsObject() && cond.HasMember("comment") &&
+                        cond["comment"] == "OAR_CYCLE_MANAGER_CONDITIONS") {
+                        continue;
+                    }
+                    oldConditions.PushBack(cond, allocator);
+                }
+            }
+            if (_doc.HasMember("conditions")) {
+                _doc["conditions"].SetArray();
+            } else {
+                _doc.AddMember("conditions", rapidjson::Value(rapidjson::kArrayType), allocator);
+            }
+            rapidjson::Value& conditions = _doc["conditions"];
+            if (options.preserveConditions && !oldConditions.Empty()) {
+                rapidjson::Value oldBlock(rapidjson::kObjectType);
+                oldBlock.AddMember("condition", "OR", allocator);
+                oldBlock.AddMember("comment", "Old Conditions", allocator);
+                oldBlock.AddMember("Conditions", oldConditions, allocator);
+                conditions.PushBack(oldBlock, allocator);
+            }
+            conditions.PushBack(ManagedBlock(rules, seed, allocator), allocator);
+            _peakPool = std::max(_peakPool, _pool.Size());
+
+            out.Clear();
+            if (options.compact) {
+                rapidjson::Writer<rapidjson::StringBuffer> writer(out);
+                _doc.Accept(writer);
+            } else {
+                rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(out);
+                _doc.Accept(writer);
+            }
+        }
+
+        std::size_t PeakPool() const { return _peakPool; }
+
+    private:
+        std::vector<char> _arena;
+        rapidjson::MemoryPoolAllocator<> _pool;
+        rapidjson::Document _doc;
+        std::size_t _peakPool = 0;
+    };
+
+    // O caminho novo: só o bloco gerenciado vira Value, num pool limpo a cada arquivo
+    class StreamGenerator {
+    public:
+        StreamGenerator() : _arena(64 * 1024), _pool(_arena.data(), _arena.size()) {}
+
+        void Generate(const std::string& original, const std::string& name, int priority, int rules, int seed,
+                      const OarConfigWriter::Options& options, rapidjson::StringBuffer& out) {
+            _pool.Clear();
+            const rapidjson::Value managed = ManagedBlock(rules, seed, _pool);
+            _peakPool = std::max(_peakPool, _pool.Size());
+            OarConfigWriter::Write(original, name, priority, &managed, options, out);
+        }
+
+        std::size_t PeakPool() const { return _peakPool; }
+
+    private:
+        std::vector<char> _arena;
+        rapidjson::MemoryPoolAllocator<> _pool;
+        std::size_t _peakPool = 0;
+    };
+
+    struct Sample {
+        double ms = 0;
+        std::size_t bytes = 0;
+    };
+
+    template <class Generator>
+    Sample Run(Generator& generator, const std::vector<std::string>& originals, int rules,
+               const OarConfigWriter::Options& options, std::vector<std::string>& outputs) {
+        Sample sample;
+        rapidjson::StringBuffer buffer;
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < originals.size(); ++i) {
+            const int seed = static_cast<int>(i) * 7;
+            generator.Generate(originals[i], std::format("{:02} Stance", i % 100), 2100000001, rules, seed, options,
+                               buffer);
+            sample.bytes += buffer.GetSize();
+            outputs[i].assign(buffer.GetString(), buffer.GetSize());
+        }
+        sample.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return sample;
+    }
+
+    double MBps(const Sample& sample) {
+        return sample.ms > 0 ? static_cast<double>(sample.bytes) / (1024.0 * 1024.0) / (sample.ms / 1000.0) : 0.0;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int files = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5000;
+    const int rules = argc > 2 ? std::max(1, std::atoi(argv[2])) : 24;
+    const int userConditions = argc > 3 ? std::max(0, std::atoi(argv[3])) : 6;
+
+    std::vector<std::string> originals;
+    originals.reserve(files);
+    std::size_t inputBytes = 0;
+    for (int i = 0; i < files; ++i) {
+        originals.push_back(OriginalConfig(i, rules, userConditions));
+        inputBytes += originals.back().size();
+    }
+    std::printf("%d arquivos, %d regras cada, %d condições do usuário, %.1f MB de entrada\n", files, rules,
+                userConditions, static_cast<double>(inputBytes) / (1024.0 * 1024.0));
+
+    std::vector<std::string> domOutputs(originals.size());
+    std::vector<std::string> streamOutputs(originals.size());
+    for (const bool compact : {false, true}) {
+        for (const bool preserve : {false, true}) {
+            const OarConfigWriter::Options options{preserve, compact};
+            DomGenerator dom;
+            StreamGenerator stream;
+            const Sample domSample = Run(dom, originals, rules, options, domOutputs);
+            const Sample streamSample = Run(stream, originals, rules, options, streamOutputs);
+            std::size_t mismatches = 0;
+            for (std::size_t i = 0; i < originals.size(); ++i) {
+                if (domOutputs[i] != streamOutputs[i]) ++mismatches;
+            }
+            std::printf(
+                "[%s, %s] DOM: %.1f ms (%.1f MB/s, pool máx %zu KB) | SAX: %.1f ms (%.1f MB/s, pool máx %zu KB) | "
+                "%zu saídas diferentes\n",
+                compact ? "compacto" : "indentado", preserve ? "preserva condições" : "sem condições antigas",
+                domSample.ms, MBps(domSample), dom.PeakPool() / 1024, streamSample.ms, MBps(streamSample),
+                stream.PeakPool() / 1024, mismatches);
+        }
+    }
+    return 0;
+}
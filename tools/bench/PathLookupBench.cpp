@@ -0,0 +1,127 @@
+// Mede a resolução dos sourceConfigPath do User_CycleMoveset.json no LoadCycleMovesets: a busca antiga
+// (percorre a biblioteca inteira com std::filesystem::equivalent, dois stats por candidato) contra o
+// SubmovesetTable::FindByPath (chave normalizada num hash, sem disco). As pastas dos sub-movesets são
+// criadas de verdade porque a busca antiga precisa delas. A busca antiga roda só sobre as primeiras
+// entradas, que também servem para conferir que as duas dão o mesmo (mod, sub).
+// Uso: PathLookupBench <pasta vazia> [sub-movesets=20000] [entradas=5000] [entradas na busca antiga=50]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Settings.h"
+#include "SubmovesetTable.h"
+
+namespace {
+    constexpr int kSubsPerMod = 20;
+
+    using Indices = std::optional<std::pair<std::size_t, std::size_t>>;
+
+    // O FindSubAnimationByPath antes do índice
+    Indices LegacyFind(const std::vector<AnimationModDef>& mods, const std::filesystem::path& configPath,
+                       std::size_t& equivalentCalls) {
+        for (std::size_t modIdx = 0; modIdx < mods.size(); ++modIdx) {
+            const auto& mod = mods[modIdx];
+            for (std::size_t subIdx = 0; subIdx < mod.subAnimations.size(); ++subIdx) {
+                ++equivalentCalls;
+                if (std::filesystem::equivalent(mod.subAnimations[subIdx].path.get(), configPath)) {
+                    return std::make_pair(modIdx, subIdx);
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    Indices IndexedFind(const SubmovesetTable& table, const std::filesystem::path& configPath) {
+        const SubmovesetId id = table.FindByPath(configPath);
+        if (id == kInvalidSubmoveset) return std::nullopt;
+        return std::make_pair(table.ModIndexOf(id), table.SubIndexOf(id));
+    }
+
+    double ElapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("Uso: %s <pasta vazia> [sub-movesets=20000] [entradas=5000] [entradas na busca antiga=50]\n",
+                    argv[0]);
+        return 1;
+    }
+    const std::filesystem::path root = std::filesystem::absolute(argv[1]);
+    const int subCount = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20000;
+    const int entryCount = argc > 3 ? std::max(1, std::atoi(argv[3])) : 5000;
+    const int legacyCount = std::min(entryCount, argc > 4 ? std::max(1, std::atoi(argv[4])) : 50);
+
+    std::error_code ec;
+    if (std::filesystem::exists(root, ec) && !std::filesystem::is_empty(root, ec)) {
+        std::printf("%s não está vazia.\n", root.string().c_str());
+        return 1;
+    }
+
+    // Biblioteca como a do scan: um AnimationModDef por mod, com a pasta de cada sub-moveset
+    std::vector<AnimationModDef> mods;
+    for (int i = 0; i < subCount; ++i) {
+        if (i % kSubsPerMod == 0) {
+            auto& mod = mods.emplace_back();
+            mod.name = std::format("Bench Moveset {:04}", i / kSubsPerMod);
+            mod.path = root / mod.name;
+        }
+        auto& mod = mods.back();
+        const auto folder = mod.path / std::format("{:02} Stance", i % kSubsPerMod);
+        std::filesystem::create_directories(folder);
+        auto& sub = mod.subAnimations.emplace_back();
+        sub.name = folder.filename().string();
+        sub.path = folder;
+        sub.hasAnimations = true;
+    }
+
+    SubmovesetTable table;
+    const auto syncStart = std::chrono::steady_clock::now();
+    table.Sync(mods);
+    const double syncMs = ElapsedMs(syncStart);
+
+    // Entradas salvas apontam para sub-movesets espalhados pela biblioteca, no formato do sourceConfigPath
+    std::mt19937 rng(42);
+    std::vector<std::string> entries;
+    entries.reserve(entryCount);
+    for (int i = 0; i < entryCount; ++i) {
+        const auto& mod = mods[rng() % mods.size()];
+        entries.push_back(mod.subAnimations[rng() % mod.subAnimations.size()].path.get().string());
+    }
+
+    std::vector<Indices> indexed(entries.size());
+    const auto indexedStart = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < entries.size(); ++i) indexed[i] = IndexedFind(table, entries[i]);
+    const double indexedMs = ElapsedMs(indexedStart);
+
+    std::size_t equivalentCalls = 0;
+    std::size_t mismatches = 0;
+    const auto legacyStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < legacyCount; ++i) {
+        if (LegacyFind(mods, entries[i], equivalentCalls) != indexed[i]) ++mismatches;
+    }
+    const double legacyMs = ElapsedMs(legacyStart);
+
+    std::size_t unresolved = 0;
+    for (const auto& found : indexed) unresolved += !found;
+
+    const double legacyPerEntry = legacyMs / legacyCount;
+    const double indexedPerEntry = indexedMs / static_cast<double>(entries.size());
+    std::printf("%d sub-movesets em %zu mods, %zu entradas; Sync do SubmovesetTable: %.1f ms\n", subCount,
+                mods.size(), entries.size(), syncMs);
+    std::printf("Busca antiga (%d entradas): %.3f ms/entrada, %.0f equivalent()/entrada; %zu entradas levariam %.1f s\n",
+                legacyCount, legacyPerEntry, static_cast<double>(equivalentCalls) / legacyCount, entries.size(),
+                legacyPerEntry * static_cast<double>(entries.size()) / 1000.0);
+    std::printf("FindByPath: %.1f ms no total, %.2f us/entrada, sem chamadas ao disco (%.0fx)\n", indexedMs,
+                indexedPerEntry * 1000.0, indexedPerEntry > 0 ? legacyPerEntry / indexedPerEntry : 0.0);
+    std::printf("%zu entradas sem sub-moveset, %zu resultados diferentes da busca antiga\n", unresolved, mismatches);
+    return mismatches == 0 && unresolved == 0 ? 0 : 1;
+}
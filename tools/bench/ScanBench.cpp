@@ -0,0 +1,179 @@
+// Mede o scan da biblioteca sobre uma árvore do GenerateTree, fora do jogo. Roda os mesmos walks
+// do ScanAnimationMods/ScanDarAnimations (LibraryWalker + ScanIndex + WorkStealingPool) e a leitura
+// dos arquivos de regra que o LoadCycleMovesets faz, primeiro a frio (sem índice, como a primeira
+// execução) e depois a quente com o índice salvo, e imprime tempo e chamadas ao disco por fase.
+// Uso: ScanBench <pasta Data> [repetições a quente=3]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "LibraryWalker.h"
+#include "ManagedManifest.h"
+#include "ScanIndex.h"
+#include "ThreadPool.h"
+#include "rapidjson/document.h"
+
+// Definidas em Hooks.cpp e ManagedManifest.cpp, que dependem do jogo e da Win32.
+// O benchmark nunca importa CycleDar (os walks do scan são só leitura).
+bool ProcessCycleDarFile(const std::filesystem::path&) { return false; }
+
+bool ManagedManifest::FileContainsMarker(const std::filesystem::path& configPath) {
+    FsCounters::fileReads.fetch_add(1, std::memory_order_relaxed);
+    std::ifstream in(configPath, std::ios::binary);
+    const std::string text(std::istreambuf_iterator<char>(in), {});
+    return text.find(kMarker) != std::string::npos;
+}
+
+namespace {
+    struct PhaseSample {
+        std::string name;
+        long long ms = 0;
+        FsCounters::Snapshot fs;
+    };
+
+    struct ScanTotals {
+        std::size_t subMovesets = 0;
+        std::size_t darSubMovesets = 0;
+        std::size_t managed = 0;
+        std::vector<std::filesystem::path> ruleFiles;
+    };
+
+    bool ReadJson(const std::filesystem::path& path, rapidjson::Document& doc) {
+        FsCounters::fileReads.fetch_add(1, std::memory_order_relaxed);
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        const std::string text(std::istreambuf_iterator<char>(in), {});
+        doc.Parse(text.data(), text.size());
+        return !doc.HasParseError();
+    }
+
+    class Bench {
+    public:
+        explicit Bench(std::filesystem::path data) : _data(std::move(data)) {}
+
+        // Uma passada completa; readManagedMarker reproduz a primeira execução (sem manifesto).
+        std::vector<PhaseSample> Run(bool warm, bool readManagedMarker, ScanTotals& totals) {
+            const auto indexPath = _data / "SKSE/Plugins/CycleMovesets/ScanIndex.bin";
+            std::vector<PhaseSample> samples;
+            ScanIndex index;
+            WorkStealingPool pool;
+
+            Phase(samples, "Index", [&] {
+                if (warm) index.Load(indexPath);
+            });
+            Phase(samples, "DAR", [&] {
+                LibraryWalker walker(WalkRoot::DAR, &index, &pool, false, false);
+                for (const auto& folder : walker.Walk(_data / "meshes/actors/character/animations/"
+                                                              "DynamicAnimationReplacer/_CustomConditions")) {
+                    if (!folder.ruleFile.empty()) totals.ruleFiles.push_back(folder.ruleFile);
+                    if (folder.depth == 1 && folder.tags.hasAnimations) ++totals.darSubMovesets;
+                }
+            });
+            Phase(samples, "OAR", [&] { WalkOar(index, pool, readManagedMarker, totals); });
+            Phase(samples, "Movesets", [&] {
+                for (const auto& ruleFile : totals.ruleFiles) {
+                    rapidjson::Document doc;
+                    if (!ReadJson(ruleFile, doc) || !doc.IsArray()) {
+                        SKSE::log::warn("Arquivo de regra inválido: {}", ruleFile.string());
+                    }
+                }
+            });
+            Phase(samples, "Save", [&] { index.Save(indexPath); });
+            return samples;
+        }
+
+    private:
+        void Phase(std::vector<PhaseSample>& samples, const char* name, const std::function<void()>& fn) {
+            const auto counters = FsCounters::Take();
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            const auto ms =
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            samples.push_back({name, ms, FsCounters::Take() - counters});
+        }
+
+        // Mesmo trabalho do ProcessTopLevelMod: um walk por mod de topo e o cabeçalho do config.json
+        void WalkOar(ScanIndex& index, WorkStealingPool& pool, bool readManagedMarker, ScanTotals& totals) {
+            std::vector<std::filesystem::path> topLevelMods;
+            FsCounters::listings.fetch_add(1, std::memory_order_relaxed);
+            std::error_code ec;
+            const auto root = _data / "meshes/actors/character/animations/OpenAnimationReplacer";
+            for (std::filesystem::directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+                if (it->is_directory(ec)) topLevelMods.push_back(it->path());
+            }
+
+            std::vector<std::vector<WalkedFolder>> walked(topLevelMods.size());
+            pool.ParallelFor(topLevelMods.size(), [&](std::size_t i) {
+                LibraryWalker walker(WalkRoot::OAR, &index, &pool, readManagedMarker, false);
+                walked[i] = walker.Walk(topLevelMods[i]);
+
+                const auto configPath = topLevelMods[i] / "config.json";
+                std::string name, author;
+                if (!index.TryGetModHeader(configPath, name, author)) {
+                    rapidjson::Document doc;
+                    if (ReadJson(configPath, doc) && doc.IsObject() && doc.HasMember("name") &&
+                        doc.HasMember("author")) {
+                        index.PutModHeader(configPath, doc["name"].GetString(), doc["author"].GetString());
+                    }
+                }
+            });
+
+            for (const auto& folders : walked) {
+                for (const auto& folder : folders) {
+                    if (!folder.ruleFile.empty()) totals.ruleFiles.push_back(folder.ruleFile);
+                    if (folder.depth == 0 || !folder.Has(FolderFlags::kConfig)) continue;
+                    ++totals.subMovesets;
+                    if (folder.hasManagedMarker) ++totals.managed;
+                }
+            }
+        }
+
+        std::filesystem::path _data;
+    };
+
+    // Mesmo formato do "[Scan] Resumo" do plugin, para comparar com os números de um boot real
+    void PrintSummary(const char* label, const std::vector<PhaseSample>& samples, const ScanTotals& totals) {
+        std::string summary;
+        long long total = 0;
+        for (const auto& sample : samples) {
+            summary += std::format("{}{}={}ms [{}L {}E {}S {}R]", summary.empty() ? "" : " | ", sample.name,
+                                   sample.ms, sample.fs.listings, sample.fs.entries, sample.fs.stats,
+                                   sample.fs.fileReads);
+            total += sample.ms;
+        }
+        SKSE::log::info("[{}] {} | Total={}ms | {} sub-movesets OAR ({} gerenciados), {} DAR, {} arquivos de regra",
+                        label, summary, total, totals.subMovesets, totals.managed, totals.darSubMovesets,
+                        totals.ruleFiles.size());
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("Uso: %s <pasta Data> [repetições a quente=3]\n", argv[0]);
+        return 1;
+    }
+    const std::filesystem::path data = argv[1];
+    const int warmRuns = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+    if (!std::filesystem::is_directory(data / "meshes")) {
+        std::printf("%s não tem uma pasta meshes. Gere a árvore com o GenerateTree.\n", data.string().c_str());
+        return 1;
+    }
+
+    Bench bench(data);
+    std::error_code ec;
+    std::filesystem::remove(data / "SKSE/Plugins/CycleMovesets/ScanIndex.bin", ec);
+
+    ScanTotals coldTotals;
+    PrintSummary("Frio", bench.Run(false, true, coldTotals), coldTotals);
+    for (int run = 1; run <= warmRuns; ++run) {
+        ScanTotals warmTotals;
+        PrintSummary(std::format("Quente {}", run).c_str(), bench.Run(true, false, warmTotals), warmTotals);
+    }
+    return 0;
+}
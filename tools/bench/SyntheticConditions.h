@@ -0,0 +1,44 @@
+#pragma once
+// Condições no formato que o UpdateOrCreateJson gera, para os benchmarks que montam config.json.
+#include "rapidjson/document.h"
+
+namespace SyntheticConditions {
+    using Allocator = rapidjson::Document::AllocatorType;
+
+    // Mesmo layout do AddCompareValuesCondition: o valor em "Value A", a variável em "Value B"
+    inline rapidjson::Value Compare(const char* variable, int value, Allocator& allocator) {
+        rapidjson::Value condition(rapidjson::kObjectType);
+        condition.AddMember("condition", "CompareValues", allocator);
+        condition.AddMember("requiredVersion", "1.0.0.0", allocator);
+        rapidjson::Value valueA(rapidjson::kObjectType);
+        valueA.AddMember("value", value, allocator);
+        condition.AddMember("Value A", valueA, allocator);
+        condition.AddMember("Comparison", "==", allocator);
+        rapidjson::Value valueB(rapidjson::kObjectType);
+        valueB.AddMember("graphVariable", rapidjson::Value(variable, allocator), allocator);
+        valueB.AddMember("graphVariableType", "Int", allocator);
+        condition.AddMember("Value B", valueB, allocator);
+        return condition;
+    }
+
+    // Um AND por regra sob o OR mestre com o marcador; 'seed' muda os valores de playlist
+    inline rapidjson::Value ManagedBlock(int rules, int seed, Allocator& allocator) {
+        rapidjson::Value block(rapidjson::kObjectType);
+        block.AddMember("condition", "OR", allocator);
+        block.AddMember("comment", "OAR_CYCLE_MANAGER_CONDITIONS", allocator);
+        rapidjson::Value branches(rapidjson::kArrayType);
+        for (int r = 0; r < rules; ++r) {
+            rapidjson::Value andBlock(rapidjson::kObjectType);
+            andBlock.AddMember("condition", "AND", allocator);
+            rapidjson::Value conditions(rapidjson::kArrayType);
+            conditions.PushBack(Compare("CycleMovesetNpcType", r % 4, allocator), allocator);
+            conditions.PushBack(Compare("cycle_instance", 1 + r % 4, allocator), allocator);
+            conditions.PushBack(Compare("testarone", 1 + (seed + r) % 12, allocator), allocator);
+            conditions.PushBack(Compare("DirecionalCycleMoveset", 1 + r % 8, allocator), allocator);
+            andBlock.AddMember("Conditions", conditions, allocator);
+            branches.PushBack(andBlock, allocator);
+        }
+        block.AddMember("Conditions", branches, allocator);
+        return block;
+    }
+}
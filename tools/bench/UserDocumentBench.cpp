@@ -0,0 +1,332 @@
+// Monta os documentos User_CycleMoveset do SaveCycleMovesets de duas formas: a antiga, que varre os
+// arrays do documento atrás do perfil (FormID), da categoria e da stance a cada sub-animação e busca
+// o documento três vezes no map, e a atual, com os índices por posição montados junto com o
+// documento. As duas saídas são serializadas e comparadas documento a documento.
+// Uso: UserDocumentBench [regras de NPC=500] [categorias=20] [repetições=5]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace {
+    constexpr int kMods = 30;
+    constexpr int kSubsPerMod = 4;
+    constexpr int kModsPerStance = 2;
+    constexpr int kSubsPerMoveset = 2;
+
+    struct SubAnimation {
+        std::string name;
+        std::filesystem::path path;  // Pasta do config.json
+    };
+
+    struct Mod {
+        std::string name;
+        std::vector<SubAnimation> subs;
+    };
+
+    struct Actor {
+        std::string type, name, formID, plugin, identifier;
+        int stances = 1;
+    };
+
+    // Uma sub-animação selecionada, na ordem em que o SaveCycleMovesets as visita
+    struct Selection {
+        int actor = 0;
+        int category = 0;
+        int stance = 0;
+        int mod = 0;
+        int order = 0;  // mod_idx + 1
+        int sub = 0;
+        int animationIndex = 0;
+    };
+
+    struct Library {
+        std::vector<Mod> mods;
+        std::vector<Actor> actors;
+        std::vector<std::string> categories;
+        std::vector<Selection> selections;
+    };
+
+    // Jogador com 4 stances, a regra geral e 'rules' regras de NPC com 1 stance cada; toda categoria
+    // de todo ator tem 2 movesets com 2 sub-animações, cada moveset de um mod diferente
+    Library MakeLibrary(int rules, int categories) {
+        Library library;
+        for (int m = 0; m < kMods; ++m) {
+            Mod mod{std::format("Bench Moveset {:02}", m), {}};
+            for (int s = 0; s < kSubsPerMod; ++s) {
+                const auto folder = std::filesystem::path("Data/meshes/actors/character/animations/OpenAnimationReplacer") /
+                                    mod.name / std::format("{:02} Stance", s);
+                mod.subs.push_back({std::format("{:02} Stance", s), folder});
+            }
+            library.mods.push_back(std::move(mod));
+        }
+        for (int c = 0; c < categories; ++c) library.categories.push_back(std::format("Category {:02}", c));
+
+        library.actors.push_back({"Player", "Player", "00000007", "Skyrim.esm", "Player", 4});
+        library.actors.push_back({"GeneralNPC", "General NPC", "00000000", "", "GeneralNPC", 1});
+        for (int r = 0; r < rules; ++r) {
+            library.actors.push_back({"UniqueNPC", std::format("NPC {}", r), std::format("{:08X}", 0x0001A000 + r * 3),
+                                      "Skyrim.esm", std::format("NPC{}", r), 1});
+        }
+
+        for (int a = 0; a < static_cast<int>(library.actors.size()); ++a) {
+            for (int c = 0; c < categories; ++c) {
+                for (int i = 0; i < library.actors[a].stances; ++i) {
+                    for (int k = 0; k < kModsPerStance; ++k) {
+                        const int mod = (a * 7 + c * 3 + i + k * 11) % kMods;
+                        for (int s = 0; s < kSubsPerMoveset; ++s) {
+                            library.selections.push_back({a, c, i, mod, k + 1, (a + c + s) % kSubsPerMod, s + 1});
+                        }
+                    }
+                }
+            }
+        }
+        return library;
+    }
+
+    std::filesystem::path DestinationOf(const Library& library, const Selection& selection) {
+        return library.mods[selection.mod].subs[selection.sub].path.parent_path() / "User_CycleMoveset.json";
+    }
+
+    rapidjson::Value NewProfile(const Actor& actor, rapidjson::Document::AllocatorType& allocator) {
+        rapidjson::Value profile(rapidjson::kObjectType);
+        profile.AddMember("Type", rapidjson::Value(actor.type.c_str(), allocator), allocator);
+        profile.AddMember("Name", rapidjson::Value(actor.name.c_str(), allocator), allocator);
+        profile.AddMember("FormID", rapidjson::Value(actor.formID.c_str(), allocator), allocator);
+        profile.AddMember("Plugin", rapidjson::Value(actor.plugin.c_str(), allocator), allocator);
+        profile.AddMember("Identifier", rapidjson::Value(actor.identifier.c_str(), allocator), allocator);
+        profile.AddMember("Menu", rapidjson::kArrayType, allocator);
+        return profile;
+    }
+
+    rapidjson::Value NewCategory(const std::string& name, rapidjson::Document::AllocatorType& allocator) {
+        rapidjson::Value category(rapidjson::kObjectType);
+        category.AddMember("Category", rapidjson::Value(name.c_str(), allocator), allocator);
+        category.AddMember("stances", rapidjson::kArrayType, allocator);
+        return category;
+    }
+
+    rapidjson::Value NewStance(const Library& library, const Selection& selection,
+                               rapidjson::Document::AllocatorType& allocator) {
+        rapidjson::Value stance(rapidjson::kObjectType);
+        stance.AddMember("index", selection.stance + 1, allocator);
+        stance.AddMember("type", "moveset", allocator);
+        stance.AddMember("name", rapidjson::Value(library.mods[selection.mod].name.c_str(), allocator), allocator);
+        stance.AddMember("level", 1, allocator);
+        stance.AddMember("hp", 0, allocator);
+        stance.AddMember("st", 0, allocator);
+        stance.AddMember("mn", 0, allocator);
+        stance.AddMember("order", selection.order, allocator);
+        stance.AddMember("animations", rapidjson::kArrayType, allocator);
+        return stance;
+    }
+
+    rapidjson::Value NewAnimation(const Library& library, const Selection& selection,
+                                  rapidjson::Document::AllocatorType& allocator) {
+        const auto& mod = library.mods[selection.mod];
+        const auto& sub = mod.subs[selection.sub];
+        rapidjson::Value animation(rapidjson::kObjectType);
+        animation.AddMember("index", selection.animationIndex, allocator);
+        animation.AddMember("sourceModName", rapidjson::Value(mod.name.c_str(), allocator), allocator);
+        animation.AddMember("sourceSubName", rapidjson::Value(sub.name.c_str(), allocator), allocator);
+        animation.AddMember("hasDPA_A", false, allocator);
+        animation.AddMember("hasDPA_B", false, allocator);
+        animation.AddMember("hasDPA_L", false, allocator);
+        animation.AddMember("hasDPA_R", false, allocator);
+        animation.AddMember("hasCPA", false, allocator);
+        animation.AddMember("sourceConfigPath", rapidjson::Value(sub.path.string().c_str(), allocator), allocator);
+        for (const char* direction : {"pFront", "pBack", "pLeft", "pRight", "pFrontRight", "pFrontLeft", "pBackRight",
+                                      "pBackLeft", "pRandom", "pDodge"}) {
+            animation.AddMember(rapidjson::StringRef(direction), selection.animationIndex == 1, allocator);
+        }
+        return animation;
+    }
+
+    struct CategoryIndex {
+        rapidjson::SizeType position = 0;
+        std::unordered_map<std::string, rapidjson::SizeType> stances;  // "<index>|<nome do mod>"
+    };
+    struct ProfileIndex {
+        rapidjson::SizeType position = 0;
+        std::unordered_map<std::string, CategoryIndex> categories;
+    };
+    struct UserDocument {
+        rapidjson::Document doc;
+        std::unordered_map<std::string, ProfileIndex> profiles;
+    };
+
+    using LinearDocuments = std::map<std::filesystem::path, std::unique_ptr<rapidjson::Document>>;
+    using IndexedDocuments = std::map<std::filesystem::path, std::unique_ptr<UserDocument>>;
+    using Output = std::map<std::filesystem::path, std::string>;
+
+    std::string Serialize(const rapidjson::Document& doc) {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        doc.Accept(writer);
+        return std::string(buffer.GetString(), buffer.GetSize());
+    }
+
+    // O SaveCycleMovesets antes dos índices
+    LinearDocuments BuildLinear(const Library& library) {
+        LinearDocuments documents;
+        for (const auto& selection : library.selections) {
+            const Actor& actor = library.actors[selection.actor];
+            const std::string& categoryName = library.categories[selection.category];
+            const std::string& modName = library.mods[selection.mod].name;
+            const std::filesystem::path destJsonPath = DestinationOf(library, selection);
+
+            if (documents.find(destJsonPath) == documents.end()) {
+                documents[destJsonPath] = std::make_unique<rapidjson::Document>();
+                documents[destJsonPath]->SetArray();
+            }
+            rapidjson::Document& doc = *documents[destJsonPath];
+            auto& allocator = doc.GetAllocator();
+
+            rapidjson::Value* profileObj = nullptr;
+            for (auto& item : doc.GetArray()) {
+                if (item.IsObject() && item.HasMember("FormID") && item["FormID"].GetString() == actor.formID) {
+                    profileObj = &item;
+                    break;
+                }
+            }
+            if (!profileObj) {
+                doc.PushBack(NewProfile(actor, allocator), allocator);
+                profileObj = &doc.GetArray()[doc.GetArray().Size() - 1];
+            }
+
+            rapidjson::Value& menuArray = (*profileObj)["Menu"];
+            rapidjson::Value* categoryObj = nullptr;
+            for (auto& item : menuArray.GetArray()) {
+                if (item.IsObject() && item.HasMember("Category") && item["Category"].GetString() == categoryName) {
+                    categoryObj = &item;
+                    break;
+                }
+            }
+            if (!categoryObj) {
+                menuArray.PushBack(NewCategory(categoryName, allocator), allocator);
+                categoryObj = &menuArray.GetArray()[menuArray.GetArray().Size() - 1];
+            }
+
+            rapidjson::Value& stancesArray = (*categoryObj)["stances"];
+            rapidjson::Value* stanceObj = nullptr;
+            for (auto& item : stancesArray.GetArray()) {
+                if (item.IsObject() && item["index"].GetInt() == (selection.stance + 1) && item.HasMember("name") &&
+                    std::strcmp(item["name"].GetString(), modName.c_str()) == 0) {
+                    stanceObj = &item;
+                    break;
+                }
+            }
+            if (!stanceObj) {
+                stancesArray.PushBack(NewStance(library, selection, allocator), allocator);
+                stanceObj = &stancesArray.GetArray()[stancesArray.GetArray().Size() - 1];
+            }
+
+            (*stanceObj)["animations"].PushBack(NewAnimation(library, selection, allocator), allocator);
+        }
+
+        return documents;
+    }
+
+    // O SaveCycleMovesets atual: posições guardadas por FormID, categoria e stance
+    IndexedDocuments BuildIndexed(const Library& library) {
+        IndexedDocuments documents;
+        for (const auto& selection : library.selections) {
+            const Actor& actor = library.actors[selection.actor];
+            const std::string& categoryName = library.categories[selection.category];
+            const std::string stanceKey = std::format("{}|{}", selection.stance + 1, library.mods[selection.mod].name);
+
+            auto [docIt, docInserted] = documents.try_emplace(DestinationOf(library, selection));
+            if (docInserted) {
+                docIt->second = std::make_unique<UserDocument>();
+                docIt->second->doc.SetArray();
+            }
+            UserDocument& userDoc = *docIt->second;
+            rapidjson::Document& doc = userDoc.doc;
+            auto& allocator = doc.GetAllocator();
+
+            auto [profileIt, profileInserted] = userDoc.profiles.try_emplace(actor.formID);
+            ProfileIndex& profileIndex = profileIt->second;
+            if (profileInserted) {
+                profileIndex.position = doc.Size();
+                doc.PushBack(NewProfile(actor, allocator), allocator);
+            }
+
+            rapidjson::Value& menuArray = doc[profileIndex.position]["Menu"];
+            auto [categoryIt, categoryInserted] = profileIndex.categories.try_emplace(categoryName);
+            CategoryIndex& categoryIndex = categoryIt->second;
+            if (categoryInserted) {
+                categoryIndex.position = menuArray.Size();
+                menuArray.PushBack(NewCategory(categoryName, allocator), allocator);
+            }
+
+            rapidjson::Value& stancesArray = menuArray[categoryIndex.position]["stances"];
+            auto [stanceIt, stanceInserted] = categoryIndex.stances.try_emplace(stanceKey);
+            if (stanceInserted) {
+                stanceIt->second = stancesArray.Size();
+                stancesArray.PushBack(NewStance(library, selection, allocator), allocator);
+            }
+
+            stancesArray[stanceIt->second]["animations"].PushBack(NewAnimation(library, selection, allocator),
+                                                                  allocator);
+        }
+
+        return documents;
+    }
+
+    // Só a montagem é medida; a serialização para comparar fica fora do tempo
+    template <class Documents, class Fn>
+    double BestMs(int runs, Documents& documents, Fn&& fn) {
+        double best = 0;
+        for (int run = 0; run < runs; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            documents = fn();
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (run == 0 || ms < best) best = ms;
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int rules = argc > 1 ? std::max(0, std::atoi(argv[1])) : 500;
+    const int categories = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+    const int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 5;
+
+    const Library library = MakeLibrary(rules, categories);
+    LinearDocuments linearDocuments;
+    IndexedDocuments indexedDocuments;
+    const double linearMs = BestMs(runs, linearDocuments, [&] { return BuildLinear(library); });
+    const double indexedMs = BestMs(runs, indexedDocuments, [&] { return BuildIndexed(library); });
+
+    Output linear;
+    Output indexed;
+    for (const auto& [path, doc] : linearDocuments) linear.emplace(path, Serialize(*doc));
+    for (const auto& [path, userDoc] : indexedDocuments) indexed.emplace(path, Serialize(userDoc->doc));
+
+    std::size_t bytes = 0;
+    for (const auto& [path, text] : indexed) bytes += text.size();
+    std::size_t mismatches = linear.size() == indexed.size() ? 0 : 1;
+    for (const auto& [path, text] : indexed) {
+        const auto it = linear.find(path);
+        if (it == linear.end() || it->second != text) ++mismatches;
+    }
+
+    std::printf("%zu atores, %d categorias, %zu sub-animações selecionadas, %zu documentos (%.1f MB), melhor de %d\n",
+                library.actors.size(), categories, library.selections.size(), indexed.size(),
+                static_cast<double>(bytes) / (1024.0 * 1024.0), runs);
+    std::printf("Varredura dos arrays: %.1f ms\n", linearMs);
+    std::printf("Índices por posição:  %.1f ms (%.1fx)\n", indexedMs, indexedMs > 0 ? linearMs / indexedMs : 0.0);
+    std::printf("%zu documentos diferentes\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
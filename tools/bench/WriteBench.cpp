@@ -0,0 +1,122 @@
+// Mede a gravação dos config.json do SaveAllSettings: para cada arquivo, ler o texto atual, gerar o
+// bloco gerenciado, passar pelo OarConfigWriter, comparar e gravar só se mudou. Roda sequencial
+// (como era na thread de render) e em paralelo no WorkStealingPool (como o WriteConfigFiles faz),
+// e depois uma passada sem mudanças, em que toda escrita é pulada.
+// Uso: WriteBench <pasta vazia> [arquivos=1000] [regras por arquivo=24]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "OarConfigWriter.h"
+#include "SyntheticConditions.h"
+#include "ThreadPool.h"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+
+namespace {
+    enum class WriteResult { kWritten, kSkipped, kFailed };
+
+    struct PassTotals {
+        std::atomic<std::size_t> written{0};
+        std::atomic<std::size_t> skipped{0};
+        std::atomic<std::size_t> failed{0};
+    };
+
+    // O mesmo trabalho do UpdateOrCreateJson para um arquivo; 'revision' muda o bloco gerenciado
+    WriteResult UpdateConfig(const std::filesystem::path& path, int rules, int revision) {
+        thread_local rapidjson::Document managedDoc;
+        thread_local rapidjson::StringBuffer buffer;
+
+        std::string original;
+        if (std::ifstream in(path, std::ios::binary); in) {
+            original.assign(std::istreambuf_iterator<char>(in), {});
+        }
+        managedDoc.SetNull();
+        managedDoc.GetAllocator().Clear();
+        const rapidjson::Value managed = SyntheticConditions::ManagedBlock(rules, revision, managedDoc.GetAllocator());
+        OarConfigWriter::Write(original, path.parent_path().filename().string(), 2100000001, &managed, {}, buffer);
+        if (original.size() == buffer.GetSize() && original.compare(0, original.size(), buffer.GetString()) == 0) {
+            return WriteResult::kSkipped;
+        }
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(buffer.GetString(), static_cast<std::streamsize>(buffer.GetSize()));
+        out.close();
+        return out ? WriteResult::kWritten : WriteResult::kFailed;
+    }
+
+    void Count(PassTotals& totals, WriteResult result) {
+        switch (result) {
+            case WriteResult::kWritten:
+                totals.written.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case WriteResult::kSkipped:
+                totals.skipped.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case WriteResult::kFailed:
+                totals.failed.fetch_add(1, std::memory_order_relaxed);
+                break;
+        }
+    }
+
+    void RunPass(const char* label, const std::vector<std::filesystem::path>& files, int rules, int revision,
+                 WorkStealingPool* pool) {
+        PassTotals totals;
+        const auto start = std::chrono::steady_clock::now();
+        auto update = [&](std::size_t i) { Count(totals, UpdateConfig(files[i], rules, revision)); };
+        if (pool) {
+            pool->ParallelFor(files.size(), update);
+        } else {
+            for (std::size_t i = 0; i < files.size(); ++i) update(i);
+        }
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        SKSE::log::info("{}: {:.1f} ms, {:.0f} arquivos/s | {} gravados, {} inalterados, {} falharam", label, ms,
+                        ms > 0 ? static_cast<double>(files.size()) * 1000.0 / ms : 0.0, totals.written.load(),
+                        totals.skipped.load(), totals.failed.load());
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("Uso: %s <pasta vazia> [arquivos=1000] [regras por arquivo=24]\n", argv[0]);
+        return 1;
+    }
+    const std::filesystem::path root = argv[1];
+    const int count = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1000;
+    const int rules = argc > 3 ? std::max(1, std::atoi(argv[3])) : 24;
+
+    std::error_code ec;
+    if (std::filesystem::exists(root, ec) && !std::filesystem::is_empty(root, ec)) {
+        std::printf("%s não está vazia.\n", root.string().c_str());
+        return 1;
+    }
+
+    // Arquivos de sub-moveset como os de um mod, ainda sem o bloco gerenciado
+    std::vector<std::filesystem::path> files;
+    files.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const auto folder = root / std::format("BenchMod{:03}", i / 8) / std::format("{:02} Stance", i % 8);
+        std::filesystem::create_directories(folder);
+        files.push_back(folder / "config.json");
+        std::ofstream(files.back(), std::ios::binary)
+            << std::format(R"({{"name":"{:02} Stance","priority":{},"conditions":[]}})", i % 8, 2000000000 + i);
+    }
+
+    WorkStealingPool pool;
+    SKSE::log::info("{} config.json, {} regras cada, {} workers + thread principal", files.size(), rules,
+                    pool.GetThreadCount());
+    // A primeira gravação acrescenta o bloco; as duas seguintes reescrevem arquivos do mesmo tamanho
+    RunPass("Primeira gravação", files, rules, 1, &pool);
+    RunPass("Sequencial", files, rules, 2, nullptr);
+    RunPass("Paralelo", files, rules, 3, &pool);
+    RunPass("Sequencial, sem mudanças", files, rules, 3, nullptr);
+    RunPass("Paralelo, sem mudanças", files, rules, 3, &pool);
+    return 0;
+}